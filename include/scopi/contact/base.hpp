@@ -5,10 +5,27 @@
 #include "../objects/methods/closest_points.hpp"
 #include "../objects/methods/select.hpp"
 #include "../objects/methods/write_objects.hpp"
+#include "../objects/types/plane.hpp"
 #include "../objects/neighbor.hpp"
 #include "../params.hpp"
+#include "../quaternion.hpp"
+#include "../sphere_container.hpp"
+#include "../utils.hpp"
+#include "closest_points_cache.hpp"
+#include "sphere_batch.hpp"
 #include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef SCOPI_USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace scopi
 {
@@ -41,45 +58,74 @@ namespace scopi
          * @brief Compute contacts between particles.
          *
          * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [in] Array of particles.
          * @param active_ptr [in] Index of the first active particle.
          *
          * @return Array of neighbors.
          */
-        template <std::size_t dim>
-        auto run(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr);
+        template <std::size_t dim, class particles_t>
+        auto run(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
 
         /**
          * @brief Compute contacts between particles.
          *
-         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [in] Array of particles.
          * @param active_ptr [in] Index of the first active particle.
          *
          * @return Array of neighbors.
          */
-        template <std::size_t dim>
-        auto run(scopi_container<dim>& particles, std::size_t active_ptr);
+        template <class particles_t>
+        auto run(particles_t& particles, std::size_t active_ptr);
 
         params_t& get_params();
 
+        /**
+         * @brief Parameters of the closest points of the contacts found by the last call to run.
+         */
+        const closest_points_cache& get_closest_points_cache() const;
+
+        /**
+         * @brief Apply a permutation of the particles to the data kept from one call to run to the next (see scopi_container::reorder).
+         *
+         * @param perm [in] Permutation of the particles: the particle \c i is now the particle \c perm[i], <tt>std::size_t(-1)</tt> if
+         * it was removed (see scopi_container::erase).
+         */
+        void renumber(const std::vector<std::size_t>& perm);
+
+        /**
+         * @brief Apply a permutation of the particles to the data of the algorithm kept from one call to run to the next.
+         *
+         * Nothing to do by default, to be redefined by the algorithms that keep such data.
+         */
+        void renumber_impl(const std::vector<std::size_t>&)
+        {
+        }
+
       private:
 
         params_t m_params;
+        /**
+         * @brief Parameters of the closest points of the contacts found by the last call to run.
+         */
+        closest_points_cache m_closest_points_cache;
     };
 
     template <class D>
-    template <std::size_t dim>
-    auto contact_base<D>::run(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr)
+    template <std::size_t dim, class particles_t>
+    auto contact_base<D>::run(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
     {
-        return this->derived_cast().run_impl(box, particles, active_ptr);
+        auto contacts = this->derived_cast().run_impl(box, particles, active_ptr);
+        m_closest_points_cache.update(contacts);
+        return contacts;
     }
 
     template <class D>
-    template <std::size_t dim>
-    auto contact_base<D>::run(scopi_container<dim>& particles, std::size_t active_ptr)
+    template <class particles_t>
+    auto contact_base<D>::run(particles_t& particles, std::size_t active_ptr)
     {
-        return this->derived_cast().run_impl(BoxDomain<dim>(), particles, active_ptr);
+        return run(BoxDomain<particles_t::dim>(), particles, active_ptr);
     }
 
     template <class D>
@@ -88,16 +134,212 @@ namespace scopi
         return m_params;
     }
 
+    template <class D>
+    const closest_points_cache& contact_base<D>::get_closest_points_cache() const
+    {
+        return m_closest_points_cache;
+    }
+
+    template <class D>
+    void contact_base<D>::renumber(const std::vector<std::size_t>& perm)
+    {
+        m_closest_points_cache.renumber(perm);
+        this->derived_cast().renumber_impl(perm);
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Whether a pair with periodic images is the one kept for the contact.
+         *
+         * The images are created on both sides of the domain, so a contact through a periodic boundary can be found with an image of
+         * either particle, or with images of both particles in a corner. Let \c a < \c b be the two particles. The pair is kept if, in
+         * each direction, at most one of them is shifted and \c a is shifted only if \c b has no image with the opposite shift.
+         * Exactly one pair is kept for each contact between two active particles, and a particle is never in contact with its own image.
+         * The obstacles have no image, so a pair of an obstacle and an image is always kept here: the duplicates with the planes are
+         * removed by compute_obstacle_contacts.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param box [in] Simulation domain.
+         * @param particles [in] Array of particles.
+         * @param margin [in] Margin used to create the images (see periodic_margin).
+         * @param i [in] Index of the first particle or image.
+         * @param j [in] Index of the second particle or image.
+         */
+        template <std::size_t dim, class particles_t>
+        bool is_periodic_pair_kept(const BoxDomain<dim>& box,
+                                   const particles_t& particles,
+                                   double margin,
+                                   std::size_t i,
+                                   std::size_t j)
+        {
+            const std::size_t ptr = particles.periodic_ptr();
+            if (i < ptr && j < ptr)
+            {
+                return true;
+            }
+
+            std::size_t a = (i < ptr) ? i : particles.periodic_index(i - ptr);
+            std::size_t b = (j < ptr) ? j : particles.periodic_index(j - ptr);
+            if (a == b)
+            {
+                return false;
+            }
+            if (a > b)
+            {
+                std::swap(a, b);
+                std::swap(i, j);
+            }
+
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double shift_a = (i < ptr) ? 0. : particles.periodic_shift(i - ptr)(d);
+                const double shift_b = (j < ptr) ? 0. : particles.periodic_shift(j - ptr)(d);
+                if (shift_a != 0. && (shift_b != 0. || has_periodic_image(box, particles.pos()(b), d, -shift_a, margin)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Closed form of closest_points between two spheres.
+         *
+         * @tparam problem_t Problem to be solved.
+         * @tparam dim Dimension (2 or 3).
+         * @tparam position_t Type of the positions.
+         * @param x_i [in] Center of the first sphere.
+         * @param r_i [in] Radius of the first sphere.
+         * @param x_j [in] Center of the second sphere.
+         * @param r_j [in] Radius of the second sphere.
+         *
+         * @return Neighbor, without indices and property.
+         */
+        template <class problem_t, std::size_t dim, class position_t>
+        neighbor<dim, problem_t> sphere_sphere_neighbor(const position_t& x_i, double r_i, const position_t& x_j, double r_j)
+        {
+            double distance = 0.;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double dx = x_j(d) - x_i(d);
+                distance += dx * dx;
+            }
+            distance = std::sqrt(distance);
+
+            neighbor<dim, problem_t> neigh;
+            neigh.dij = distance - r_i - r_j;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double u = (x_j(d) - x_i(d)) / distance;
+                neigh.nij(d)   = -u;
+                neigh.pi(d)    = x_i(d) + r_i * u;
+                neigh.pj(d)    = x_j(d) - r_j * u;
+            }
+            return neigh;
+        }
+
+        /**
+         * @brief Closed form of closest_points between a plane and a sphere.
+         *
+         * @tparam problem_t Problem to be solved.
+         * @tparam dim Dimension (2 or 3).
+         * @tparam position_t Type of the positions.
+         * @param normal [in] Normal of the plane, array of size \c dim.
+         * @param x_i [in] Position of the plane.
+         * @param x_j [in] Center of the sphere.
+         * @param r_j [in] Radius of the sphere.
+         *
+         * @return Neighbor, without indices and property.
+         */
+        template <class problem_t, std::size_t dim, class position_t>
+        neighbor<dim, problem_t> plane_sphere_neighbor(const double* normal, const position_t& x_i, const position_t& x_j, double r_j)
+        {
+            double plane_to_particle = 0.;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                plane_to_particle += normal[d] * (x_j(d) - x_i(d));
+            }
+            const double sign = (plane_to_particle > 0.) ? 1. : ((plane_to_particle < 0.) ? -1. : 0.);
+
+            neighbor<dim, problem_t> neigh;
+            neigh.dij = std::abs(plane_to_particle) - r_j;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                neigh.nij(d) = -sign * normal[d];
+                neigh.pi(d)  = x_j(d) - plane_to_particle * normal[d];
+                neigh.pj(d)  = x_j(d) - sign * r_j * normal[d];
+            }
+            return neigh;
+        }
+
+        /**
+         * @brief Add a neighbor found between two particles or periodic images.
+         *
+         * The indices of the neighbor are the ones of the particles and the contact points of the images are shifted back.
+         *
+         * @tparam problem_t Problem to be solved.
+         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param contacts [inout] Array of neighbors.
+         * @param neigh [in] Neighbor computed with the positions of the images.
+         * @param i [in] Index of the first particle or image.
+         * @param j [in] Index of the second particle or image.
+         * @param default_contact_property [in] Default contact property.
+         */
+        template <class problem_t, std::size_t dim, class particles_t>
+        void add_neighbor(const particles_t& particles,
+                          std::vector<neighbor<dim, problem_t>>& contacts,
+                          neighbor<dim, problem_t>&& neigh,
+                          std::size_t i,
+                          std::size_t j,
+                          const contact_property<problem_t>& default_contact_property)
+        {
+            const std::size_t ptr = particles.periodic_ptr();
+
+            neigh.i        = (i < ptr) ? i : particles.periodic_index(i - ptr);
+            neigh.j        = (j < ptr) ? j : particles.periodic_index(j - ptr);
+            neigh.property = default_contact_property;
+
+            if (i >= ptr)
+            {
+                neigh.pi -= particles.periodic_shift(i - ptr);
+            }
+            if (j >= ptr)
+            {
+                neigh.pj -= particles.periodic_shift(j - ptr);
+            }
+            contacts.emplace_back(std::move(neigh));
+        }
+    }
+
     /**
      * @brief Compute the exact distance between two particles.
      *
+     * The particles can be periodic images: the shift of the image is applied to the position of its particle, the indices of the
+     * neighbor are the ones of the particles and the contact points are shifted back.
+     *
+     * The distance is not computed if the bounding balls of the particles (see scopi_container::bounding_radius) are farther than
+     * \c dmax: this test only reads the cached positions and radii, before any object is reconstructed.
+     *
+     * The particles are viewed on the stack and closest_points is found from their shape tags in a table built at compile time (see
+     * scopi_container::visit_particle and double_static_dispatcher::dispatch_tag). If the pair was a contact at the previous time step,
+     * the parameters of its closest points are the starting point of closest_points (see closest_points_cache).
+     *
+     * This function is not thread-safe with respect to \c contacts: in parallel loops, each thread must use its own array of neighbors.
+     * See compute_contacts_in_parallel.
+     *
      * @tparam dim Dimension (2 or 3).
+     * @param box [in] Simulation domain.
      * @param particles [in] Array of particles.
      * @param contacts [inout] Array of neighbors, if the distance between the two particles is small enough, add a neighbor in this array.
      * @param dmax [in] Maximum distance to consider two particles to be neighbors.
      * @param i [in] Index of the first particle.
      * @param j [in] Index of the second particle.
      * @param default_contact_property [in] Default contact property.
+     * @param cache [in] Parameters of the closest points at the previous time step.
      */
     template <class problem_t, std::size_t dim>
     void compute_exact_distance(const BoxDomain<dim>& box,
@@ -106,37 +348,478 @@ namespace scopi
                                 double dmax,
                                 std::size_t i,
                                 std::size_t j,
-                                contact_property<problem_t>& default_contact_property)
+                                contact_property<problem_t>& default_contact_property,
+                                const closest_points_cache& cache)
     {
-        std::size_t o1 = particles.object_index(i);
-        std::size_t o2 = particles.object_index(j);
-        auto neigh     = closest_points_dispatcher<problem_t, dim>::dispatch(
-            *select_object_dispatcher<dim>::dispatch(*particles[o1], index(i - particles.offset(o1))),
-            *select_object_dispatcher<dim>::dispatch(*particles[o2], index(j - particles.offset(o2))));
+        // the bounding balls are farther than dmax, the particles are not reconstructed
+        const auto x_i     = particles.position(i);
+        const auto x_j     = particles.position(j);
+        const double reach = particles.bounding_radius(i) + particles.bounding_radius(j) + dmax;
+        double dist2       = 0.;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            const double dx = x_i(d) - x_j(d);
+            dist2 += dx * dx;
+        }
+        if (dist2 >= reach * reach)
+        {
+            return;
+        }
 
-        if (neigh.dij < dmax && (i < particles.periodic_ptr() || j < particles.periodic_ptr()))
+        const std::size_t ptr = particles.periodic_ptr();
+        if (!detail::is_periodic_pair_kept(box, particles, periodic_margin(particles, dmax), i, j))
         {
-            neigh.i        = (i < particles.periodic_ptr()) ? i : particles.periodic_index(i - particles.periodic_ptr());
-            neigh.j        = (j < particles.periodic_ptr()) ? j : particles.periodic_index(j - particles.periodic_ptr());
-            neigh.property = default_contact_property;
+            return;
+        }
+
+        const std::size_t source_i      = (i < ptr) ? i : particles.periodic_index(i - ptr);
+        const std::size_t source_j      = (j < ptr) ? j : particles.periodic_index(j - ptr);
+        const surface_parameters* guess = cache.find(source_i, source_j);
 
+        auto neigh = particles.visit_particle(
+            i,
+            [&](const object<dim, false>& obj_i, shape_tag_t tag_i)
+            {
+                return particles.visit_particle(
+                    j,
+                    [&](const object<dim, false>& obj_j, shape_tag_t tag_j)
+                    {
+                        return closest_points_dispatcher<problem_t, dim>::template dispatch_tag<shape_types<dim>>(tag_i,
+                                                                                                                  obj_i,
+                                                                                                                  tag_j,
+                                                                                                                  obj_j,
+                                                                                                                  guess);
+                    });
+            });
+
+        if (neigh.dij < dmax)
+        {
+            detail::add_neighbor(particles, contacts, std::move(neigh), i, j, default_contact_property);
+        }
+    }
+
+    /**
+     * @brief Compute the exact distance between two particles of a sphere_container.
+     *
+     * Same as compute_exact_distance for a scopi_container, but the closest points between two spheres or between a plane and a
+     * sphere are computed from their closed forms: the particles are never viewed as objects and the closest points of the previous
+     * time step are not needed.
+     *
+     * The obstacles are before the active particles and only the particle \c i can be a plane.
+     *
+     * @tparam problem_t Problem to be solved.
+     * @tparam dim Dimension (2 or 3).
+     * @param box [in] Simulation domain.
+     * @param particles [in] Array of spheres and planes.
+     * @param contacts [inout] Array of neighbors, if the distance between the two particles is small enough, add a neighbor in this array.
+     * @param dmax [in] Maximum distance to consider two particles to be neighbors.
+     * @param i [in] Index of the first particle.
+     * @param j [in] Index of the second particle.
+     * @param default_contact_property [in] Default contact property.
+     */
+    template <class problem_t, std::size_t dim>
+    void compute_exact_distance(const BoxDomain<dim>& box,
+                                sphere_container<dim>& particles,
+                                std::vector<neighbor<dim, problem_t>>& contacts,
+                                double dmax,
+                                std::size_t i,
+                                std::size_t j,
+                                contact_property<problem_t>& default_contact_property,
+                                const closest_points_cache&)
+    {
+        if (!detail::is_periodic_pair_kept(box, particles, periodic_margin(particles, dmax), i, j))
+        {
+            return;
+        }
+
+        const auto x_i = particles.position(i);
+        const auto x_j = particles.position(j);
+
+        neighbor<dim, problem_t> neigh;
+        if (particles.is_plane(i))
+        {
+            const auto rotation = rotation_matrix<dim>(particles.q()(i));
+            std::array<double, dim> normal;
             for (std::size_t d = 0; d < dim; ++d)
             {
-                if (box.is_periodic(d))
+                normal[d] = rotation(d, 0);
+            }
+            neigh = detail::plane_sphere_neighbor<problem_t, dim>(normal.data(), x_i, x_j, particles.radius(j));
+        }
+        else
+        {
+            neigh = detail::sphere_sphere_neighbor<problem_t, dim>(x_i, particles.radius(i), x_j, particles.radius(j));
+        }
+
+        if (neigh.dij < dmax)
+        {
+            detail::add_neighbor(particles, contacts, std::move(neigh), i, j, default_contact_property);
+        }
+    }
+
+    /**
+     * @brief Compute the contacts between a particle and its candidates.
+     *
+     * When the particle \c i and the candidate \c j are spheres, the pair goes through the batched kernel of sphere_batch. The other
+     * pairs, and the pairs with periodic images, go through compute_exact_distance. The contacts are added in the order of the candidates.
+     * With a sphere_container, the shape of the particles is known without looking up their tags and compute_exact_distance also uses
+     * the closed form of closest_points.
+     *
+     * @tparam problem_t Problem to be solved.
+     * @tparam dim Dimension (2 or 3).
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+     * @tparam Iterator Type of the iterator on the candidates.
+     * @tparam Filter Type of the filter.
+     * @param box [in] Simulation domain.
+     * @param particles [in] Array of particles.
+     * @param contacts [inout] Array of neighbors, the contacts found are added at the end.
+     * @param dmax [in] Maximum distance to consider two particles to be neighbors.
+     * @param i [in] Index of the particle.
+     * @param first [in] First candidate.
+     * @param last [in] End of the candidates.
+     * @param default_contact_property [in] Default contact property.
+     * @param cache [in] Parameters of the closest points at the previous time step.
+     * @param accept [in] Function with signature \c bool(std::size_t j), the candidates \c j for which it returns false are skipped.
+     *
+     * @return Number of exact distances computed.
+     */
+    template <class problem_t, std::size_t dim, class particles_t, class Iterator, class Filter>
+    std::size_t compute_contacts_with_candidates(const BoxDomain<dim>& box,
+                                                 particles_t& particles,
+                                                 std::vector<neighbor<dim, problem_t>>& contacts,
+                                                 double dmax,
+                                                 std::size_t i,
+                                                 Iterator first,
+                                                 Iterator last,
+                                                 contact_property<problem_t>& default_contact_property,
+                                                 const closest_points_cache& cache,
+                                                 Filter&& accept)
+    {
+        thread_local sphere_batch<dim> batch;
+
+        const std::size_t ptr = particles.periodic_ptr();
+        const bool sphere_i   = i < ptr && particles.is_sphere(i);
+        const auto x_i        = particles.position(i);
+        const double r_i      = particles.bounding_radius(i);
+
+        std::size_t nMatches = 0;
+        for (; first != last; ++first)
+        {
+            const std::size_t j = *first;
+            if (!accept(j))
+            {
+                continue;
+            }
+            if (sphere_i && j < ptr && particles.is_sphere(j))
+            {
+                batch.push_back(j, particles.pos()(j), particles.bounding_radius(j));
+            }
+            else
+            {
+                // the contacts of the batch come before the contact with j
+                batch.compute(i, x_i, r_i, dmax, default_contact_property, contacts);
+                compute_exact_distance<problem_t>(box, particles, contacts, dmax, i, j, default_contact_property, cache);
+            }
+            nMatches++;
+        }
+        batch.compute(i, x_i, r_i, dmax, default_contact_property, contacts);
+        return nMatches;
+    }
+
+    /**
+     * @brief Compute the contacts between a particle and all its candidates.
+     *
+     * See compute_contacts_with_candidates.
+     */
+    template <class problem_t, std::size_t dim, class particles_t, class Iterator>
+    std::size_t compute_contacts_with_candidates(const BoxDomain<dim>& box,
+                                                 particles_t& particles,
+                                                 std::vector<neighbor<dim, problem_t>>& contacts,
+                                                 double dmax,
+                                                 std::size_t i,
+                                                 Iterator first,
+                                                 Iterator last,
+                                                 contact_property<problem_t>& default_contact_property,
+                                                 const closest_points_cache& cache)
+    {
+        return compute_contacts_with_candidates(box,
+                                                particles,
+                                                contacts,
+                                                dmax,
+                                                i,
+                                                first,
+                                                last,
+                                                default_contact_property,
+                                                cache,
+                                                [](std::size_t)
+                                                {
+                                                    return true;
+                                                });
+    }
+
+    /**
+     * @brief Compute in parallel the contacts of a range of particles.
+     *
+     * The range [\c begin, \c end) is split into contiguous chunks, several chunks per thread to balance the load.
+     * Each chunk fills its own array of neighbors, and the arrays are concatenated in the order of the chunks.
+     * Therefore, the result does not depend on the number of threads and is the same as with a sequential loop:
+     * if \c compute_contacts_of adds the contacts of a particle sorted by increasing \c j, the result is sorted.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam problem_t Problem to be solved.
+     * @tparam Func Type of the function that computes the contacts of one particle.
+     * @param begin [in] Index of the first particle.
+     * @param end [in] Index after the last particle.
+     * @param contacts [inout] Array of neighbors, the contacts found are added at the end.
+     * @param compute_contacts_of [in] Function with signature \c std::size_t(std::size_t i, std::vector<neighbor<dim, problem_t>>&)
+     * that adds the contacts of particle \c i in the array and returns the number of exact distances computed.
+     *
+     * @return Number of exact distances computed.
+     */
+    template <std::size_t dim, class problem_t, class Func>
+    std::size_t compute_contacts_in_parallel(std::size_t begin,
+                                             std::size_t end,
+                                             std::vector<neighbor<dim, problem_t>>& contacts,
+                                             Func&& compute_contacts_of)
+    {
+        if (end <= begin)
+        {
+            return 0;
+        }
+
+        const std::size_t size = end - begin;
+        std::size_t nchunks    = 1;
+#ifdef SCOPI_USE_OPENMP
+        nchunks = std::min(size, 8 * static_cast<std::size_t>(omp_get_max_threads()));
+#endif
+        std::vector<std::vector<neighbor<dim, problem_t>>> buffers(nchunks);
+
+        std::size_t nMatches = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : nMatches)
+        for (std::size_t c = 0; c < nchunks; ++c)
+        {
+            for (std::size_t i = begin + c * size / nchunks; i < begin + (c + 1) * size / nchunks; ++i)
+            {
+                nMatches += compute_contacts_of(i, buffers[c]);
+            }
+        }
+
+        std::size_t ncontacts = contacts.size();
+        for (const auto& buffer : buffers)
+        {
+            ncontacts += buffer.size();
+        }
+        contacts.reserve(ncontacts);
+        for (auto& buffer : buffers)
+        {
+            std::move(buffer.begin(), buffer.end(), std::back_inserter(contacts));
+        }
+        return nMatches;
+    }
+
+    /**
+     * @brief Kind of each obstacle for the obstacle broadphase.
+     *
+     * The obstacles only move through their velocity, so their shape is checked once and only their position and rotation are read at
+     * each time step.
+     */
+    class obstacle_index
+    {
+      public:
+
+        /**
+         * @brief Check the kind of the obstacles if they have changed.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle, which is the number of obstacles.
+         */
+        template <class particles_t>
+        void update(const particles_t& particles, std::size_t active_ptr);
+
+        /**
+         * @brief Whether the obstacle \c i is a plane.
+         *
+         * @param i [in] Index of the obstacle.
+         */
+        bool is_plane(std::size_t i) const;
+
+      private:
+
+        /**
+         * @brief Whether each obstacle is a plane.
+         */
+        std::vector<bool> m_is_plane;
+    };
+
+    template <class particles_t>
+    void obstacle_index::update(const particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        if (m_is_plane.size() == active_ptr)
+        {
+            return;
+        }
+
+        m_is_plane.resize(active_ptr);
+        for (std::size_t i = 0; i < active_ptr; ++i)
+        {
+            m_is_plane[i] = particles.particle_tag(i) == shape_tag_v<plane<dim, false>>;
+        }
+    }
+
+    inline bool obstacle_index::is_plane(std::size_t i) const
+    {
+        return m_is_plane[i];
+    }
+
+    /**
+     * @brief Compute the contacts between the obstacles and the active particles.
+     *
+     * The exact distance between the obstacle \c i and the active particle \c j is computed only if
+     *  - for a plane of normal \f$ n_i \f$, \f$ |n_i \cdot (x_j - x_i)| - r_j < dmax \f$,
+     *  - for the other obstacles, \f$ \| x_j - x_i \| - r_i - r_j < dmax \f$,
+     *
+     * where \f$ r \f$ is the bounding radius (see scopi_container::bounding_radius).
+     * The contacts between a plane and a sphere are computed directly from the closed form of closest_points.
+     * The obstacles have no periodic image. The pair of a plane and a periodic image is skipped when the plane is invariant by the shift
+     * of the image, since it is the same contact as the one with the particle of the image. The other pairs with an image are distinct
+     * contacts through the periodic boundary.
+     * The pairs (obstacle, particle) are distributed between the threads and the contacts are sorted.
+     *
+     * @tparam problem_t Problem to be solved.
+     * @tparam dim Dimension (2 or 3).
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+     * @param box [in] Simulation domain.
+     * @param particles [in] Array of particles.
+     * @param active_ptr [in] Index of the first active particle.
+     * @param dmax [in] Maximum distance to consider two particles to be neighbors.
+     * @param obstacles [inout] Kind of the obstacles.
+     * @param default_contact_property [in] Default contact property.
+     * @param cache [in] Parameters of the closest points at the previous time step.
+     * @param contacts [inout] Array of neighbors, the contacts found are added at the end.
+     *
+     * @return Number of exact distances computed.
+     */
+    template <class problem_t, std::size_t dim, class particles_t>
+    std::size_t compute_obstacle_contacts(const BoxDomain<dim>& box,
+                                          particles_t& particles,
+                                          std::size_t active_ptr,
+                                          double dmax,
+                                          obstacle_index& obstacles,
+                                          contact_property<problem_t>& default_contact_property,
+                                          const closest_points_cache& cache,
+                                          std::vector<neighbor<dim, problem_t>>& contacts)
+    {
+        const std::size_t nactive = particles.nb_particles() - active_ptr;
+        if (active_ptr == 0 || nactive == 0)
+        {
+            return 0;
+        }
+
+        obstacles.update(particles, active_ptr);
+
+        // the obstacles may have moved since the last time step
+        std::vector<double> normals(dim * active_ptr, 0.);
+        for (std::size_t i = 0; i < active_ptr; ++i)
+        {
+            if (obstacles.is_plane(i))
+            {
+                auto rotation = rotation_matrix<dim>(particles.q()(i));
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    normals[dim * i + d] = rotation(d, 0);
+                }
+            }
+        }
+
+        return compute_contacts_in_parallel(
+            0,
+            active_ptr * nactive,
+            contacts,
+            [&](std::size_t k, std::vector<neighbor<dim, problem_t>>& buffer)
+            {
+                const std::size_t i = k / nactive;
+                const std::size_t j = active_ptr + k % nactive;
+                const auto x_i      = particles.position(i);
+                const auto x_j      = particles.position(j);
+
+                double distance = 0.;
+                if (obstacles.is_plane(i))
                 {
-                    if (neigh.pi(d) > box.upper_bound(d) && i >= particles.periodic_ptr())
+                    // the contact with a plane invariant by the shift of an image is found with the particle of the image
+                    const std::size_t ptr = particles.periodic_ptr();
+                    if (j >= ptr)
                     {
-                        neigh.pi(d) -= box.upper_bound(d) - box.lower_bound(d);
+                        const auto& shift   = particles.periodic_shift(j - ptr);
+                        double normal_shift = 0.;
+                        double shift_norm   = 0.;
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            normal_shift += normals[dim * i + d] * shift(d);
+                            shift_norm += shift(d) * shift(d);
+                        }
+                        if (std::abs(normal_shift) <= 1e-12 * std::sqrt(shift_norm))
+                        {
+                            return std::size_t(0);
+                        }
                     }
-                    if (neigh.pj(d) > box.upper_bound(d) && j >= particles.periodic_ptr())
+
+                    double plane_to_particle = 0.;
+                    for (std::size_t d = 0; d < dim; ++d)
                     {
-                        neigh.pj(d) -= box.upper_bound(d) - box.lower_bound(d);
+                        plane_to_particle += normals[dim * i + d] * (x_j(d) - x_i(d));
+                    }
+                    const double r_j = particles.bounding_radius(j);
+                    distance         = std::abs(plane_to_particle) - r_j;
+
+                    if (distance < dmax && j < particles.periodic_ptr() && particles.is_sphere(j))
+                    {
+                        auto neigh = detail::plane_sphere_neighbor<problem_t, dim>(&normals[dim * i], x_i, x_j, r_j);
+                        detail::add_neighbor(particles, buffer, std::move(neigh), i, j, default_contact_property);
+                        return std::size_t(1);
                     }
                 }
-            }
-#pragma omp critical
-            contacts.emplace_back(std::move(neigh));
-        }
+                else
+                {
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        double dx = x_j(d) - x_i(d);
+                        distance += dx * dx;
+                    }
+                    distance = std::sqrt(distance) - particles.bounding_radius(i) - particles.bounding_radius(j);
+                }
+
+                if (distance < dmax)
+                {
+                    compute_exact_distance<problem_t>(box, particles, buffer, dmax, i, j, default_contact_property, cache);
+                    return std::size_t(1);
+                }
+                return std::size_t(0);
+            });
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Compact key used to sort the contacts.
+         */
+        struct contact_key
+        {
+            /**
+             * @brief Index of the particle \c i.
+             */
+            std::size_t i;
+            /**
+             * @brief Index of the particle \c j.
+             */
+            std::size_t j;
+            /**
+             * @brief Index of the contact in the array to sort.
+             */
+            std::size_t index;
+        };
     }
 
     /**
@@ -149,28 +832,84 @@ namespace scopi
      * For example, consider particles (0, 1, 2, 3) and assume all these particles are in contact two by two.
      * Then, the sorted array of neighbors is (0, 1) (0, 2) (0, 3) (1, 2) (1, 3) (2, 3).
      *
+     * The contact methods compute the contacts in this order, so the array is usually already sorted and only checked.
+     * It is not the case when there are periodic particles: then, compact keys (i, j, index) are sorted in parallel and the neighbors are
+     * moved once to their final position.
+     *
      * @tparam dim Dimension (2 or 3).
      * @param contacts [out] Array of contacts.
      */
     template <std::size_t dim, class problem_t>
     void sort_contacts(std::vector<neighbor<dim, problem_t>>& contacts)
     {
-        std::sort(contacts.begin(),
-                  contacts.end(),
-                  [](const auto& a, const auto& b)
-                  {
-                      if (a.i < b.i)
-                      {
-                          return true;
-                      }
-
-                      if (a.i == b.i)
-                      {
-                          return a.j < b.j;
-                      }
-
-                      return false;
-                  });
+        auto compare = [](const auto& a, const auto& b)
+        {
+            if (a.i < b.i)
+            {
+                return true;
+            }
+
+            if (a.i == b.i)
+            {
+                return a.j < b.j;
+            }
+
+            return false;
+        };
+
+        if (std::is_sorted(contacts.begin(), contacts.end(), compare))
+        {
+            return;
+        }
+
+        // sort compact keys instead of the neighbors
+        const std::size_t size = contacts.size();
+        std::vector<detail::contact_key> keys(size);
+        std::vector<detail::contact_key> buffer(size);
+#pragma omp parallel for
+        for (std::size_t k = 0; k < size; ++k)
+        {
+            keys[k] = {contacts[k].i, contacts[k].j, k};
+        }
+
+        // each thread sorts a chunk, then the chunks are merged two by two
+        std::size_t nchunks = 1;
+#ifdef SCOPI_USE_OPENMP
+        nchunks = std::min(size, static_cast<std::size_t>(omp_get_max_threads()));
+#endif
+        auto bound = [&](std::size_t c)
+        {
+            return keys.begin() + static_cast<std::ptrdiff_t>(std::min(c, nchunks) * size / nchunks);
+        };
+
+#pragma omp parallel for
+        for (std::size_t c = 0; c < nchunks; ++c)
+        {
+            std::sort(bound(c), bound(c + 1), compare);
+        }
+
+        for (std::size_t width = 1; width < nchunks; width *= 2)
+        {
+#pragma omp parallel for
+            for (std::size_t c = 0; c < nchunks; c += 2 * width)
+            {
+                std::merge(bound(c),
+                           bound(c + width),
+                           bound(c + width),
+                           bound(c + 2 * width),
+                           buffer.begin() + (bound(c) - keys.begin()),
+                           compare);
+            }
+            keys.swap(buffer);
+        }
+
+        std::vector<neighbor<dim, problem_t>> sorted(size);
+#pragma omp parallel for
+        for (std::size_t k = 0; k < size; ++k)
+        {
+            sorted[k] = std::move(contacts[keys[k].index]);
+        }
+        contacts.swap(sorted);
     }
 
 }
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "../objects/neighbor.hpp"
+
+namespace scopi
+{
+    /**
+     * @brief Parameters of the closest points of the contacts found at the previous time step.
+     *
+     * closest_points between two superellipsoids solves a nonlinear system with a Newton method whose starting point is found by
+     * sampling both surfaces. The contacts persist from one time step to the next, so the converged parameters of a pair are kept here
+     * and used as starting point when the pair is computed again (see surface_parameters).
+     *
+     * The cache is read concurrently while the contacts are computed and updated once they are sorted.
+     */
+    class closest_points_cache
+    {
+      public:
+
+        /**
+         * @brief Keep the parameters of the contacts that have some.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam problem_t Problem to be solved.
+         * @param contacts [in] Array of neighbors of the time step.
+         */
+        template <std::size_t dim, class problem_t>
+        void update(const std::vector<neighbor<dim, problem_t>>& contacts);
+
+        /**
+         * @brief Parameters of the pair (\c i, \c j) at the previous time step.
+         *
+         * @param i [in] Index of the particle \c i.
+         * @param j [in] Index of the particle \c j.
+         *
+         * @return Parameters, null if the pair was not a contact with parameters.
+         */
+        const surface_parameters* find(std::size_t i, std::size_t j) const;
+
+        /**
+         * @brief Apply a permutation of the particles to the pairs (see scopi_container::reorder).
+         *
+         * The parameters are ordered as the particles of the pair, so a pair whose particles are swapped by the permutation is
+         * removed, as well as a pair with a removed particle.
+         *
+         * @param perm [in] Permutation of the particles: the particle \c i is now the particle \c perm[i], <tt>std::size_t(-1)</tt> if
+         * it was removed (see scopi_container::erase).
+         */
+        void renumber(const std::vector<std::size_t>& perm);
+
+        /**
+         * @brief Number of pairs in the cache.
+         */
+        std::size_t size() const;
+
+      private:
+
+        /**
+         * @brief Sort the pairs and their parameters.
+         */
+        void sort();
+
+        /**
+         * @brief Pairs (\c i, \c j), sorted.
+         */
+        std::vector<std::pair<std::size_t, std::size_t>> m_pairs;
+        /**
+         * @brief Parameters of each pair.
+         */
+        std::vector<surface_parameters> m_parameters;
+    };
+
+    template <std::size_t dim, class problem_t>
+    void closest_points_cache::update(const std::vector<neighbor<dim, problem_t>>& contacts)
+    {
+        m_pairs.clear();
+        m_parameters.clear();
+        for (const auto& c : contacts)
+        {
+            if (c.u.valid)
+            {
+                m_pairs.emplace_back(c.i, c.j);
+                m_parameters.push_back(c.u);
+            }
+        }
+        sort();
+    }
+
+    inline void closest_points_cache::sort()
+    {
+        // the contacts are usually sorted (see sort_contacts)
+        if (!std::is_sorted(m_pairs.begin(), m_pairs.end()))
+        {
+            std::vector<std::size_t> order(m_pairs.size());
+            for (std::size_t k = 0; k < order.size(); ++k)
+            {
+                order[k] = k;
+            }
+            std::sort(order.begin(),
+                      order.end(),
+                      [&](std::size_t a, std::size_t b)
+                      {
+                          return m_pairs[a] < m_pairs[b];
+                      });
+
+            std::vector<std::pair<std::size_t, std::size_t>> pairs(order.size());
+            std::vector<surface_parameters> parameters(order.size());
+            for (std::size_t k = 0; k < order.size(); ++k)
+            {
+                pairs[k]      = m_pairs[order[k]];
+                parameters[k] = m_parameters[order[k]];
+            }
+            m_pairs.swap(pairs);
+            m_parameters.swap(parameters);
+        }
+    }
+
+    inline const surface_parameters* closest_points_cache::find(std::size_t i, std::size_t j) const
+    {
+        auto it = std::lower_bound(m_pairs.begin(), m_pairs.end(), std::make_pair(i, j));
+        if (it == m_pairs.end() || *it != std::make_pair(i, j))
+        {
+            return nullptr;
+        }
+        return &m_parameters[static_cast<std::size_t>(it - m_pairs.begin())];
+    }
+
+    inline void closest_points_cache::renumber(const std::vector<std::size_t>& perm)
+    {
+        std::size_t n = 0;
+        for (std::size_t k = 0; k < m_pairs.size(); ++k)
+        {
+            const std::size_t i = m_pairs[k].first < perm.size() ? perm[m_pairs[k].first] : m_pairs[k].first;
+            const std::size_t j = m_pairs[k].second < perm.size() ? perm[m_pairs[k].second] : m_pairs[k].second;
+            if (i < j && j != std::size_t(-1))
+            {
+                m_pairs[n]      = {i, j};
+                m_parameters[n] = m_parameters[k];
+                ++n;
+            }
+        }
+        m_pairs.resize(n);
+        m_parameters.resize(n);
+        sort();
+    }
+
+    inline std::size_t closest_points_cache::size() const
+    {
+        return m_pairs.size();
+    }
+}
@@ -83,13 +83,14 @@ namespace scopi
          * See sort_contacts.
          *
          * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [in] Array of particles.
          * @param active_ptr [in] Index of the first active particle.
          *
          * @return Array of neighbors.
          */
-        template <std::size_t dim>
-        auto run_impl(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr);
+        template <std::size_t dim, class particles_t>
+        auto run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
 
         contact_property<problem_t> m_default_contact_property;
 
@@ -97,34 +98,49 @@ namespace scopi
         {
             return m_default_contact_property;
         }
+
+      private:
+
+        /**
+         * @brief Kind of the obstacles.
+         */
+        obstacle_index m_obstacles;
     };
 
     template <class problem_t>
-    template <std::size_t dim>
-    auto contact_brute_force<problem_t>::run_impl(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr)
+    template <std::size_t dim, class particles_t>
+    auto contact_brute_force<problem_t>::run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
     {
         std::vector<neighbor<dim, problem_t>> contacts;
 
         add_objects_from_periodicity(box, particles, this->get_params().dmax);
 
         tic();
-#pragma omp parallel for
-        for (std::size_t i = active_ptr; i < particles.pos().size() - 1; ++i)
-        {
-            for (std::size_t j = i + 1; j < particles.pos().size(); ++j)
+        const double dmax       = this->get_params().dmax;
+        const std::size_t npart = particles.nb_particles();
+
+        const auto& cache = this->get_closest_points_cache();
+        compute_obstacle_contacts(box,
+                                  particles,
+                                  active_ptr,
+                                  dmax,
+                                  m_obstacles,
+                                  m_default_contact_property,
+                                  cache,
+                                  contacts);
+
+        compute_contacts_in_parallel(
+            active_ptr,
+            npart,
+            contacts,
+            [&](std::size_t i, std::vector<neighbor<dim, problem_t>>& buffer)
             {
-                compute_exact_distance<problem_t>(box, particles, contacts, this->get_params().dmax, i, j, m_default_contact_property);
-            }
-        }
-
-        // obstacles
-        for (std::size_t i = 0; i < active_ptr; ++i)
-        {
-            for (std::size_t j = active_ptr; j < particles.pos().size(); ++j)
-            {
-                compute_exact_distance<problem_t>(box, particles, contacts, this->get_params().dmax, i, j, m_default_contact_property);
-            }
-        }
+                for (std::size_t j = i + 1; j < npart; ++j)
+                {
+                    compute_exact_distance<problem_t>(box, particles, buffer, dmax, i, j, m_default_contact_property, cache);
+                }
+                return npart - i - 1;
+            });
 
         auto duration = toc();
         PLOG_INFO << "----> CPUTIME : compute " << contacts.size() << " contacts = " << duration;
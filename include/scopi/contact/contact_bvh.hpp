@@ -0,0 +1,574 @@
+#pragma once
+
+#include "../box.hpp"
+#include "../objects/methods/bounding_box.hpp"
+#include "../objects/methods/select.hpp"
+#include "../scopi.hpp"
+#include "../utils.hpp"
+#include "base.hpp"
+#include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <plog/Initializers/RollingFileInitializer.h>
+#include <plog/Log.h>
+
+namespace scopi
+{
+
+    template <class problem_t>
+    class contact_bvh;
+
+    /**
+     * @brief Parameters for contact_bvh.
+     *
+     * Specialization of ContactsParams.
+     */
+    template <class problem_t>
+    struct ContactsParams<contact_bvh<problem_t>>
+    {
+        void init_options()
+        {
+            auto& app = get_app();
+            auto* opt = app.add_option_group("BVH options");
+            opt->add_option("--dmax", dmax, "Maximum distance between two neighboring particles")->capture_default_str();
+            opt->add_option("--bvh-rebuild-ratio", rebuild_ratio, "Rebuild the tree when its volume has grown by this ratio")
+                ->capture_default_str();
+        }
+
+        /**
+         * @brief Maximum distance between two neighboring particles.
+         *
+         * Default value: 2.
+         * \note \c dmax > 0
+         */
+        double dmax{2.};
+        /**
+         * @brief Ratio to rebuild the tree.
+         *
+         * At each time step, the boxes of the tree are refitted to the new positions of the particles. The tree is rebuilt when the sum
+         * of the volumes of the internal nodes is larger than \c rebuild_ratio times this sum just after the last build.
+         *
+         * Default value: 2.
+         * \note \c rebuild_ratio >= 1
+         */
+        double rebuild_ratio{2.};
+    };
+
+    /**
+     * @brief Contacts with a bounding volume hierarchy.
+     *
+     * Each active particle is bounded by an axis-aligned box computed from its position, its rotation and its shape (see
+     * bounding_box.hpp), enlarged by \c dmax / 2 in each direction. The boxes are stored in a binary tree built by splitting the
+     * particles at the median along the direction where their centers are the most spread. The exact distance is only computed for
+     * particles whose boxes overlap.
+     *
+     * At each time step, the boxes of the tree are refitted from the leaves to the root. The tree is rebuilt only when it is too
+     * degraded (see ContactsParams<contact_bvh>::rebuild_ratio) or when the number of particles has changed.
+     * The periodic images are in the tree, their boxes are the boxes of their particles shifted.
+     */
+    template <class problem_t>
+    class contact_bvh : public contact_base<contact_bvh<problem_t>>
+    {
+      public:
+
+        /**
+         * @brief Alias for the base class contact_base.
+         */
+        using base_type = contact_base<contact_bvh<problem_t>>;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param params [in] Parameters.
+         */
+        explicit contact_bvh(const ContactsParams<contact_bvh<problem_t>>& params = ContactsParams<contact_bvh<problem_t>>())
+            : base_type(params)
+        {
+        }
+
+        /**
+         * @brief Compute neighboring particles.
+         *
+         * Compute contacts between particles using a bounding volume hierarchy to select particles close enough.
+         * Then, compute the exact distance.
+         *
+         * Only the contact between particles \c i and \c j is computed, not the contact between \c j and \c i, with \c i < \c j.
+         *
+         * The returned array of neighbors is sorted.
+         * See sort_contacts.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param box [in] Simulation domain.
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         *
+         * @return Array of neighbors.
+         */
+        template <std::size_t dim, class particles_t>
+        auto run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
+
+        auto& default_contact_property()
+        {
+            return m_default_contact_property;
+        }
+
+        /**
+         * @brief The tree is built again after a permutation of the particles.
+         *
+         * @param perm [in] Permutation of the particles.
+         */
+        void renumber_impl(const std::vector<std::size_t>& perm);
+
+      private:
+
+        /**
+         * @brief Node of the tree.
+         *
+         * The left child of an internal node is the next node in the array, so that a node is always stored before its children.
+         */
+        struct bvh_node
+        {
+            /**
+             * @brief Lower corner of the box.
+             */
+            std::array<double, 3> lower;
+            /**
+             * @brief Upper corner of the box.
+             */
+            std::array<double, 3> upper;
+            /**
+             * @brief Index of the first particle of the node in m_leaf_particles.
+             */
+            std::size_t first;
+            /**
+             * @brief Number of particles in the node.
+             */
+            std::size_t count;
+            /**
+             * @brief Index of the right child, 0 for a leaf.
+             */
+            std::size_t right;
+        };
+
+        /**
+         * @brief Maximum number of particles in a leaf.
+         */
+        static constexpr std::size_t leaf_size = 4;
+
+        /**
+         * @brief Compute the box of each active particle.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         */
+        template <class particles_t>
+        void compute_boxes(particles_t& particles, std::size_t active_ptr);
+
+        /**
+         * @brief Build the subtree of the particles m_leaf_particles[first] to m_leaf_particles[first + count - 1].
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @param first [in] Index of the first particle in m_leaf_particles.
+         * @param count [in] Number of particles.
+         *
+         * @return Index of the root of the subtree.
+         */
+        template <std::size_t dim>
+        std::size_t build(std::size_t first, std::size_t count);
+
+        /**
+         * @brief Update the boxes of the nodes from the boxes of the particles.
+         *
+         * @tparam dim Dimension (2 or 3).
+         *
+         * @return Sum of the volumes of the internal nodes.
+         */
+        template <std::size_t dim>
+        double refit();
+
+        /**
+         * @brief Call a function for each particle in the tree whose box overlaps the box of particle \c k.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam Func Type of the function, with signature <tt>void(std::size_t)</tt>.
+         * @param k [in] Index of the particle relative to the first active particle.
+         * @param f [in] Function called with the index of the particle in the tree relative to the first active particle.
+         */
+        template <std::size_t dim, class Func>
+        void query(std::size_t k, Func&& f) const;
+
+        /**
+         * @brief Whether the boxes of the particles \c k and \c l overlap.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @param k [in] Index of the first particle relative to the first active particle.
+         * @param l [in] Index of the second particle relative to the first active particle.
+         */
+        template <std::size_t dim>
+        bool overlap(std::size_t k, std::size_t l) const;
+
+        /**
+         * @brief Number of exact distances computed.
+         */
+        std::size_t m_nMatches{0};
+        contact_property<problem_t> m_default_contact_property;
+        /**
+         * @brief Kind of the obstacles.
+         */
+        obstacle_index m_obstacles;
+
+        /**
+         * @brief Lower corner of the box of each active particle.
+         */
+        std::vector<double> m_lower;
+        /**
+         * @brief Upper corner of the box of each active particle.
+         */
+        std::vector<double> m_upper;
+        /**
+         * @brief Nodes of the tree.
+         */
+        std::vector<bvh_node> m_nodes;
+        /**
+         * @brief Particles of the tree (relative to the first active particle), sorted by leaf.
+         */
+        std::vector<std::size_t> m_leaf_particles;
+        /**
+         * @brief Sum of the volumes of the internal nodes after the last build.
+         */
+        double m_build_volume{0.};
+        /**
+         * @brief Index of the first active particle when the tree was built.
+         */
+        std::size_t m_active_ptr{0};
+        /**
+         * @brief Candidates \c j > \c i of each active particle \c i.
+         */
+        std::vector<std::vector<std::size_t>> m_candidates;
+    };
+
+    template <class problem_t>
+    void contact_bvh<problem_t>::renumber_impl(const std::vector<std::size_t>&)
+    {
+        m_leaf_particles.clear();
+    }
+
+    template <class problem_t>
+    template <class particles_t>
+    void contact_bvh<problem_t>::compute_boxes(particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        const std::size_t npart = particles.nb_particles() - active_ptr;
+        const double half_dmax  = 0.5 * this->get_params().dmax;
+        m_lower.resize(dim * npart);
+        m_upper.resize(dim * npart);
+
+        if (npart == 0)
+        {
+            return;
+        }
+
+#pragma omp parallel for
+        for (std::size_t i = active_ptr; i < particles.periodic_ptr(); ++i)
+        {
+            type::position_t<dim> half_size;
+            if constexpr (is_sphere_container<particles_t>::value)
+            {
+                // the active particles are spheres
+                half_size.fill(particles.radius(i));
+            }
+            else
+            {
+                half_size = particles.visit_particle(i,
+                                                     [](const object<dim, false>& obj, shape_tag_t tag)
+                                                     {
+                                                         return bounding_box_dispatcher<dim>::template dispatch_tag<shape_types<dim>>(tag,
+                                                                                                                                      obj);
+                                                     });
+            }
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                m_lower[dim * (i - active_ptr) + d] = particles.position(i)(d) - half_size(d) - half_dmax;
+                m_upper[dim * (i - active_ptr) + d] = particles.position(i)(d) + half_size(d) + half_dmax;
+            }
+        }
+
+        for (std::size_t i = particles.periodic_ptr(); i < particles.nb_particles(); ++i)
+        {
+            const std::size_t k = particles.periodic_index(i - particles.periodic_ptr());
+            const auto& shift   = particles.periodic_shift(i - particles.periodic_ptr());
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                m_lower[dim * (i - active_ptr) + d] = m_lower[dim * (k - active_ptr) + d] + shift(d);
+                m_upper[dim * (i - active_ptr) + d] = m_upper[dim * (k - active_ptr) + d] + shift(d);
+            }
+        }
+    }
+
+    template <class problem_t>
+    template <std::size_t dim>
+    std::size_t contact_bvh<problem_t>::build(std::size_t first, std::size_t count)
+    {
+        const std::size_t node = m_nodes.size();
+        m_nodes.push_back({{}, {}, first, count, 0});
+        if (count <= leaf_size)
+        {
+            return node;
+        }
+
+        // split at the median along the direction where the centers are the most spread
+        std::array<double, dim> cmin;
+        std::array<double, dim> cmax;
+        cmin.fill(std::numeric_limits<double>::max());
+        cmax.fill(std::numeric_limits<double>::lowest());
+        for (std::size_t p = first; p < first + count; ++p)
+        {
+            const std::size_t k = m_leaf_particles[p];
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double center = 0.5 * (m_lower[dim * k + d] + m_upper[dim * k + d]);
+                cmin[d]             = std::min(cmin[d], center);
+                cmax[d]             = std::max(cmax[d], center);
+            }
+        }
+        std::size_t axis = 0;
+        for (std::size_t d = 1; d < dim; ++d)
+        {
+            if (cmax[d] - cmin[d] > cmax[axis] - cmin[axis])
+            {
+                axis = d;
+            }
+        }
+
+        const std::size_t middle = first + count / 2;
+        std::nth_element(m_leaf_particles.begin() + static_cast<std::ptrdiff_t>(first),
+                         m_leaf_particles.begin() + static_cast<std::ptrdiff_t>(middle),
+                         m_leaf_particles.begin() + static_cast<std::ptrdiff_t>(first + count),
+                         [&](std::size_t a, std::size_t b)
+                         {
+                             return m_lower[dim * a + axis] + m_upper[dim * a + axis] < m_lower[dim * b + axis] + m_upper[dim * b + axis];
+                         });
+
+        build<dim>(first, middle - first);
+        const std::size_t right = build<dim>(middle, first + count - middle);
+        m_nodes[node].right     = right;
+        return node;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim>
+    double contact_bvh<problem_t>::refit()
+    {
+        double volume = 0.;
+        for (std::size_t n = m_nodes.size(); n-- > 0;)
+        {
+            auto& node = m_nodes[n];
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                node.lower[d] = std::numeric_limits<double>::max();
+                node.upper[d] = std::numeric_limits<double>::lowest();
+            }
+            if (node.right == 0)
+            {
+                for (std::size_t p = node.first; p < node.first + node.count; ++p)
+                {
+                    const std::size_t k = m_leaf_particles[p];
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        node.lower[d] = std::min(node.lower[d], m_lower[dim * k + d]);
+                        node.upper[d] = std::max(node.upper[d], m_upper[dim * k + d]);
+                    }
+                }
+            }
+            else
+            {
+                const auto& left   = m_nodes[n + 1];
+                const auto& right  = m_nodes[node.right];
+                double node_volume = 1.;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    node.lower[d] = std::min(left.lower[d], right.lower[d]);
+                    node.upper[d] = std::max(left.upper[d], right.upper[d]);
+                    node_volume *= node.upper[d] - node.lower[d];
+                }
+                volume += node_volume;
+            }
+        }
+        return volume;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim>
+    bool contact_bvh<problem_t>::overlap(std::size_t k, std::size_t l) const
+    {
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            if (m_lower[dim * k + d] > m_upper[dim * l + d] || m_lower[dim * l + d] > m_upper[dim * k + d])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim, class Func>
+    void contact_bvh<problem_t>::query(std::size_t k, Func&& f) const
+    {
+        if (m_nodes.empty())
+        {
+            return;
+        }
+
+        // the median split halves the particles at each level, so the tree has at most 64 levels and the stack, which holds the
+        // right children along the current path plus the next node, never overflows
+        std::array<std::size_t, 2 * std::numeric_limits<std::size_t>::digits> stack;
+        std::size_t top = 0;
+        stack[top++]    = 0;
+        while (top > 0)
+        {
+            const std::size_t n = stack[--top];
+            const auto& node    = m_nodes[n];
+
+            bool inside = true;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                if (m_lower[dim * k + d] > node.upper[d] || node.lower[d] > m_upper[dim * k + d])
+                {
+                    inside = false;
+                    break;
+                }
+            }
+            if (!inside)
+            {
+                continue;
+            }
+
+            if (node.right == 0)
+            {
+                for (std::size_t p = node.first; p < node.first + node.count; ++p)
+                {
+                    if (overlap<dim>(k, m_leaf_particles[p]))
+                    {
+                        f(m_leaf_particles[p]);
+                    }
+                }
+            }
+            else
+            {
+                stack[top++] = node.right;
+                stack[top++] = n + 1;
+            }
+        }
+    }
+
+    template <class problem_t>
+    template <std::size_t dim, class particles_t>
+    auto contact_bvh<problem_t>::run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
+    {
+        std::vector<neighbor<dim, problem_t>> contacts;
+
+        add_objects_from_periodicity(box, particles, this->get_params().dmax);
+
+        tic();
+        compute_boxes(particles, active_ptr);
+
+        const std::size_t ntree = particles.nb_particles() - active_ptr;
+        bool rebuild            = active_ptr != m_active_ptr || m_leaf_particles.size() != ntree;
+        if (!rebuild)
+        {
+            rebuild = refit<dim>() > this->get_params().rebuild_ratio * m_build_volume;
+        }
+        if (rebuild)
+        {
+            m_active_ptr = active_ptr;
+            m_leaf_particles.resize(ntree);
+            for (std::size_t k = 0; k < ntree; ++k)
+            {
+                m_leaf_particles[k] = k;
+            }
+            m_nodes.clear();
+            if (ntree > 0)
+            {
+                build<dim>(0, ntree);
+            }
+            m_build_volume = refit<dim>();
+            PLOG_INFO << "----> rebuild BVH with " << m_nodes.size() << " nodes" << std::endl;
+        }
+        auto duration = toc();
+        PLOG_INFO << "----> CPUTIME : update BVH = " << duration << std::endl;
+
+        tic();
+        m_candidates.resize(ntree);
+#pragma omp parallel for
+        for (std::size_t k = 0; k < ntree; ++k)
+        {
+            auto& candidates = m_candidates[k];
+            candidates.clear();
+            query<dim>(k,
+                       [&](std::size_t l)
+                       {
+                           if (k < l)
+                           {
+                               candidates.push_back(active_ptr + l);
+                           }
+                       });
+            std::sort(candidates.begin(), candidates.end());
+        }
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : traverse BVH = " << duration << std::endl;
+
+        tic();
+        const double dmax       = this->get_params().dmax;
+        const std::size_t npart = particles.nb_particles();
+
+        const auto& cache = this->get_closest_points_cache();
+        compute_obstacle_contacts(box,
+                                  particles,
+                                  active_ptr,
+                                  dmax,
+                                  m_obstacles,
+                                  m_default_contact_property,
+                                  cache,
+                                  contacts);
+
+        m_nMatches = compute_contacts_in_parallel(
+            active_ptr,
+            npart,
+            contacts,
+            [&](std::size_t i, std::vector<neighbor<dim, problem_t>>& buffer)
+            {
+                const auto& candidates = m_candidates[i - active_ptr];
+                return compute_contacts_with_candidates(box,
+                                                        particles,
+                                                        buffer,
+                                                        dmax,
+                                                        i,
+                                                        candidates.cbegin(),
+                                                        candidates.cend(),
+                                                        m_default_contact_property,
+                                                        cache);
+            });
+
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : compute " << contacts.size() << " contacts = " << duration << " compute " << m_nMatches
+                  << " distances" << std::endl;
+
+        tic();
+        sort_contacts(contacts);
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : sort " << contacts.size() << " contacts = " << duration << std::endl;
+
+        particles.reset_periodic();
+
+        return contacts;
+    }
+}
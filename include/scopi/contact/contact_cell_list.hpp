@@ -0,0 +1,379 @@
+#pragma once
+
+#include "../box.hpp"
+#include "../scopi.hpp"
+#include "../utils.hpp"
+#include "base.hpp"
+#include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <plog/Initializers/RollingFileInitializer.h>
+#include <plog/Log.h>
+
+namespace scopi
+{
+
+    template <class problem_t>
+    class contact_cell_list;
+
+    /**
+     * @brief Parameters for contact_cell_list.
+     *
+     * Specialization of ContactsParams.
+     */
+    template <class problem_t>
+    struct ContactsParams<contact_cell_list<problem_t>>
+    {
+        void init_options()
+        {
+            auto& app = get_app();
+            auto* opt = app.add_option_group("Cell list options");
+            opt->add_option("--dmax", dmax, "Maximum distance between two neighboring particles")->capture_default_str();
+        }
+
+        /**
+         * @brief Maximum distance between two neighboring particles.
+         *
+         * Default value: 2.
+         * \note \c dmax > 0
+         */
+        double dmax{2.};
+    };
+
+    /**
+     * @brief Contacts with a uniform cell list.
+     *
+     * The centers of the active particles are binned into a uniform grid whose cell size is \c dmax plus twice the largest bounding
+     * radius of the active particles. Two particles closer than \c dmax are then in the same cell or in neighboring cells, so the exact
+     * distance is only computed for particles in the \f$ 3^{dim} \f$ cells around each particle.
+     *
+     * The grid is built with a counting sort, in \f$ \mathcal{O}(N) \f$.
+     */
+    template <class problem_t>
+    class contact_cell_list : public contact_base<contact_cell_list<problem_t>>
+    {
+      public:
+
+        /**
+         * @brief Alias for the base class contact_base.
+         */
+        using base_type = contact_base<contact_cell_list<problem_t>>;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param params [in] Parameters.
+         */
+        explicit contact_cell_list(
+            const ContactsParams<contact_cell_list<problem_t>>& params = ContactsParams<contact_cell_list<problem_t>>())
+            : base_type(params)
+        {
+        }
+
+        /**
+         * @brief Compute neighboring particles.
+         *
+         * Compute contacts between particles using a cell list to select particles close enough.
+         * Then, compute the exact distance.
+         *
+         * Only the contact between particles \c i and \c j is computed, not the contact between \c j and \c i, with \c i < \c j.
+         *
+         * The returned array of neighbors is sorted.
+         * See sort_contacts.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param box [in] Simulation domain.
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         *
+         * @return Array of neighbors.
+         */
+        template <std::size_t dim, class particles_t>
+        auto run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
+
+        auto& default_contact_property()
+        {
+            return m_default_contact_property;
+        }
+
+      private:
+
+        /**
+         * @brief Bin the active particles into the cells of the grid.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         */
+        template <class particles_t>
+        void build_grid(const particles_t& particles, std::size_t active_ptr);
+
+        /**
+         * @brief Index of the cell that contains a point.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam position_t Type of the point.
+         * @param x [in] Point.
+         *
+         * @return Coordinates of the cell in the grid.
+         */
+        template <std::size_t dim, class position_t>
+        std::array<std::size_t, dim> cell_coordinates(const position_t& x) const;
+
+        /**
+         * @brief Linear index of a cell from its coordinates.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @param c [in] Coordinates of the cell.
+         *
+         * @return Index of the cell.
+         */
+        template <std::size_t dim>
+        std::size_t cell_index(const std::array<std::size_t, dim>& c) const;
+
+        /**
+         * @brief Number of exact distances computed.
+         */
+        std::size_t m_nMatches{0};
+        contact_property<problem_t> m_default_contact_property;
+        /**
+         * @brief Kind of the obstacles.
+         */
+        obstacle_index m_obstacles;
+
+        /**
+         * @brief Size of the cells.
+         */
+        double m_cell_size{1.};
+        /**
+         * @brief Lower corner of the grid.
+         */
+        std::array<double, 3> m_lower{};
+        /**
+         * @brief Number of cells in each direction.
+         */
+        std::array<std::size_t, 3> m_ncells{};
+        /**
+         * @brief Index of the first particle of each cell in m_cell_particles.
+         *
+         * The particles of the cell \c c are m_cell_particles[m_cell_start[c]] to m_cell_particles[m_cell_start[c + 1] - 1].
+         */
+        std::vector<std::size_t> m_cell_start;
+        /**
+         * @brief Indices of the active particles sorted by cell.
+         */
+        std::vector<std::size_t> m_cell_particles;
+        /**
+         * @brief Index of the cell of each active particle.
+         */
+        std::vector<std::size_t> m_particle_cell;
+    };
+
+    template <class problem_t>
+    template <std::size_t dim, class position_t>
+    std::array<std::size_t, dim> contact_cell_list<problem_t>::cell_coordinates(const position_t& x) const
+    {
+        std::array<std::size_t, dim> c;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            c[d] = std::min(m_ncells[d] - 1, static_cast<std::size_t>((x(d) - m_lower[d]) / m_cell_size));
+        }
+        return c;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim>
+    std::size_t contact_cell_list<problem_t>::cell_index(const std::array<std::size_t, dim>& c) const
+    {
+        std::size_t index = 0;
+        for (std::size_t d = dim; d-- > 0;)
+        {
+            index = index * m_ncells[d] + c[d];
+        }
+        return index;
+    }
+
+    template <class problem_t>
+    template <class particles_t>
+    void contact_cell_list<problem_t>::build_grid(const particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        const std::size_t npart = particles.nb_particles() - active_ptr;
+
+        const double rmax = particles.max_bounding_radius();
+        std::array<double, dim> upper;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_lower[d] = std::numeric_limits<double>::max();
+            upper[d]   = std::numeric_limits<double>::lowest();
+        }
+        for (std::size_t i = active_ptr; i < particles.nb_particles(); ++i)
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                m_lower[d] = std::min(m_lower[d], particles.position(i)(d));
+                upper[d]   = std::max(upper[d], particles.position(i)(d));
+            }
+        }
+
+        // two particles closer than dmax have their centers closer than dmax + 2 rmax
+        m_cell_size = this->get_params().dmax + 2. * rmax;
+        if (!(m_cell_size > 0.))
+        {
+            m_cell_size = 1.;
+        }
+
+        // the number of cells is limited by the number of particles, so that sparse configurations do not allocate huge grids
+        const double max_cells = 8. * static_cast<double>(std::max<std::size_t>(npart, 1));
+        double ncells_total    = 0.;
+        do
+        {
+            ncells_total = 1.;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                ncells_total *= (npart > 0) ? std::floor((upper[d] - m_lower[d]) / m_cell_size) + 1. : 1.;
+            }
+            if (ncells_total > max_cells)
+            {
+                m_cell_size *= 2.;
+            }
+        } while (ncells_total > max_cells);
+
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_ncells[d] = (npart > 0) ? static_cast<std::size_t>(std::floor((upper[d] - m_lower[d]) / m_cell_size)) + 1 : 1;
+        }
+
+        // counting sort of the particles by cell
+        const std::size_t ncells = static_cast<std::size_t>(ncells_total);
+        m_particle_cell.resize(npart);
+        m_cell_particles.resize(npart);
+        m_cell_start.assign(ncells + 1, 0);
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_particle_cell[k] = cell_index<dim>(cell_coordinates<dim>(particles.position(active_ptr + k)));
+            m_cell_start[m_particle_cell[k] + 1]++;
+        }
+        for (std::size_t c = 0; c < ncells; ++c)
+        {
+            m_cell_start[c + 1] += m_cell_start[c];
+        }
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_cell_particles[m_cell_start[m_particle_cell[k]]++] = active_ptr + k;
+        }
+        for (std::size_t c = ncells; c > 0; --c)
+        {
+            m_cell_start[c] = m_cell_start[c - 1];
+        }
+        m_cell_start[0] = 0;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim, class particles_t>
+    auto contact_cell_list<problem_t>::run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
+    {
+        std::vector<neighbor<dim, problem_t>> contacts;
+
+        add_objects_from_periodicity(box, particles, this->get_params().dmax);
+
+        tic();
+        build_grid(particles, active_ptr);
+        auto duration = toc();
+        PLOG_INFO << "----> CPUTIME : build cell list = " << duration << std::endl;
+
+        tic();
+
+        std::size_t nstencil = 1;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            nstencil *= 3;
+        }
+
+        const double dmax       = this->get_params().dmax;
+        const std::size_t npart = particles.nb_particles();
+
+        const auto& cache = this->get_closest_points_cache();
+        compute_obstacle_contacts(box,
+                                  particles,
+                                  active_ptr,
+                                  dmax,
+                                  m_obstacles,
+                                  m_default_contact_property,
+                                  cache,
+                                  contacts);
+
+        m_nMatches = compute_contacts_in_parallel(
+            active_ptr,
+            npart,
+            contacts,
+            [&](std::size_t i, std::vector<neighbor<dim, problem_t>>& buffer)
+            {
+                auto ci = cell_coordinates<dim>(particles.position(i));
+
+                std::vector<std::size_t> candidates;
+                for (std::size_t s = 0; s < nstencil; ++s)
+                {
+                    // s is written in base 3, each digit gives the shift -1, 0 or 1 in one direction
+                    std::array<std::size_t, dim> cj;
+                    bool inside = true;
+                    for (std::size_t d = 0, stride = 1; d < dim; ++d, stride *= 3)
+                    {
+                        std::ptrdiff_t c = static_cast<std::ptrdiff_t>(ci[d]) + static_cast<std::ptrdiff_t>((s / stride) % 3) - 1;
+                        if (c < 0 || c >= static_cast<std::ptrdiff_t>(m_ncells[d]))
+                        {
+                            inside = false;
+                            break;
+                        }
+                        cj[d] = static_cast<std::size_t>(c);
+                    }
+                    if (!inside)
+                    {
+                        continue;
+                    }
+
+                    std::size_t cell = cell_index<dim>(cj);
+                    for (std::size_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; ++k)
+                    {
+                        if (i < m_cell_particles[k])
+                        {
+                            candidates.push_back(m_cell_particles[k]);
+                        }
+                    }
+                }
+
+                // the contacts of i are computed by increasing j
+                std::sort(candidates.begin(), candidates.end());
+                return compute_contacts_with_candidates(box,
+                                                        particles,
+                                                        buffer,
+                                                        dmax,
+                                                        i,
+                                                        candidates.cbegin(),
+                                                        candidates.cend(),
+                                                        m_default_contact_property,
+                                                        cache);
+            });
+
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : compute " << contacts.size() << " contacts = " << duration << " compute " << m_nMatches
+                  << " distances" << std::endl;
+
+        tic();
+        sort_contacts(contacts);
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : sort " << contacts.size() << " contacts = " << duration << std::endl;
+
+        particles.reset_periodic();
+
+        return contacts;
+    }
+}
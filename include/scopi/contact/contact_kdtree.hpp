@@ -6,7 +6,12 @@
 #include "base.hpp"
 #include <CLI/CLI.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <vector>
+
 #include <plog/Initializers/RollingFileInitializer.h>
 #include <plog/Log.h>
 
@@ -40,7 +45,10 @@ namespace scopi
             auto& app = get_app();
             auto* opt = app.add_option_group("KD tree options");
             opt->add_option("--dmax", dmax, "Maximum distance between two neighboring particles")->capture_default_str();
-            opt->add_option("--kd-radius", kd_tree_radius, "Kd-tree radius")->capture_default_str();
+            opt->add_option("--kd-radius", kd_tree_radius, "Kd-tree radius (0 to compute it from the size of the particles)")
+                ->capture_default_str();
+            opt->add_option("--verlet-skin", verlet_skin, "Skin distance of the Verlet list (0 to rebuild the kd-tree at each step)")
+                ->capture_default_str();
         }
 
         /**
@@ -55,9 +63,28 @@ namespace scopi
          *
          * For two particles \c i and \c j, compute the exact distance only if the squared distance between a point in \c i and a point in
          * \c j is less than \c kdtree_radius. For a sphere or a superellipsoid, this point is the center. For a plane, it is the point used
-         * to construct it. \note \c kd_tree_radius > 0
+         * to construct it.
+         *
+         * If \c kd_tree_radius = 0, the radius is computed for each particle from the bounding radii (see
+         * scopi_container::bounding_radius): the particle \c i searches the particles closer than \f$ r_i + r_{max} + dmax \f$, where \f$
+         * r_{max} \f$ is the largest bounding radius, and the exact distance with \c j is computed only if the distance between the centers
+         * is less than \f$ r_i + r_j + dmax \f$.
+         *
+         * Default value: 0.
+         * \note \c kd_tree_radius >= 0
          */
-        double kd_tree_radius{17.};
+        double kd_tree_radius{0.};
+        /**
+         * @brief Skin distance of the Verlet list.
+         *
+         * If \c verlet_skin > 0, the candidate pairs are searched with a radius enlarged by \c verlet_skin and kept from one time step to
+         * the next. The kd-tree is rebuilt only when a particle has moved more than \c verlet_skin / 2 since the last build. Between two
+         * builds, only the exact distances between the cached pairs are computed.
+         *
+         * Default value: 0 (the kd-tree is rebuilt at each time step).
+         * \note \c verlet_skin >= 0
+         */
+        double verlet_skin{0.};
     };
 
     /**
@@ -66,8 +93,9 @@ namespace scopi
      * \todo Write documentation.
      *
      * @tparam dim Dimension (2 or 3).
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
      */
-    template <std::size_t dim>
+    template <std::size_t dim, class particles_t = scopi_container<dim>>
     class KdTree
     {
       public:
@@ -80,7 +108,7 @@ namespace scopi
          * @param p [in] Array of particles.
          * @param actptr [in] Index of the first active particle.
          */
-        KdTree(scopi_container<dim>& p, std::size_t actptr)
+        KdTree(const particles_t& p, std::size_t actptr)
             : m_p{p}
             , m_actptr{actptr}
         {
@@ -90,7 +118,7 @@ namespace scopi
         {
             // std::cout << "KDTREE m_p.size() = "<< m_p.size() <<std::endl;
             //  return m_p.pos().size();
-            return m_p.pos().size() - m_actptr;
+            return m_p.nb_particles() - m_actptr;
         }
 
         /**
@@ -106,7 +134,7 @@ namespace scopi
         inline double kdtree_get_pt(std::size_t idx, const std::size_t d) const
         {
             // std::cout << "KDTREE m_p["<< m_actptr+idx << "][" << d << "] = " << m_p.pos()(m_actptr+idx)[d] << std::endl;
-            return m_p.pos()(m_actptr + idx)(d); // m_p[idx]->pos()[d];
+            return m_p.position(m_actptr + idx)(d); // m_p[idx]->pos()[d];
             // return m_p.pos()(idx)[d];
         }
 
@@ -131,7 +159,7 @@ namespace scopi
         /**
          * @brief Array of particles.
          */
-        scopi_container<dim>& m_p;
+        const particles_t& m_p;
         /**
          * @brief Index of the first active particle.
          */
@@ -169,37 +197,114 @@ namespace scopi
          * Compute contacts between particles using a Kd-tree to select particles close enough.
          * Then, compute the exact distance.
          *
+         * If ContactsParams<contact_kdtree>::verlet_skin > 0, the particles selected with the Kd-tree are kept for the next time steps
+         * until a particle has moved more than half the skin distance.
+         *
          * Only the contact between particles \c i and \c j is computed, not the contact between \c j and \c i, with \c i < \c j.
          *
          * The returned array of neighbors is sorted.
          * See sort_contacts.
          *
          * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [in] Array of particles.
          * @param active_ptr [in] Index of the first active particle.
          *
          * @return Array of neighbors.
          */
-        template <std::size_t dim>
-        auto run_impl(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr);
+        template <std::size_t dim, class particles_t>
+        auto run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
 
         auto& default_contact_property()
         {
             return m_default_contact_property;
         }
 
+        /**
+         * @brief The candidates are searched again after a permutation of the particles.
+         *
+         * @param perm [in] Permutation of the particles.
+         */
+        void renumber_impl(const std::vector<std::size_t>& perm);
+
       private:
 
+        /**
+         * @brief Check if the candidate pairs have to be searched again.
+         *
+         * The candidate pairs are searched again if the Verlet list is disabled, if the number of particles has changed, if there are
+         * periodic particles or if a particle has moved more than half the skin distance since the last search.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         *
+         * @return Whether the candidate pairs have to be searched again.
+         */
+        template <class particles_t>
+        bool need_rebuild(const particles_t& particles, std::size_t active_ptr);
+
         /**
          * @brief Number of exact distances computed.
          */
         std::size_t m_nMatches{0};
         contact_property<problem_t> m_default_contact_property;
+        /**
+         * @brief Kind of the obstacles.
+         */
+        obstacle_index m_obstacles;
+
+        /**
+         * @brief Candidate neighbors \c j > \c i of each active particle \c i.
+         */
+        std::vector<std::vector<std::size_t>> m_candidates;
+        /**
+         * @brief Positions of the active particles when the candidates were searched.
+         */
+        std::vector<double> m_verlet_positions;
+        /**
+         * @brief Index of the first active particle when the candidates were searched.
+         */
+        std::size_t m_verlet_active_ptr{0};
     };
 
     template <class problem_t>
-    template <std::size_t dim>
-    auto contact_kdtree<problem_t>::run_impl(const BoxDomain<dim>& box, scopi_container<dim>& particles, std::size_t active_ptr)
+    void contact_kdtree<problem_t>::renumber_impl(const std::vector<std::size_t>&)
+    {
+        m_verlet_positions.clear();
+    }
+
+    template <class problem_t>
+    template <class particles_t>
+    bool contact_kdtree<problem_t>::need_rebuild(const particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        const double skin = this->get_params().verlet_skin;
+        if (skin <= 0. || active_ptr != m_verlet_active_ptr || m_verlet_positions.size() != dim * (particles.nb_particles() - active_ptr)
+            || particles.nb_particles() != particles.nb_particles(false))
+        {
+            return true;
+        }
+
+        double max_displacement = 0.;
+#pragma omp parallel for reduction(max : max_displacement)
+        for (std::size_t i = active_ptr; i < particles.nb_particles(); ++i)
+        {
+            double displacement = 0.;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                double dx = particles.position(i)(d) - m_verlet_positions[dim * (i - active_ptr) + d];
+                displacement += dx * dx;
+            }
+            max_displacement = std::max(max_displacement, displacement);
+        }
+        return max_displacement > 0.25 * skin * skin;
+    }
+
+    template <class problem_t>
+    template <std::size_t dim, class particles_t>
+    auto contact_kdtree<problem_t>::run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
     {
         // std::cout << "----> CONTACTS : run implementation contact_kdtree" << std::endl;
 
@@ -207,56 +312,126 @@ namespace scopi
 
         add_objects_from_periodicity(box, particles, this->get_params().dmax);
 
-        // utilisation de kdtree pour ne rechercher les contacts que pour les particules proches
-        tic();
-        using my_kd_tree_t = typename nanoflann::
-            KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<double, KdTree<dim>>, KdTree<dim>, dim, std::size_t>;
-        KdTree<dim> kd(particles, active_ptr);
-        my_kd_tree_t index(dim, kd, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
-        auto duration = toc();
-        PLOG_INFO << "----> CPUTIME : build kdtree index = " << duration << std::endl;
+        const double skin = this->get_params().verlet_skin;
+        auto duration     = 0.;
+        if (need_rebuild(particles, active_ptr))
+        {
+            // utilisation de kdtree pour ne rechercher les contacts que pour les particules proches
+            tic();
+            using kd_tree_adaptor_t = KdTree<dim, particles_t>;
+            using my_kd_tree_t      = typename nanoflann::
+                KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<double, kd_tree_adaptor_t>, kd_tree_adaptor_t, dim, std::size_t>;
+            kd_tree_adaptor_t kd(particles, active_ptr);
+            my_kd_tree_t index(dim, kd, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+            duration = toc();
+            PLOG_INFO << "----> CPUTIME : build kdtree index = " << duration << std::endl;
+
+            tic();
+            const double kd_tree_radius = this->get_params().kd_tree_radius;
+            const double max_radius     = particles.max_bounding_radius() + this->get_params().dmax + skin;
+
+            m_candidates.resize(particles.nb_particles() - active_ptr);
+#pragma omp parallel for
+            for (std::size_t i = active_ptr; i < particles.nb_particles(); ++i)
+            {
+                auto& candidates = m_candidates[i - active_ptr];
+                candidates.clear();
 
-        tic();
+                std::array<double, dim> query_pt;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    query_pt[d] = particles.position(i)(d);
+                }
+                PLOG_DEBUG << "i = " << i << " query_pt = " << query_pt[0] << " " << query_pt[1] << std::endl;
 
-        m_nMatches = 0;
-#pragma omp parallel for reduction(+ : m_nMatches) // num_threads(1)
+                // nanoflann uses squared distances
+                double radius = (kd_tree_radius > 0.) ? std::sqrt(kd_tree_radius) + skin : particles.bounding_radius(i) + max_radius;
+                radius *= radius;
 
-        for (std::size_t i = active_ptr; i < particles.pos().size() - 1; ++i)
-        {
-            std::array<double, dim> query_pt;
-            for (std::size_t d = 0; d < dim; ++d)
-            {
-                query_pt[d] = particles.pos()(i)(d);
-            }
-            PLOG_DEBUG << "i = " << i << " query_pt = " << query_pt[0] << " " << query_pt[1] << std::endl;
+                std::vector<nanoflann::ResultItem<std::size_t, double>> ret_matches;
 
-            std::vector<nanoflann::ResultItem<std::size_t, double>> ret_matches;
+                auto nMatches_loc = index.radiusSearch(query_pt.data(), radius, ret_matches, nanoflann::SearchParameters());
 
-            auto nMatches_loc = index.radiusSearch(query_pt.data(),
-                                                   this->get_params().kd_tree_radius,
-                                                   ret_matches,
-                                                   nanoflann::SearchParameters());
+                for (std::size_t ic = 0; ic < nMatches_loc; ++ic)
+                {
+                    std::size_t j = ret_matches[ic].first + active_ptr;
+                    if (i < j)
+                    {
+                        candidates.push_back(j);
+                    }
+                }
+                std::sort(candidates.begin(), candidates.end());
+            }
 
-            for (std::size_t ic = 0; ic < nMatches_loc; ++ic)
+            m_verlet_active_ptr = active_ptr;
+            m_verlet_positions.resize(dim * (particles.nb_particles() - active_ptr));
+            for (std::size_t i = active_ptr; i < particles.nb_particles(); ++i)
             {
-                std::size_t j = ret_matches[ic].first + particles.offset(particles.object_index(active_ptr));
-                if (i < j)
+                for (std::size_t d = 0; d < dim; ++d)
                 {
-                    compute_exact_distance<problem_t>(box, particles, contacts, this->get_params().dmax, i, j, m_default_contact_property);
-                    m_nMatches++;
+                    m_verlet_positions[dim * (i - active_ptr) + d] = particles.position(i)(d);
                 }
             }
+            duration = toc();
+            PLOG_INFO << "----> CPUTIME : search " << (skin > 0. ? "Verlet list " : "") << "candidates = " << duration << std::endl;
         }
-
-        // obstacles
-        for (std::size_t i = 0; i < active_ptr; ++i)
+        else
         {
-            for (std::size_t j = active_ptr; j < particles.pos().size(); ++j)
-            {
-                compute_exact_distance<problem_t>(box, particles, contacts, this->get_params().dmax, i, j, m_default_contact_property);
-            }
+            PLOG_INFO << "----> reuse Verlet list" << std::endl;
         }
 
+        tic();
+        const double dmax       = this->get_params().dmax;
+        const std::size_t npart = particles.nb_particles();
+
+        const auto& cache = this->get_closest_points_cache();
+        compute_obstacle_contacts(box,
+                                  particles,
+                                  active_ptr,
+                                  dmax,
+                                  m_obstacles,
+                                  m_default_contact_property,
+                                  cache,
+                                  contacts);
+
+        const double kd_tree_radius = this->get_params().kd_tree_radius;
+        m_nMatches                  = compute_contacts_in_parallel(
+            active_ptr,
+            npart,
+            contacts,
+            [&](std::size_t i, std::vector<neighbor<dim, problem_t>>& buffer)
+            {
+                const auto x_i         = particles.position(i);
+                const auto& candidates = m_candidates[i - active_ptr];
+                return compute_contacts_with_candidates(
+                    box,
+                    particles,
+                    buffer,
+                    dmax,
+                    i,
+                    candidates.cbegin(),
+                    candidates.cend(),
+                    m_default_contact_property,
+                    cache,
+                    [&](std::size_t j)
+                    {
+                        // the candidates are filtered with the radius without skin to get the same contacts as without Verlet list
+                        if (kd_tree_radius > 0. && skin <= 0.)
+                        {
+                            return true;
+                        }
+                        const auto x_j = particles.position(j);
+                        double dist2   = 0.;
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            double dx = x_i(d) - x_j(d);
+                            dist2 += dx * dx;
+                        }
+                        double radius = particles.bounding_radius(i) + particles.bounding_radius(j) + dmax;
+                        return dist2 < ((kd_tree_radius > 0.) ? kd_tree_radius : radius * radius);
+                    });
+            });
+
         duration = toc();
         PLOG_INFO << "----> CPUTIME : compute " << contacts.size() << " contacts = " << duration << " compute " << m_nMatches
                   << " distances" << std::endl;
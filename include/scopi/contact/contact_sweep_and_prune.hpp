@@ -0,0 +1,407 @@
+#pragma once
+
+#include "../box.hpp"
+#include "../scopi.hpp"
+#include "../utils.hpp"
+#include "base.hpp"
+#include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <plog/Initializers/RollingFileInitializer.h>
+#include <plog/Log.h>
+
+namespace scopi
+{
+
+    template <class problem_t>
+    class contact_sweep_and_prune;
+
+    /**
+     * @brief Parameters for contact_sweep_and_prune.
+     *
+     * Specialization of ContactsParams.
+     */
+    template <class problem_t>
+    struct ContactsParams<contact_sweep_and_prune<problem_t>>
+    {
+        void init_options()
+        {
+            auto& app = get_app();
+            auto* opt = app.add_option_group("Sweep and prune options");
+            opt->add_option("--dmax", dmax, "Maximum distance between two neighboring particles")->capture_default_str();
+            opt->add_option("--sweep-axis", sweep_axis, "Axis along which the bounding boxes are sorted")->capture_default_str();
+        }
+
+        /**
+         * @brief Maximum distance between two neighboring particles.
+         *
+         * Default value: 2.
+         * \note \c dmax > 0
+         */
+        double dmax{2.};
+        /**
+         * @brief Axis along which the bounding boxes are sorted.
+         *
+         * The overlap of the bounding boxes is checked along the other axes.
+         * The best choice is the axis along which the particles are the most spread.
+         *
+         * Default value: 0.
+         * \note \c sweep_axis < dim
+         */
+        std::size_t sweep_axis{0};
+    };
+
+    /**
+     * @brief Contacts with sweep and prune.
+     *
+     * Each active particle is bounded by a box of half size its bounding radius plus \c dmax / 2 (see scopi_container::bounding_radius).
+     * The boxes are sorted by their lower bound along ContactsParams<contact_sweep_and_prune>::sweep_axis and two particles are
+     * candidates if their boxes overlap in all directions. The exact distance is then computed for the candidates whose bounding balls
+     * are closer than \c dmax.
+     *
+     * The order of the boxes is kept from one time step to the next and updated with an insertion sort. The particles move a little
+     * during a time step, so the order is nearly sorted and the update is nearly linear.
+     */
+    template <class problem_t>
+    class contact_sweep_and_prune : public contact_base<contact_sweep_and_prune<problem_t>>
+    {
+      public:
+
+        /**
+         * @brief Alias for the base class contact_base.
+         */
+        using base_type = contact_base<contact_sweep_and_prune<problem_t>>;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param params [in] Parameters.
+         */
+        explicit contact_sweep_and_prune(
+            const ContactsParams<contact_sweep_and_prune<problem_t>>& params = ContactsParams<contact_sweep_and_prune<problem_t>>())
+            : base_type(params)
+        {
+        }
+
+        /**
+         * @brief Compute neighboring particles.
+         *
+         * Compute contacts between particles using sweep and prune to select particles close enough.
+         * Then, compute the exact distance.
+         *
+         * Only the contact between particles \c i and \c j is computed, not the contact between \c j and \c i, with \c i < \c j.
+         *
+         * The returned array of neighbors is sorted.
+         * See sort_contacts.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param box [in] Simulation domain.
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         *
+         * @return Array of neighbors.
+         */
+        template <std::size_t dim, class particles_t>
+        auto run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr);
+
+        auto& default_contact_property()
+        {
+            return m_default_contact_property;
+        }
+
+        /**
+         * @brief Apply a permutation of the particles to the order of the boxes, which stays nearly sorted.
+         *
+         * @param perm [in] Permutation of the particles: the particle \c i is now the particle \c perm[i].
+         */
+        void renumber_impl(const std::vector<std::size_t>& perm);
+
+      private:
+
+        /**
+         * @brief Update the bounding boxes and their order along the sweep axis.
+         *
+         * The particles that are not in the container anymore are removed from the order and the new particles (for instance, periodic
+         * particles) are added at the end before the insertion sort.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         */
+        template <class particles_t>
+        void update_order(const particles_t& particles, std::size_t active_ptr);
+
+        /**
+         * @brief Find the pairs of overlapping boxes.
+         *
+         * The candidates are stored for the particle with the smallest index, sorted by increasing index.
+         *
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+         * @param particles [in] Array of particles.
+         * @param active_ptr [in] Index of the first active particle.
+         */
+        template <class particles_t>
+        void sweep(const particles_t& particles, std::size_t active_ptr);
+
+        /**
+         * @brief Number of exact distances computed.
+         */
+        std::size_t m_nMatches{0};
+        contact_property<problem_t> m_default_contact_property;
+        /**
+         * @brief Kind of the obstacles.
+         */
+        obstacle_index m_obstacles;
+
+        /**
+         * @brief Index of the first active particle at the previous time step.
+         */
+        std::size_t m_active_ptr{0};
+        /**
+         * @brief Active particles (relative to the first active particle) sorted by the lower bound of their box.
+         */
+        std::vector<std::size_t> m_order;
+        /**
+         * @brief Lower bound of the box of each active particle along the sweep axis.
+         */
+        std::vector<double> m_lower;
+        /**
+         * @brief Half size of the box of each active particle.
+         */
+        std::vector<double> m_extent;
+        /**
+         * @brief Whether an active particle is in m_order.
+         */
+        std::vector<bool> m_in_order;
+        /**
+         * @brief Pairs of overlapping boxes.
+         */
+        std::vector<std::pair<std::size_t, std::size_t>> m_pairs;
+        /**
+         * @brief Index of the first candidate of each active particle in m_candidates.
+         */
+        std::vector<std::size_t> m_candidates_start;
+        /**
+         * @brief Candidates \c j > \c i of each active particle \c i.
+         */
+        std::vector<std::size_t> m_candidates;
+    };
+
+    template <class problem_t>
+    void contact_sweep_and_prune<problem_t>::renumber_impl(const std::vector<std::size_t>& perm)
+    {
+        // the periodic images are added again at the end by update_order
+        std::size_t n = 0;
+        for (std::size_t k : m_order)
+        {
+            if (m_active_ptr + k < perm.size() && perm[m_active_ptr + k] != std::size_t(-1))
+            {
+                m_order[n++] = perm[m_active_ptr + k] - m_active_ptr;
+            }
+        }
+        m_order.resize(n);
+    }
+
+    template <class problem_t>
+    template <class particles_t>
+    void contact_sweep_and_prune<problem_t>::update_order(const particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        const std::size_t npart = particles.nb_particles() - active_ptr;
+        const std::size_t axis  = std::min(this->get_params().sweep_axis, dim - 1);
+        const double half_dmax  = 0.5 * this->get_params().dmax;
+
+        if (active_ptr != m_active_ptr)
+        {
+            m_order.clear();
+            m_active_ptr = active_ptr;
+        }
+
+        m_lower.resize(npart);
+        m_extent.resize(npart);
+#pragma omp parallel for
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_extent[k] = particles.bounding_radius(active_ptr + k) + half_dmax;
+            m_lower[k]  = particles.position(active_ptr + k)(axis) - m_extent[k];
+        }
+
+        m_order.erase(std::remove_if(m_order.begin(),
+                                     m_order.end(),
+                                     [npart](std::size_t k)
+                                     {
+                                         return k >= npart;
+                                     }),
+                      m_order.end());
+        m_in_order.assign(npart, false);
+        for (std::size_t k : m_order)
+        {
+            m_in_order[k] = true;
+        }
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            if (!m_in_order[k])
+            {
+                m_order.push_back(k);
+            }
+        }
+
+        // insertion sort, the order of the previous time step is nearly sorted
+        for (std::size_t p = 1; p < m_order.size(); ++p)
+        {
+            std::size_t k = m_order[p];
+            double key    = m_lower[k];
+            std::size_t q = p;
+            while (q > 0 && m_lower[m_order[q - 1]] > key)
+            {
+                m_order[q] = m_order[q - 1];
+                --q;
+            }
+            m_order[q] = k;
+        }
+    }
+
+    template <class problem_t>
+    template <class particles_t>
+    void contact_sweep_and_prune<problem_t>::sweep(const particles_t& particles, std::size_t active_ptr)
+    {
+        constexpr std::size_t dim = particles_t::dim;
+
+        const std::size_t npart = m_order.size();
+        const std::size_t axis  = std::min(this->get_params().sweep_axis, dim - 1);
+
+        m_pairs.clear();
+        for (std::size_t p = 0; p < npart; ++p)
+        {
+            std::size_t a  = m_order[p];
+            double upper   = m_lower[a] + 2. * m_extent[a];
+            const auto x_a = particles.position(active_ptr + a);
+            for (std::size_t q = p + 1; q < npart && m_lower[m_order[q]] < upper; ++q)
+            {
+                std::size_t b  = m_order[q];
+                const auto x_b = particles.position(active_ptr + b);
+                bool overlap   = true;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    if (d != axis && std::abs(x_a(d) - x_b(d)) >= m_extent[a] + m_extent[b])
+                    {
+                        overlap = false;
+                        break;
+                    }
+                }
+                if (overlap)
+                {
+                    m_pairs.emplace_back(std::min(a, b), std::max(a, b));
+                }
+            }
+        }
+
+        // counting sort of the pairs by their first particle
+        m_candidates_start.assign(npart + 1, 0);
+        for (const auto& pair : m_pairs)
+        {
+            m_candidates_start[pair.first + 1]++;
+        }
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_candidates_start[k + 1] += m_candidates_start[k];
+        }
+        m_candidates.resize(m_pairs.size());
+        for (const auto& pair : m_pairs)
+        {
+            m_candidates[m_candidates_start[pair.first]++] = active_ptr + pair.second;
+        }
+        for (std::size_t k = npart; k > 0; --k)
+        {
+            m_candidates_start[k] = m_candidates_start[k - 1];
+        }
+        m_candidates_start[0] = 0;
+
+#pragma omp parallel for
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            std::sort(m_candidates.begin() + static_cast<std::ptrdiff_t>(m_candidates_start[k]),
+                      m_candidates.begin() + static_cast<std::ptrdiff_t>(m_candidates_start[k + 1]));
+        }
+    }
+
+    template <class problem_t>
+    template <std::size_t dim, class particles_t>
+    auto contact_sweep_and_prune<problem_t>::run_impl(const BoxDomain<dim>& box, particles_t& particles, std::size_t active_ptr)
+    {
+        std::vector<neighbor<dim, problem_t>> contacts;
+
+        add_objects_from_periodicity(box, particles, this->get_params().dmax);
+
+        tic();
+        update_order(particles, active_ptr);
+        sweep(particles, active_ptr);
+        auto duration = toc();
+        PLOG_INFO << "----> CPUTIME : sweep and prune = " << duration << std::endl;
+
+        tic();
+        const double dmax       = this->get_params().dmax;
+        const std::size_t npart = particles.nb_particles();
+
+        const auto& cache = this->get_closest_points_cache();
+        compute_obstacle_contacts(box,
+                                  particles,
+                                  active_ptr,
+                                  dmax,
+                                  m_obstacles,
+                                  m_default_contact_property,
+                                  cache,
+                                  contacts);
+
+        m_nMatches = compute_contacts_in_parallel(
+            active_ptr,
+            npart,
+            contacts,
+            [&](std::size_t i, std::vector<neighbor<dim, problem_t>>& buffer)
+            {
+                const auto x_i = particles.position(i);
+                return compute_contacts_with_candidates(
+                    box,
+                    particles,
+                    buffer,
+                    dmax,
+                    i,
+                    m_candidates.cbegin() + static_cast<std::ptrdiff_t>(m_candidates_start[i - active_ptr]),
+                    m_candidates.cbegin() + static_cast<std::ptrdiff_t>(m_candidates_start[i - active_ptr + 1]),
+                    m_default_contact_property,
+                    cache,
+                    [&](std::size_t j)
+                    {
+                        const auto x_j = particles.position(j);
+                        double dist2   = 0.;
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            double dx = x_i(d) - x_j(d);
+                            dist2 += dx * dx;
+                        }
+                        double radius = particles.bounding_radius(i) + particles.bounding_radius(j) + dmax;
+                        return dist2 < radius * radius;
+                    });
+            });
+
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : compute " << contacts.size() << " contacts = " << duration << " compute " << m_nMatches
+                  << " distances" << std::endl;
+
+        tic();
+        sort_contacts(contacts);
+        duration = toc();
+        PLOG_INFO << "----> CPUTIME : sort " << contacts.size() << " contacts = " << duration << std::endl;
+
+        particles.reset_periodic();
+
+        return contacts;
+    }
+}
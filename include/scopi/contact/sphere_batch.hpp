@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <xsimd/xsimd.hpp>
+
+#include "../objects/neighbor.hpp"
+#include "property.hpp"
+
+namespace scopi
+{
+    /**
+     * @brief Batched closest points between a sphere and several spheres.
+     *
+     * The spheres \c j are gathered in a structure of arrays (one array per coordinate and one array for the radii), so that the
+     * distances between the centers, the normals and the contact points are computed with xsimd batches. The test
+     * \f$ d_{ij} < d_{max} \f$ is a vector mask whose accepted indices are compressed before the normals are computed. The neighbors
+     * are then built from the closed form of closest_points between two spheres: \f$ u = (x_j - x_i) / \|x_j - x_i\| \f$,
+     * \f$ p_i = x_i + r_i u \f$, \f$ p_j = x_j - r_j u \f$, \f$ n_{ij} = -u \f$ and \f$ d_{ij} = \|x_j - x_i\| - r_i - r_j \f$.
+     * The spheres are never reconstructed as objects.
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    class sphere_batch
+    {
+      public:
+
+        /**
+         * @brief Number of spheres in the batch.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Add a sphere in the batch.
+         *
+         * @tparam position_t Type of the position.
+         * @param j [in] Index of the sphere.
+         * @param x [in] Position of the sphere.
+         * @param radius [in] Radius of the sphere.
+         */
+        template <class position_t>
+        void push_back(std::size_t j, const position_t& x, double radius);
+
+        /**
+         * @brief Compute the contacts between a sphere and the spheres of the batch, then empty the batch.
+         *
+         * The contacts are added in the order of the batch.
+         *
+         * @tparam problem_t Problem to be solved.
+         * @tparam position_t Type of the position.
+         * @param i [in] Index of the sphere.
+         * @param x_i [in] Position of the sphere.
+         * @param r_i [in] Radius of the sphere.
+         * @param dmax [in] Maximum distance to consider two particles to be neighbors.
+         * @param default_contact_property [in] Default contact property.
+         * @param contacts [inout] Array of neighbors, the contacts found are added at the end.
+         */
+        template <class problem_t, class position_t>
+        void compute(std::size_t i,
+                     const position_t& x_i,
+                     double r_i,
+                     double dmax,
+                     const contact_property<problem_t>& default_contact_property,
+                     std::vector<neighbor<dim, problem_t>>& contacts);
+
+      private:
+
+        /**
+         * @brief Indices of the spheres.
+         */
+        std::vector<std::size_t> m_index;
+        /**
+         * @brief Coordinates of the centers, one array per direction.
+         */
+        std::array<std::vector<double>, dim> m_x;
+        /**
+         * @brief Radii of the spheres.
+         */
+        std::vector<double> m_radius;
+        /**
+         * @brief Distances between the centers.
+         */
+        std::vector<double> m_distance;
+        /**
+         * @brief Indices in the batch of the spheres such that \f$ d_{ij} < d_{max} \f$.
+         */
+        std::vector<std::size_t> m_selected;
+        /**
+         * @brief Normals of the selected spheres, one array per direction.
+         */
+        std::array<std::vector<double>, dim> m_nij;
+        /**
+         * @brief Contact points on the sphere \c i, one array per direction.
+         */
+        std::array<std::vector<double>, dim> m_pi;
+        /**
+         * @brief Contact points on the selected spheres, one array per direction.
+         */
+        std::array<std::vector<double>, dim> m_pj;
+    };
+
+    template <std::size_t dim>
+    std::size_t sphere_batch<dim>::size() const
+    {
+        return m_index.size();
+    }
+
+    template <std::size_t dim>
+    template <class position_t>
+    void sphere_batch<dim>::push_back(std::size_t j, const position_t& x, double radius)
+    {
+        m_index.push_back(j);
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_x[d].push_back(x(d));
+        }
+        m_radius.push_back(radius);
+    }
+
+    template <std::size_t dim>
+    template <class problem_t, class position_t>
+    void sphere_batch<dim>::compute(std::size_t i,
+                                    const position_t& x_i,
+                                    double r_i,
+                                    double dmax,
+                                    const contact_property<problem_t>& default_contact_property,
+                                    std::vector<neighbor<dim, problem_t>>& contacts)
+    {
+        using batch_t = xsimd::batch<double>;
+
+        constexpr std::size_t lanes = batch_t::size;
+        const std::size_t n         = m_index.size();
+        if (n == 0)
+        {
+            return;
+        }
+
+        // the padding spheres have a radius -inf, their distance is +inf and they are never selected
+        const std::size_t padded = (n + lanes - 1) / lanes * lanes;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_x[d].resize(padded, 0.);
+        }
+        m_radius.resize(padded, -std::numeric_limits<double>::infinity());
+        m_distance.resize(padded);
+        m_selected.resize(padded);
+
+        std::array<batch_t, dim> center;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            center[d] = batch_t(x_i(d));
+        }
+        const batch_t r_i_b(r_i);
+        const batch_t dmax_b(dmax);
+
+        // distances and mask dij < dmax, the accepted indices are compressed in m_selected without branch
+        std::size_t nb_selected = 0;
+        for (std::size_t k = 0; k < padded; k += lanes)
+        {
+            batch_t dist2(0.);
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const batch_t dx = batch_t::load_unaligned(m_x[d].data() + k) - center[d];
+                dist2 += dx * dx;
+            }
+            const batch_t distance = xsimd::sqrt(dist2);
+            distance.store_unaligned(m_distance.data() + k);
+            const auto mask = (distance - r_i_b - batch_t::load_unaligned(m_radius.data() + k) < dmax_b).mask();
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                m_selected[nb_selected] = k + l;
+                nb_selected += (mask >> l) & 1;
+            }
+        }
+
+        // the selected spheres are moved to the front of the arrays (m_selected[s] >= s), the tail is padded again
+        const std::size_t padded_selected = (nb_selected + lanes - 1) / lanes * lanes;
+        for (std::size_t s = 0; s < padded_selected; ++s)
+        {
+            const std::size_t k = s < nb_selected ? m_selected[s] : n;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                m_x[d][s] = k < n ? m_x[d][k] : 0.;
+            }
+            m_radius[s]   = k < n ? m_radius[k] : 0.;
+            m_distance[s] = k < n ? m_distance[k] : 1.;
+        }
+
+        // normals and contact points of the selected spheres
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_nij[d].resize(padded_selected);
+            m_pi[d].resize(padded_selected);
+            m_pj[d].resize(padded_selected);
+        }
+        for (std::size_t s = 0; s < padded_selected; s += lanes)
+        {
+            const batch_t distance = batch_t::load_unaligned(m_distance.data() + s);
+            const batch_t radius   = batch_t::load_unaligned(m_radius.data() + s);
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const batch_t x = batch_t::load_unaligned(m_x[d].data() + s);
+                const batch_t u = (x - center[d]) / distance;
+                (-u).store_unaligned(m_nij[d].data() + s);
+                (center[d] + r_i_b * u).store_unaligned(m_pi[d].data() + s);
+                (x - radius * u).store_unaligned(m_pj[d].data() + s);
+            }
+        }
+
+        for (std::size_t s = 0; s < nb_selected; ++s)
+        {
+            neighbor<dim, problem_t> neigh;
+            neigh.i   = i;
+            neigh.j   = m_index[m_selected[s]];
+            neigh.dij = m_distance[s] - r_i - m_radius[s];
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                neigh.nij(d) = m_nij[d][s];
+                neigh.pi(d)  = m_pi[d][s];
+                neigh.pj(d)  = m_pj[d][s];
+            }
+            neigh.property = default_contact_property;
+            contacts.emplace_back(std::move(neigh));
+        }
+
+        m_index.clear();
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            m_x[d].clear();
+        }
+        m_radius.clear();
+    }
+}
@@ -3,17 +3,24 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include <xtensor/xadapt.hpp>
 
 #include "crtp.hpp"
+#include "objects/methods/bounding_radius.hpp"
 #include "objects/methods/select.hpp"
+#include "objects/shape_tag.hpp"
 #include "objects/types/base.hpp"
 #include "property.hpp"
+#include "soa.hpp"
+#include "space_filling_curve.hpp"
 #include "types.hpp"
 
 namespace scopi
@@ -28,13 +35,23 @@ namespace scopi
      * Array of particles.
      *
      * Inactive particles are placed at the begining of the container.
-     * Fictive particles for periodic boundary conditions are placed at the end
-     * of the container.
+     * Fictive particles for periodic boundary conditions (periodic images) are
+     * numbered after the particles of the container. They are not stored: an
+     * image is only the index of the particle it comes from and the shift
+     * applied to its position.
      *
      * In the following, "particle" means a base object (sphere, superellipsoid
      * or plane) and an "object" can be a more complex object, such as a worm.
      * Particles are objects.
      *
+     * The positions and the quaternions are stored as arrays of \c xtensor_fixed, because the views of the objects point to them
+     * (an object with several particles reads its positions contiguously); pos() and q() are unchanged and there is no option to
+     * store them in columns, so the matrix-free operators still gather \c pos()(i)(d) and \c q()(i).
+     * The other fields (velocities, rotations, forces, masses and moments of inertia) are stored in structure of arrays, with one
+     * aligned column per component (see soa_array), so that the update loops on the particles are vectorized. Their accessors
+     * return a soa_view: \c v()(i)(d) is still the component \c d of the velocity of the particle \c i, and \c v().column(d) is
+     * the column of the components \c d.
+     *
      * @tparam dim Dimension (2 or 3).
      */
     template <std::size_t Dim>
@@ -71,6 +88,10 @@ namespace scopi
          * @brief Alias for the type of the quaternion.
          */
         using quaternion_type = type::quaternion_t;
+        /**
+         * @brief Number of components of a rotation and of a moment of inertia (1 in 2D, 3 in 3D).
+         */
+        static constexpr std::size_t rotation_size = dim == 2 ? 1 : 3;
 
         /**
          * @brief Reconstructs an object.
@@ -87,22 +108,26 @@ namespace scopi
         /**
          * @brief Appends the given element value to the end of the container.
          *
+         * The particles of the object get new identifiers (see particle_id). Active objects can be appended between two time steps of
+         * a simulation, for instance at an inlet.
+         *
          * @param s [in] Object to append.
          * @param p [in] Properties of the object (see property.hpp).
          */
         void push_back(const object<dim>& s, const property<dim>& p = property<dim>());
         /**
-         * @brief Copy a particle that was already in the container with a new
-         * position.
+         * @brief Add a periodic image of a particle.
          *
-         * The original particle remains unchanged.
-         * All the other physical properties of the particle are copied, only
-         * the position is different. Used for periodic boundary conditions.
+         * The image has index <tt>periodic_ptr() + k</tt>, where \c k is the
+         * number of images already added. Its position is the position of the
+         * particle \c i plus \c shift and all its other properties are the
+         * ones of the particle \c i. Nothing is copied. Used for periodic
+         * boundary conditions.
          *
-         * @param i [in] Index of the particle to copy.
-         * @param pos [in] Position of the new particle.
+         * @param i [in] Index of the particle.
+         * @param shift [in] Shift of the position of the image.
          */
-        void push_back(std::size_t i, const std::vector<position_type>& pos);
+        void add_periodic_image(std::size_t i, const position_type& shift);
 
         /**
          * @brief Increase the capacity of the container.
@@ -119,6 +144,37 @@ namespace scopi
          */
         void reserve(std::size_t size);
 
+        /**
+         * @brief Sort the active objects along a space-filling curve.
+         *
+         * The key of an object is the cell of the curve that contains the mean position of its particles, in the bounding box of
+         * the active particles. The objects are sorted by key and all the arrays of the container are permuted, so that the
+         * particles close in space are close in memory. The obstacles stay at the beginning of the container and keep their
+         * indices, the particles of an object stay contiguous, and particle_id does not change.
+         *
+         * \pre There is no periodic image.
+         *
+         * @param curve [in] Space-filling curve.
+         *
+         * @return Permutation of the particles: the particle \c i before the call is the particle \c perm[i].
+         */
+        std::vector<std::size_t> reorder(space_filling_curve curve);
+
+        /**
+         * @brief Remove an active object.
+         *
+         * The last object takes the place of the removed one if it has the same number of particles, so removing a sphere does not
+         * move the other ones and costs O(1). Otherwise, the objects after the removed one are shifted, which costs O(N) where N is the
+         * number of particles. The other particles keep their identifiers (see particle_id and particle_index).
+         *
+         * If the removed object had the largest bounding radius, max_bounding_radius is computed again from the active particles.
+         *
+         * \pre There is no periodic image.
+         *
+         * @param i [in] Index of the object, which is not an obstacle.
+         */
+        void erase(std::size_t i);
+
         /**
          * @brief Array of particles' positions.
          */
@@ -202,8 +258,16 @@ namespace scopi
 
         /**
          * @brief Number of objects in the container.
+         *
+         * The periodic images are not objects.
+         */
+        std::size_t size() const;
+        /**
+         * @brief Number of particles in the container.
+         *
+         * @param with_periodic [in] Whether the periodic images are counted.
          */
-        std::size_t size(bool with_periodic = true) const;
+        std::size_t nb_particles(bool with_periodic = true) const;
         /**
          * @brief Number of active particles in the container.
          */
@@ -213,13 +277,32 @@ namespace scopi
          */
         std::size_t nb_inactive() const;
 
+        /**
+         * @brief Stable identifier of a particle or of a periodic image.
+         *
+         * Number of particles added to the container before this one, kept when the container is reordered (see reorder) or when
+         * other objects are removed (see erase). The identifier of a periodic image is the one of its particle.
+         *
+         * @param i [in] Index of the particle.
+         */
+        std::size_t particle_id(std::size_t i) const;
+        /**
+         * @brief Index of a particle from its identifier (see particle_id).
+         *
+         * @param id [in] Identifier of the particle.
+         *
+         * @return Index of the particle, <tt>std::size_t(-1)</tt> if it was removed.
+         */
+        std::size_t particle_index(std::size_t id) const;
+
         /**
          * @brief Convert a particle index into an object index.
          *
          * The particle \c i is part of the object \c j, where \c j is the index
-         * of an object.
+         * of an object. The object of a periodic image is the object of its
+         * particle. The index is read in a table, in constant time.
          *
-         * @param i [in] Index of a particle.
+         * @param i [in] Index of a particle (or of a periodic image).
          *
          * @return Index of the object.
          */
@@ -235,11 +318,101 @@ namespace scopi
 
         /**
          * @brief Remove all fictive particles.
+         *
+         * The memory used by the images is kept for the next time step.
          */
         void reset_periodic();
 
+        /**
+         * @brief Index of the first periodic image, which is the number of
+         * particles in the container.
+         */
         std::size_t periodic_ptr() const;
+        /**
+         * @brief Index of the particle of a periodic image.
+         *
+         * @param i [in] Index of the image, relative to periodic_ptr().
+         */
         std::size_t periodic_index(std::size_t i) const;
+        /**
+         * @brief Shift of the position of a periodic image.
+         *
+         * @param i [in] Index of the image, relative to periodic_ptr().
+         */
+        const position_type& periodic_shift(std::size_t i) const;
+
+        /**
+         * @brief Position of a particle or of a periodic image.
+         *
+         * @param i [in] Index of the particle, smaller than nb_particles().
+         */
+        position_type position(std::size_t i) const;
+
+        /**
+         * @brief Bounding radius of a particle or of a periodic image.
+         *
+         * Radius of a ball centered at the position of the particle that contains it (see bounding_radius.hpp).
+         * It is computed once for each shape, when the first object of this shape is added.
+         *
+         * @param i [in] Index of the particle.
+         */
+        double bounding_radius(std::size_t i) const;
+        /**
+         * @brief Largest bounding radius of the active particles.
+         */
+        double max_bounding_radius() const;
+        /**
+         * @brief Whether a particle or a periodic image is a sphere.
+         *
+         * The spheres of a worm are spheres.
+         *
+         * @param i [in] Index of the particle.
+         */
+        bool is_sphere(std::size_t i) const;
+
+        /**
+         * @brief Tag of the shape of an object (see shape_tag.hpp).
+         *
+         * @param i [in] Index of the object.
+         */
+        shape_tag_t object_tag(std::size_t i) const;
+        /**
+         * @brief Tag of the shape of a particle or of a periodic image (see shape_tag.hpp).
+         *
+         * The particles of a worm are spheres.
+         *
+         * @param i [in] Index of the particle.
+         */
+        shape_tag_t particle_tag(std::size_t i) const;
+
+        /**
+         * @brief Call a function with a view of an object.
+         *
+         * Unlike operator[], the view is built on the stack from a prototype of the shape of the object, without allocation, and is
+         * only valid during the call.
+         *
+         * @tparam Func Type of the function, with signature \c R(const object<dim, false>&, shape_tag_t).
+         * @param i [in] Index of the object.
+         * @param f [in] Function called with the view and its tag.
+         *
+         * @return Result of the function.
+         */
+        template <class Func>
+        auto visit_object(std::size_t i, Func&& f);
+        /**
+         * @brief Call a function with a view of a particle or of a periodic image.
+         *
+         * The view of a particle of a worm is a sphere. The view of a periodic image is its particle at the shifted position.
+         * See visit_object.
+         *
+         * @tparam Func Type of the function, with signature \c R(const object<dim, false>&, shape_tag_t).
+         * @param i [in] Index of the particle.
+         * @param f [in] Function called with the view and its tag.
+         *
+         * @return Result of the function.
+         */
+        template <class Func>
+        auto visit_particle(std::size_t i, Func&& f);
 
       private:
 
@@ -260,35 +433,94 @@ namespace scopi
         /**
          * @brief Array of particles' forces.
          */
-        std::vector<force_type> m_forces; // f()
+        soa_array<dim> m_forces; // f()
         /**
          * @brief Array of particles' masses.
          */
-        std::vector<mass_type> m_masses; // m()
+        soa_array<1> m_masses; // m()
         /**
          * @brief Array of particles' moments of inertia.
          */
-        std::vector<moment_type> m_moments_inertia; // j()
+        soa_array<rotation_size> m_moments_inertia; // j()
         /**
          * @brief Array of particles' velocities.
          */
-        std::vector<velocity_type> m_velocities; // v()
+        soa_array<dim> m_velocities; // v()
         /**
          * @brief Array of particles' desired velocities.
          */
-        std::vector<velocity_type> m_desired_velocities; // vd()
+        soa_array<dim> m_desired_velocities; // vd()
         /**
          * @brief Array of particles' rotations.
          */
-        std::vector<rotation_type> m_omega; // omega()
+        soa_array<rotation_size> m_omega; // omega()
         /**
          * @brief Array of particles' desired rotations.
          */
-        std::vector<rotation_type> m_desired_omega; // desired_omega()
+        soa_array<rotation_size> m_desired_omega; // desired_omega()
         /**
-         * @brief Array of particles' hashes.
+         * @brief Array of objects' hashes.
          */
         std::vector<std::size_t> m_shapes_id;
+        /**
+         * @brief Array of particles' stable identifiers.
+         */
+        std::vector<std::size_t> m_particle_ids; // particle_id()
+        /**
+         * @brief Index of each particle ever added, indexed by its identifier.
+         */
+        std::vector<std::size_t> m_particle_indices; // particle_index()
+        /**
+         * @brief Index of the object of each particle, followed by the one of
+         * each periodic image.
+         */
+        std::vector<std::size_t> m_object_indices; // object_index()
+        /**
+         * @brief Data shared by the objects of a shape.
+         */
+        struct shape_data
+        {
+            /**
+             * @brief Tag of the objects.
+             */
+            shape_tag_t object_tag;
+            /**
+             * @brief Tag of the particles of the objects.
+             */
+            shape_tag_t particle_tag;
+            /**
+             * @brief Bounding radius of the particles.
+             */
+            double bounding_radius;
+            /**
+             * @brief View of an object, prototype of the views built on the stack.
+             */
+            std::unique_ptr<object<dim, false>> object_prototype;
+            /**
+             * @brief View of a particle, prototype of the views built on the stack.
+             */
+            std::unique_ptr<object<dim, false>> particle_prototype;
+        };
+        /**
+         * @brief Index in m_shape_data of each shape, indexed by its hash.
+         */
+        std::map<std::size_t, std::size_t> m_shape_index;
+        /**
+         * @brief Data of each shape.
+         */
+        std::vector<shape_data> m_shape_data;
+        /**
+         * @brief Array of particles' shapes, index in m_shape_data.
+         */
+        std::vector<std::size_t> m_particle_shapes;
+        /**
+         * @brief Array of particles' bounding radii.
+         */
+        std::vector<double> m_bounding_radius; // bounding_radius()
+        /**
+         * @brief Largest bounding radius of the active particles.
+         */
+        double m_max_bounding_radius{0.};
         /**
          * @brief Array of objetcts' offsets.
          *
@@ -299,16 +531,18 @@ namespace scopi
          */
         std::vector<std::size_t> m_offset;
         /**
-         * @brief Indices of particles that are duplicated for periodic boundary
-         * conditions.
+         * @brief Indices of the particles of the periodic images.
          */
         std::vector<std::size_t> m_periodic_indices;
+        /**
+         * @brief Shifts of the positions of the periodic images.
+         */
+        std::vector<position_type> m_periodic_shifts;
 
         /**
-         * @brief Index of the first duplicated particle.
+         * @brief Index of the first periodic image.
          */
         std::size_t m_periodic_ptr{0};
-        std::size_t m_periodic_obj_ptr{0};
 
         /**
          * @brief Number of obstacles (inactive particles).
@@ -358,6 +592,9 @@ namespace scopi
             m_forces.push_back(p.force());
             m_masses.push_back(p.mass());
             m_moments_inertia.push_back(p.moment_inertia());
+            m_particle_ids.push_back(m_particle_indices.size());
+            m_particle_indices.push_back(m_positions.size() - 1);
+            m_object_indices.push_back(m_shapes_id.size());
         }
 
         if (!p.is_active())
@@ -374,36 +611,42 @@ namespace scopi
         if (it == m_shape_map.end())
         {
             m_shape_map.insert(std::make_pair(s.hash(), std::move(s.construct())));
+            auto obj = (*m_shape_map[s.hash()])(&m_positions[m_offset[m_shapes_id.size()]], &m_quaternions[m_offset[m_shapes_id.size()]]);
+
+            shape_data data;
+            data.object_tag         = shape_tag(*obj);
+            data.bounding_radius    = bounding_radius_dispatcher<dim>::dispatch(*obj);
+            data.particle_prototype = select_object_dispatcher<dim>::dispatch(*obj, index(0));
+            data.particle_tag       = shape_tag(*data.particle_prototype);
+            data.object_prototype   = std::move(obj);
+
+            m_shape_index[s.hash()] = m_shape_data.size();
+            m_shape_data.push_back(std::move(data));
+        }
+
+        const std::size_t shape = m_shape_index[s.hash()];
+        m_particle_shapes.insert(m_particle_shapes.end(), s.size(), shape);
+
+        const double radius = m_shape_data[shape].bounding_radius;
+        m_bounding_radius.insert(m_bounding_radius.end(), s.size(), radius);
+        if (p.is_active())
+        {
+            m_max_bounding_radius = std::max(m_max_bounding_radius, radius);
         }
 
         m_shapes_id.push_back(s.hash());
         m_periodic_ptr += s.size();
-        m_periodic_obj_ptr++;
     }
 
     template <std::size_t dim>
-    void scopi_container<dim>::push_back(std::size_t io, const std::vector<position_type>& pos)
+    void scopi_container<dim>::add_periodic_image(std::size_t i, const position_type& shift)
     {
-        assert(io < m_periodic_obj_ptr);
+        assert(i < m_periodic_ptr);
         m_periodic_added = true;
 
-        std::size_t object_size = m_offset[io + 1] - m_offset[io];
-        m_offset.push_back(m_offset.back() + object_size);
-        for (std::size_t i = 0, ii = m_offset[io]; i < object_size; ++i, ++ii)
-        {
-            m_positions.push_back(pos[i]);
-            m_quaternions.push_back(m_quaternions[ii]);
-            m_velocities.push_back(m_velocities[ii]);
-            m_omega.push_back(m_omega[ii]);
-            m_desired_omega.push_back(m_desired_omega[ii]);
-            m_desired_velocities.push_back(m_desired_velocities[ii]);
-            m_forces.push_back(m_forces[ii]);
-            m_masses.push_back(m_masses[ii]);
-            m_moments_inertia.push_back(m_moments_inertia[ii]);
-            m_periodic_indices.push_back(ii);
-        }
-
-        m_shapes_id.push_back(m_shapes_id[io]);
+        m_periodic_indices.push_back(i);
+        m_periodic_shifts.push_back(shift);
+        m_object_indices.push_back(m_object_indices[i]);
     }
 
     template <std::size_t dim>
@@ -418,12 +661,238 @@ namespace scopi
         m_forces.reserve(size);
         m_masses.reserve(size);
         m_moments_inertia.reserve(size);
+        m_bounding_radius.reserve(size);
+        m_particle_shapes.reserve(size);
+        m_particle_ids.reserve(size);
+        m_particle_indices.reserve(size);
+        m_object_indices.reserve(size);
+    }
+
+    namespace detail
+    {
+        template <class T>
+        void permute(std::vector<T>& v, const std::vector<std::size_t>& new_to_old)
+        {
+            std::vector<T> out;
+            out.reserve(v.capacity());
+            for (std::size_t k : new_to_old)
+            {
+                out.push_back(std::move(v[k]));
+            }
+            v.swap(out);
+        }
+    }
+
+    template <std::size_t dim>
+    std::vector<std::size_t> scopi_container<dim>::reorder(space_filling_curve curve)
+    {
+        assert(!m_periodic_added);
+
+        const std::size_t npart = m_positions.size();
+        std::vector<std::size_t> perm(npart);
+        std::iota(perm.begin(), perm.end(), 0);
+
+        // the obstacles are the first objects
+        const std::size_t first_object = m_nb_inactive_core_objects < npart ? m_object_indices[m_nb_inactive_core_objects] : size();
+        if (first_object + 1 >= size())
+        {
+            return perm;
+        }
+
+        std::vector<std::array<double, dim>> centers(size() - first_object);
+        std::array<double, dim> lower;
+        std::array<double, dim> upper;
+        lower.fill(std::numeric_limits<double>::max());
+        upper.fill(std::numeric_limits<double>::lowest());
+        for (std::size_t io = first_object; io < size(); ++io)
+        {
+            auto& center = centers[io - first_object];
+            center.fill(0.);
+            for (std::size_t k = m_offset[io]; k < m_offset[io + 1]; ++k)
+            {
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    center[d] += m_positions[k](d);
+                }
+            }
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                center[d] /= static_cast<double>(m_offset[io + 1] - m_offset[io]);
+                lower[d] = std::min(lower[d], center[d]);
+                upper[d] = std::max(upper[d], center[d]);
+            }
+        }
+
+        const double ncells = static_cast<double>((std::uint64_t(1) << curve_bits<dim>) - 1);
+        std::vector<std::uint64_t> keys(centers.size());
+#pragma omp parallel for
+        for (std::size_t k = 0; k < centers.size(); ++k)
+        {
+            std::array<std::uint32_t, dim> cell;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double length = upper[d] - lower[d];
+                cell[d]             = length > 0. ? static_cast<std::uint32_t>((centers[k][d] - lower[d]) / length * ncells) : 0;
+            }
+            keys[k] = curve_key<dim>(curve, cell);
+        }
+
+        std::vector<std::size_t> objects(centers.size());
+        std::iota(objects.begin(), objects.end(), 0);
+        std::stable_sort(objects.begin(),
+                         objects.end(),
+                         [&](std::size_t a, std::size_t b)
+                         {
+                             return keys[a] < keys[b];
+                         });
+
+        std::vector<std::size_t> new_to_old(npart);
+        std::iota(new_to_old.begin(), new_to_old.begin() + static_cast<std::ptrdiff_t>(m_nb_inactive_core_objects), 0);
+        std::vector<std::size_t> offset(m_offset.cbegin(), m_offset.cbegin() + static_cast<std::ptrdiff_t>(first_object + 1));
+        std::vector<std::size_t> shapes_id(m_shapes_id.cbegin(), m_shapes_id.cbegin() + static_cast<std::ptrdiff_t>(first_object));
+        offset.reserve(m_offset.capacity());
+        shapes_id.reserve(m_shapes_id.capacity());
+        std::size_t p = m_nb_inactive_core_objects;
+        for (std::size_t k : objects)
+        {
+            const std::size_t io = first_object + k;
+            for (std::size_t i = m_offset[io]; i < m_offset[io + 1]; ++i)
+            {
+                new_to_old[p]       = i;
+                m_object_indices[p] = offset.size() - 1;
+                perm[i]             = p++;
+            }
+            offset.push_back(p);
+            shapes_id.push_back(m_shapes_id[io]);
+        }
+        m_offset.swap(offset);
+        m_shapes_id.swap(shapes_id);
+
+        detail::permute(m_positions, new_to_old);
+        detail::permute(m_quaternions, new_to_old);
+        detail::permute(m_particle_shapes, new_to_old);
+        detail::permute(m_bounding_radius, new_to_old);
+        detail::permute(m_particle_ids, new_to_old);
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_particle_indices[m_particle_ids[k]] = k;
+        }
+        m_velocities.permute(new_to_old);
+        m_desired_velocities.permute(new_to_old);
+        m_omega.permute(new_to_old);
+        m_desired_omega.permute(new_to_old);
+        m_forces.permute(new_to_old);
+        m_masses.permute(new_to_old);
+        m_moments_inertia.permute(new_to_old);
+
+        return perm;
     }
 
     template <std::size_t dim>
-    std::size_t scopi_container<dim>::size(bool with_periodic) const
+    void scopi_container<dim>::erase(std::size_t i)
     {
-        return (with_periodic) ? m_shapes_id.size() : m_periodic_obj_ptr;
+        assert(!m_periodic_added);
+        assert(i < size());
+
+        const std::size_t first   = m_offset[i];
+        const std::size_t last    = m_offset[i + 1];
+        const std::size_t removed = last - first;
+        const std::size_t npart   = m_positions.size();
+        const double radius       = m_bounding_radius[first];
+        if (first < m_nb_inactive_core_objects)
+        {
+            throw std::runtime_error("The obstacles cannot be erased.");
+        }
+
+        for (std::size_t k = first; k < last; ++k)
+        {
+            m_particle_indices[m_particle_ids[k]] = std::size_t(-1);
+        }
+
+        auto move_particle = [&](std::size_t from, std::size_t to)
+        {
+            m_positions[to]                        = m_positions[from];
+            m_quaternions[to]                      = m_quaternions[from];
+            m_velocities.view()(to)                = m_velocities.view()(from);
+            m_desired_velocities.view()(to)        = m_desired_velocities.view()(from);
+            m_omega.view()(to)                     = m_omega.view()(from);
+            m_desired_omega.view()(to)             = m_desired_omega.view()(from);
+            m_forces.view()(to)                    = m_forces.view()(from);
+            m_masses.view()(to)                    = m_masses.view()(from);
+            m_moments_inertia.view()(to)           = m_moments_inertia.view()(from);
+            m_particle_shapes[to]                  = m_particle_shapes[from];
+            m_bounding_radius[to]                  = m_bounding_radius[from];
+            m_particle_ids[to]                     = m_particle_ids[from];
+            m_particle_indices[m_particle_ids[to]] = to;
+        };
+
+        const std::size_t nobj = size();
+        if (m_offset[nobj] - m_offset[nobj - 1] == removed)
+        {
+            // the last object takes the place of the removed one
+            if (i + 1 < nobj)
+            {
+                for (std::size_t k = 0; k < removed; ++k)
+                {
+                    move_particle(m_offset[nobj - 1] + k, first + k);
+                    m_object_indices[first + k] = i;
+                }
+                m_shapes_id[i] = m_shapes_id.back();
+            }
+            m_offset.pop_back();
+            m_shapes_id.pop_back();
+        }
+        else
+        {
+            for (std::size_t k = last; k < npart; ++k)
+            {
+                move_particle(k, k - removed);
+                m_object_indices[k - removed] = m_object_indices[k] - 1;
+            }
+            m_offset.erase(m_offset.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            for (std::size_t io = i + 1; io < m_offset.size(); ++io)
+            {
+                m_offset[io] -= removed;
+            }
+            m_shapes_id.erase(m_shapes_id.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        const auto new_size = static_cast<std::ptrdiff_t>(npart - removed);
+        m_positions.erase(m_positions.begin() + new_size, m_positions.end());
+        m_quaternions.erase(m_quaternions.begin() + new_size, m_quaternions.end());
+        m_particle_shapes.erase(m_particle_shapes.begin() + new_size, m_particle_shapes.end());
+        m_bounding_radius.erase(m_bounding_radius.begin() + new_size, m_bounding_radius.end());
+        m_particle_ids.erase(m_particle_ids.begin() + new_size, m_particle_ids.end());
+        m_object_indices.erase(m_object_indices.begin() + new_size, m_object_indices.end());
+        m_velocities.resize(npart - removed);
+        m_desired_velocities.resize(npart - removed);
+        m_forces.resize(npart - removed);
+        m_omega.resize(npart - removed);
+        m_desired_omega.resize(npart - removed);
+        m_moments_inertia.resize(npart - removed);
+        m_masses.resize(npart - removed);
+        m_periodic_ptr -= removed;
+
+        if (radius == m_max_bounding_radius)
+        {
+            m_max_bounding_radius = 0.;
+            for (std::size_t k = m_nb_inactive_core_objects; k < m_bounding_radius.size(); ++k)
+            {
+                m_max_bounding_radius = std::max(m_max_bounding_radius, m_bounding_radius[k]);
+            }
+        }
+    }
+
+    template <std::size_t dim>
+    std::size_t scopi_container<dim>::size() const
+    {
+        return m_shapes_id.size();
+    }
+
+    template <std::size_t dim>
+    std::size_t scopi_container<dim>::nb_particles(bool with_periodic) const
+    {
+        return (with_periodic) ? m_periodic_ptr + m_periodic_indices.size() : m_periodic_ptr;
     }
 
     template <std::size_t dim>
@@ -471,13 +940,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::v() const
     {
-        return xt::adapt(reinterpret_cast<const velocity_type*>(m_velocities.data()), {m_velocities.size()});
+        return m_velocities.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::v()
     {
-        return xt::adapt(reinterpret_cast<velocity_type*>(m_velocities.data()), {m_velocities.size()});
+        return m_velocities.view();
     }
 
     // desired velocity
@@ -485,13 +954,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::vd() const
     {
-        return xt::adapt(reinterpret_cast<const velocity_type*>(m_desired_velocities.data()), {m_desired_velocities.size()});
+        return m_desired_velocities.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::vd()
     {
-        return xt::adapt(reinterpret_cast<velocity_type*>(m_desired_velocities.data()), {m_desired_velocities.size()});
+        return m_desired_velocities.view();
     }
 
     // omega
@@ -499,13 +968,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::omega() const
     {
-        return xt::adapt(reinterpret_cast<const rotation_type*>(m_omega.data()), {m_omega.size()});
+        return m_omega.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::omega()
     {
-        return xt::adapt(reinterpret_cast<rotation_type*>(m_omega.data()), {m_omega.size()});
+        return m_omega.view();
     }
 
     // desired velocity
@@ -513,13 +982,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::desired_omega() const
     {
-        return xt::adapt(reinterpret_cast<const rotation_type*>(m_desired_omega.data()), {m_desired_omega.size()});
+        return m_desired_omega.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::desired_omega()
     {
-        return xt::adapt(reinterpret_cast<rotation_type*>(m_desired_omega.data()), {m_desired_omega.size()});
+        return m_desired_omega.view();
     }
 
     // force
@@ -527,13 +996,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::f() const
     {
-        return xt::adapt(reinterpret_cast<const force_type*>(m_forces.data()), {m_forces.size()});
+        return m_forces.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::f()
     {
-        return xt::adapt(reinterpret_cast<force_type*>(m_forces.data()), {m_forces.size()});
+        return m_forces.view();
     }
 
     // mass
@@ -541,13 +1010,13 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::m() const
     {
-        return xt::adapt(reinterpret_cast<const mass_type*>(m_masses.data()), {m_masses.size()});
+        return m_masses.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::m()
     {
-        return xt::adapt(reinterpret_cast<mass_type*>(m_masses.data()), {m_masses.size()});
+        return m_masses.view();
     }
 
     // moment of inertia
@@ -555,32 +1024,21 @@ namespace scopi
     template <std::size_t dim>
     auto scopi_container<dim>::j() const
     {
-        return xt::adapt(reinterpret_cast<const moment_type*>(m_moments_inertia.data()), {m_moments_inertia.size()});
+        return m_moments_inertia.view();
     }
 
     template <std::size_t dim>
     auto scopi_container<dim>::j()
     {
-        return xt::adapt(reinterpret_cast<moment_type*>(m_moments_inertia.data()), {m_moments_inertia.size()});
+        return m_moments_inertia.view();
     }
 
     template <std::size_t dim>
     void scopi_container<dim>::reset_periodic()
     {
         m_periodic_indices.clear();
-        m_positions.resize(m_periodic_ptr);
-        m_quaternions.resize(m_periodic_ptr);
-        m_velocities.resize(m_periodic_ptr);
-        m_desired_velocities.resize(m_periodic_ptr);
-        m_omega.resize(m_periodic_ptr);
-        m_desired_omega.resize(m_periodic_ptr);
-        m_forces.resize(m_periodic_ptr);
-        m_masses.resize(m_periodic_ptr);
-        m_moments_inertia.resize(m_periodic_ptr);
-
-        m_offset.resize(m_periodic_obj_ptr + 1);
-        m_shapes_id.resize(m_periodic_obj_ptr);
-
+        m_periodic_shifts.clear();
+        m_object_indices.resize(m_periodic_ptr);
         m_periodic_added = false;
     }
 
@@ -596,11 +1054,110 @@ namespace scopi
         return m_periodic_indices[i];
     }
 
+    template <std::size_t dim>
+    auto scopi_container<dim>::periodic_shift(std::size_t i) const -> const position_type&
+    {
+        return m_periodic_shifts[i];
+    }
+
+    template <std::size_t dim>
+    auto scopi_container<dim>::position(std::size_t i) const -> position_type
+    {
+        if (i < m_periodic_ptr)
+        {
+            return m_positions[i];
+        }
+        position_type pos = m_positions[m_periodic_indices[i - m_periodic_ptr]];
+        pos += m_periodic_shifts[i - m_periodic_ptr];
+        return pos;
+    }
+
+    template <std::size_t dim>
+    double scopi_container<dim>::bounding_radius(std::size_t i) const
+    {
+        return (i < m_periodic_ptr) ? m_bounding_radius[i] : m_bounding_radius[m_periodic_indices[i - m_periodic_ptr]];
+    }
+
+    template <std::size_t dim>
+    double scopi_container<dim>::max_bounding_radius() const
+    {
+        return m_max_bounding_radius;
+    }
+
+    template <std::size_t dim>
+    bool scopi_container<dim>::is_sphere(std::size_t i) const
+    {
+        return particle_tag(i) == shape_tag_v<sphere<dim, false>>;
+    }
+
+    template <std::size_t dim>
+    shape_tag_t scopi_container<dim>::object_tag(std::size_t i) const
+    {
+        return m_shape_data[m_particle_shapes[m_offset[i]]].object_tag;
+    }
+
+    template <std::size_t dim>
+    shape_tag_t scopi_container<dim>::particle_tag(std::size_t i) const
+    {
+        const std::size_t k = (i < m_periodic_ptr) ? i : m_periodic_indices[i - m_periodic_ptr];
+        return m_shape_data[m_particle_shapes[k]].particle_tag;
+    }
+
+    template <std::size_t dim>
+    template <class Func>
+    auto scopi_container<dim>::visit_object(std::size_t i, Func&& f)
+    {
+        const auto& shape = m_shape_data[m_particle_shapes[m_offset[i]]];
+        if (shape.object_tag == unknown_shape_tag_v<dim>)
+        {
+            auto obj = (*this)[i];
+            return f(static_cast<const object<dim, false>&>(*obj), shape.object_tag);
+        }
+        return visit_view(shape.object_tag, *shape.object_prototype, &m_positions[m_offset[i]], &m_quaternions[m_offset[i]], f);
+    }
+
+    template <std::size_t dim>
+    template <class Func>
+    auto scopi_container<dim>::visit_particle(std::size_t i, Func&& f)
+    {
+        const bool is_image = i >= m_periodic_ptr;
+        const std::size_t k = is_image ? m_periodic_indices[i - m_periodic_ptr] : i;
+        const auto& shape   = m_shape_data[m_particle_shapes[k]];
+
+        position_type image_pos;
+        position_type* pos = &m_positions[k];
+        if (is_image)
+        {
+            image_pos = position(i);
+            pos       = &image_pos;
+        }
+
+        if (shape.particle_tag == unknown_shape_tag_v<dim>)
+        {
+            const std::size_t o = object_index(k);
+            auto obj            = select_object_dispatcher<dim>::dispatch(*(*this)[o], index(k - m_offset[o]));
+            obj->internal_pos() = pos;
+            return f(static_cast<const object<dim, false>&>(*obj), shape.particle_tag);
+        }
+        return visit_view(shape.particle_tag, *shape.particle_prototype, pos, &m_quaternions[k], f);
+    }
+
+    template <std::size_t dim>
+    std::size_t scopi_container<dim>::particle_id(std::size_t i) const
+    {
+        return m_particle_ids[i < m_periodic_ptr ? i : m_periodic_indices[i - m_periodic_ptr]];
+    }
+
+    template <std::size_t dim>
+    std::size_t scopi_container<dim>::particle_index(std::size_t id) const
+    {
+        return m_particle_indices[id];
+    }
+
     template <std::size_t dim>
     std::size_t scopi_container<dim>::object_index(std::size_t i) const
     {
-        auto lower = std::upper_bound(m_offset.cbegin(), m_offset.cend(), i);
-        return std::distance(m_offset.cbegin(), lower) - 1;
+        return m_object_indices[i];
     }
 
     template <std::size_t dim>
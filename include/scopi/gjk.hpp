@@ -0,0 +1,597 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+#include "newton.hpp"
+
+namespace scopi
+{
+    /**
+     * @brief Closest points between two convex shapes, found by gjk_distance.
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    struct gjk_result
+    {
+        /**
+         * @brief Point of the first shape which realizes the distance.
+         */
+        std::array<double, dim> pa{};
+        /**
+         * @brief Point of the second shape which realizes the distance.
+         */
+        std::array<double, dim> pb{};
+        /**
+         * @brief Outer normal of the second shape at \c pb.
+         */
+        std::array<double, dim> normal{};
+        /**
+         * @brief Signed distance between the two shapes, negative if they overlap.
+         */
+        double distance{0.};
+        /**
+         * @brief Whether the method converged.
+         */
+        bool converged{false};
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Point of the Minkowski difference \f$ A - B \f$ of two shapes, with the points of \f$ A \f$ and \f$ B \f$ it comes from.
+         */
+        template <std::size_t dim>
+        struct minkowski_point
+        {
+            std::array<double, dim> w;
+            std::array<double, dim> a;
+            std::array<double, dim> b;
+        };
+
+        /**
+         * @brief Simplex of GJK with the barycentric coordinates of its point closest to the origin.
+         */
+        template <std::size_t dim>
+        struct gjk_simplex
+        {
+            std::array<minkowski_point<dim>, dim + 1> p;
+            std::array<double, dim + 1> lambda;
+            std::size_t size{0};
+        };
+
+        template <std::size_t dim>
+        double gjk_dot(const std::array<double, dim>& u, const std::array<double, dim>& v)
+        {
+            double res = 0.;
+            for (std::size_t k = 0; k < dim; ++k)
+            {
+                res += u[k] * v[k];
+            }
+            return res;
+        }
+
+        inline std::array<double, 3> gjk_cross(const std::array<double, 3>& u, const std::array<double, 3>& v)
+        {
+            return {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        }
+
+        template <std::size_t dim>
+        std::array<double, dim> gjk_sub(const std::array<double, dim>& u, const std::array<double, dim>& v)
+        {
+            std::array<double, dim> res;
+            for (std::size_t k = 0; k < dim; ++k)
+            {
+                res[k] = u[k] - v[k];
+            }
+            return res;
+        }
+
+        /**
+         * @brief Support point of the Minkowski difference \f$ A - B \f$ in a direction.
+         *
+         * It is the support point of \f$ A \f$ in the direction minus the support point of \f$ B \f$ in the opposite direction.
+         */
+        template <std::size_t dim, class SA, class SB>
+        minkowski_point<dim> minkowski_support(SA& support_a, SB& support_b, const std::array<double, dim>& direction)
+        {
+            std::array<double, dim> opposite;
+            for (std::size_t k = 0; k < dim; ++k)
+            {
+                opposite[k] = -direction[k];
+            }
+            minkowski_point<dim> p;
+            p.a = support_a(direction);
+            p.b = support_b(opposite);
+            p.w = gjk_sub<dim>(p.a, p.b);
+            return p;
+        }
+
+        /**
+         * @brief Projection of the origin on the affine hull of \c K + 1 points of a simplex.
+         *
+         * The projection is kept in \c best if it is inside the face (all its barycentric coordinates are positive) and closer to the
+         * origin than the previous one.
+         */
+        template <std::size_t K, std::size_t dim>
+        void gjk_project_on_face(const gjk_simplex<dim>& s, unsigned mask, unsigned& best_mask, gjk_simplex<dim>& best, double& best_dist2)
+        {
+            std::array<std::size_t, K + 1> idx{};
+            for (std::size_t k = 0, n = 0; k < s.size; ++k)
+            {
+                if (mask & (1u << k))
+                {
+                    idx[n++] = k;
+                }
+            }
+
+            const auto& p0 = s.p[idx[0]].w;
+            std::array<std::array<double, dim>, K> e;
+            std::array<double, K * K> gram;
+            std::array<double, K> lambda;
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                e[i]      = gjk_sub<dim>(s.p[idx[i + 1]].w, p0);
+                lambda[i] = -gjk_dot<dim>(e[i], p0);
+            }
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                for (std::size_t j = 0; j < K; ++j)
+                {
+                    gram[K * i + j] = gjk_dot<dim>(e[i], e[j]);
+                }
+            }
+            if (!linear_solver<K>::solve(gram, lambda))
+            {
+                return;
+            }
+
+            double lambda0 = 1.;
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                if (!(lambda[i] > 0.))
+                {
+                    return;
+                }
+                lambda0 -= lambda[i];
+            }
+            if (!(lambda0 > 0.))
+            {
+                return;
+            }
+
+            std::array<double, dim> v = p0;
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                for (std::size_t k = 0; k < dim; ++k)
+                {
+                    v[k] += lambda[i] * e[i][k];
+                }
+            }
+            const double dist2 = gjk_dot<dim>(v, v);
+            if (dist2 < best_dist2)
+            {
+                best_dist2          = dist2;
+                best_mask           = mask;
+                best.lambda[idx[0]] = lambda0;
+                for (std::size_t i = 0; i < K; ++i)
+                {
+                    best.lambda[idx[i + 1]] = lambda[i];
+                }
+            }
+        }
+
+        template <std::size_t dim, std::size_t... K>
+        void gjk_project_on_faces(const gjk_simplex<dim>& s,
+                                  unsigned mask,
+                                  unsigned& best_mask,
+                                  gjk_simplex<dim>& best,
+                                  double& best_dist2,
+                                  std::index_sequence<K...>)
+        {
+            std::size_t count = 0;
+            for (std::size_t k = 0; k < s.size; ++k)
+            {
+                count += (mask >> k) & 1u;
+            }
+            ((count == K + 1 ? gjk_project_on_face<K>(s, mask, best_mask, best, best_dist2) : void()), ...);
+        }
+
+        /**
+         * @brief Reduce a simplex to its smallest face that contains its point closest to the origin.
+         *
+         * All the faces of the simplex are tried, which is cheap since the simplex has at most \c dim + 1 points. The closest point
+         * is in the relative interior of one face, which is the projection of the origin on the affine hull of this face.
+         *
+         * @return Point of the simplex closest to the origin.
+         */
+        template <std::size_t dim>
+        std::array<double, dim> gjk_reduce(gjk_simplex<dim>& s)
+        {
+            unsigned best_mask = 0;
+            double best_dist2  = std::numeric_limits<double>::max();
+            gjk_simplex<dim> best;
+            for (unsigned mask = 1; mask < (1u << s.size); ++mask)
+            {
+                gjk_project_on_faces(s, mask, best_mask, best, best_dist2, std::make_index_sequence<dim + 1>());
+            }
+
+            std::size_t n = 0;
+            std::array<double, dim> v{};
+            for (std::size_t k = 0; k < s.size; ++k)
+            {
+                if (best_mask & (1u << k))
+                {
+                    s.p[n]      = s.p[k];
+                    s.lambda[n] = best.lambda[k];
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        v[d] += s.lambda[n] * s.p[n].w[d];
+                    }
+                    ++n;
+                }
+            }
+            s.size = n;
+            return v;
+        }
+
+        /**
+         * @brief Complete a simplex that contains the origin up to \c dim + 1 points.
+         *
+         * The origin can be on a face of the simplex, for instance for symmetric shapes. The simplex is completed with the support
+         * points in the directions orthogonal to its faces, so that EPA starts from a full simplex.
+         *
+         * @return Whether the simplex could be completed.
+         */
+        template <std::size_t dim, class SA, class SB>
+        bool gjk_complete(SA& support_a, SB& support_b, gjk_simplex<dim>& s, double tol)
+        {
+            auto orthogonalize = [](std::array<double, dim>& e, const std::array<std::array<double, dim>, dim>& basis, std::size_t n)
+            {
+                for (std::size_t b = 0; b < n; ++b)
+                {
+                    const double proj = gjk_dot<dim>(e, basis[b]);
+                    for (std::size_t k = 0; k < dim; ++k)
+                    {
+                        e[k] -= proj * basis[b][k];
+                    }
+                }
+                return std::sqrt(gjk_dot<dim>(e, e));
+            };
+
+            while (s.size < dim + 1)
+            {
+                // orthonormal basis of the edges of the simplex
+                std::array<std::array<double, dim>, dim> basis;
+                std::size_t nbasis = 0;
+                for (std::size_t k = 1; k < s.size; ++k)
+                {
+                    auto e           = gjk_sub<dim>(s.p[k].w, s.p[0].w);
+                    const double len = orthogonalize(e, basis, nbasis);
+                    if (!(len > tol))
+                    {
+                        return false;
+                    }
+                    for (auto& ek : e)
+                    {
+                        ek /= len;
+                    }
+                    basis[nbasis++] = e;
+                }
+
+                // the axis farthest from the simplex gives the new direction
+                std::array<double, dim> n{};
+                double nmax = 0.;
+                for (std::size_t axis = 0; axis < dim; ++axis)
+                {
+                    std::array<double, dim> e{};
+                    e[axis]          = 1.;
+                    const double len = orthogonalize(e, basis, nbasis);
+                    if (len > nmax)
+                    {
+                        nmax = len;
+                        n    = e;
+                    }
+                }
+                for (auto& nk : n)
+                {
+                    nk /= nmax;
+                }
+
+                auto p = minkowski_support(support_a, support_b, n);
+                if (!(gjk_dot<dim>(n, gjk_sub<dim>(p.w, s.p[0].w)) > tol))
+                {
+                    for (auto& nk : n)
+                    {
+                        nk = -nk;
+                    }
+                    p = minkowski_support(support_a, support_b, n);
+                    if (!(gjk_dot<dim>(n, gjk_sub<dim>(p.w, s.p[0].w)) > tol))
+                    {
+                        return false;
+                    }
+                }
+                s.p[s.size++] = p;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Fill the result from the support points in the direction of the outer normal of the Minkowski difference.
+         *
+         * The support points of two smooth and strictly convex shapes in opposite directions are the closest points when the
+         * direction is the normal of the contact.
+         */
+        template <std::size_t dim>
+        gjk_result<dim> gjk_make_result(const minkowski_point<dim>& p, const std::array<double, dim>& n, double distance)
+        {
+            gjk_result<dim> result;
+            result.pa        = p.a;
+            result.pb        = p.b;
+            result.normal    = n;
+            result.distance  = distance;
+            result.converged = true;
+            return result;
+        }
+
+        /**
+         * @brief Penetration of two shapes in 2D with the expanding polytope algorithm (EPA).
+         *
+         * The polygon starts from the last simplex of GJK, a triangle that contains the origin, and is expanded in the direction of
+         * its edge closest to the origin until this edge is on the boundary of the Minkowski difference.
+         */
+        template <std::size_t itermax, class SA, class SB>
+        gjk_result<2> epa(SA& support_a, SB& support_b, const gjk_simplex<2>& s, double tol)
+        {
+            std::array<minkowski_point<2>, itermax + 3> polygon;
+            std::size_t size = 3;
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                polygon[k] = s.p[k];
+            }
+            // counterclockwise orientation
+            const auto e1 = gjk_sub<2>(polygon[1].w, polygon[0].w);
+            const auto e2 = gjk_sub<2>(polygon[2].w, polygon[0].w);
+            if (e1[0] * e2[1] - e1[1] * e2[0] < 0.)
+            {
+                std::swap(polygon[1], polygon[2]);
+            }
+
+            for (std::size_t iter = 0; iter < itermax; ++iter)
+            {
+                std::size_t edge = size;
+                double dmin      = std::numeric_limits<double>::max();
+                std::array<double, 2> n{};
+                for (std::size_t k = 0; k < size; ++k)
+                {
+                    const auto& a    = polygon[k].w;
+                    const auto e     = gjk_sub<2>(polygon[(k + 1) % size].w, a);
+                    const double len = std::sqrt(gjk_dot<2>(e, e));
+                    if (len > 0.)
+                    {
+                        const std::array<double, 2> nk = {e[1] / len, -e[0] / len};
+                        const double dk                = gjk_dot<2>(nk, a);
+                        if (dk < dmin)
+                        {
+                            dmin = dk;
+                            edge = k;
+                            n    = nk;
+                        }
+                    }
+                }
+                if (edge == size)
+                {
+                    break;
+                }
+
+                auto p             = minkowski_support(support_a, support_b, n);
+                const double depth = gjk_dot<2>(p.w, n);
+                if (depth - dmin <= tol)
+                {
+                    return gjk_make_result<2>(p, {-n[0], -n[1]}, -depth);
+                }
+                for (std::size_t k = size; k > edge + 1; --k)
+                {
+                    polygon[k] = polygon[k - 1];
+                }
+                polygon[edge + 1] = p;
+                ++size;
+            }
+            return {};
+        }
+
+        /**
+         * @brief Penetration of two shapes in 3D with the expanding polytope algorithm (EPA).
+         *
+         * The polytope starts from the last simplex of GJK, a tetrahedron that contains the origin. At each iteration, the support
+         * point in the direction of the normal of the face closest to the origin is added, the faces it sees are removed and the hole
+         * is closed with the new point.
+         */
+        template <std::size_t itermax, class SA, class SB>
+        gjk_result<3> epa(SA& support_a, SB& support_b, const gjk_simplex<3>& s, double tol)
+        {
+            struct face
+            {
+                std::array<std::size_t, 3> v;
+                std::array<double, 3> n;
+                double d;
+            };
+
+            constexpr std::size_t max_vertices = itermax + 4;
+            constexpr std::size_t max_faces    = 2 * max_vertices;
+            std::array<minkowski_point<3>, max_vertices> vertices;
+            std::array<face, max_faces> faces;
+            std::array<std::array<std::size_t, 2>, 3 * max_faces> edges;
+            std::size_t nvertices = 4;
+            std::size_t nfaces    = 0;
+
+            auto add_face = [&](std::size_t a, std::size_t b, std::size_t c)
+            {
+                auto n           = gjk_cross(gjk_sub<3>(vertices[b].w, vertices[a].w), gjk_sub<3>(vertices[c].w, vertices[a].w));
+                const double len = std::sqrt(gjk_dot<3>(n, n));
+                if (!(len > 0.) || nfaces == max_faces)
+                {
+                    return false;
+                }
+                for (auto& nk : n)
+                {
+                    nk /= len;
+                }
+                faces[nfaces++] = {{a, b, c}, n, gjk_dot<3>(n, vertices[a].w)};
+                return true;
+            };
+
+            for (std::size_t k = 0; k < 4; ++k)
+            {
+                vertices[k] = s.p[k];
+            }
+            // the normals point outward if the fourth vertex is below the first face
+            const auto n0 = gjk_cross(gjk_sub<3>(vertices[1].w, vertices[0].w), gjk_sub<3>(vertices[2].w, vertices[0].w));
+            if (gjk_dot<3>(n0, gjk_sub<3>(vertices[3].w, vertices[0].w)) > 0.)
+            {
+                std::swap(vertices[1], vertices[2]);
+            }
+            if (!add_face(0, 1, 2) || !add_face(0, 3, 1) || !add_face(0, 2, 3) || !add_face(1, 3, 2))
+            {
+                return {};
+            }
+
+            for (std::size_t iter = 0; iter < itermax; ++iter)
+            {
+                std::size_t closest = 0;
+                for (std::size_t f = 1; f < nfaces; ++f)
+                {
+                    if (faces[f].d < faces[closest].d)
+                    {
+                        closest = f;
+                    }
+                }
+                const auto n       = faces[closest].n;
+                auto p             = minkowski_support(support_a, support_b, n);
+                const double depth = gjk_dot<3>(p.w, n);
+                if (depth - faces[closest].d <= tol)
+                {
+                    return gjk_make_result<3>(p, {-n[0], -n[1], -n[2]}, -depth);
+                }
+
+                // remove the faces seen from the new point, the edges of the hole are the ones which appear once
+                const std::size_t ip  = nvertices;
+                vertices[nvertices++] = p;
+                std::size_t nedges    = 0;
+                for (std::size_t f = 0; f < nfaces;)
+                {
+                    if (gjk_dot<3>(faces[f].n, gjk_sub<3>(p.w, vertices[faces[f].v[0]].w)) > 0.)
+                    {
+                        for (std::size_t k = 0; k < 3; ++k)
+                        {
+                            const std::size_t a = faces[f].v[k];
+                            const std::size_t b = faces[f].v[(k + 1) % 3];
+                            bool shared         = false;
+                            for (std::size_t e = 0; e < nedges; ++e)
+                            {
+                                if (edges[e][0] == b && edges[e][1] == a)
+                                {
+                                    edges[e] = edges[--nedges];
+                                    shared   = true;
+                                    break;
+                                }
+                            }
+                            if (!shared)
+                            {
+                                edges[nedges++] = {a, b};
+                            }
+                        }
+                        faces[f] = faces[--nfaces];
+                    }
+                    else
+                    {
+                        ++f;
+                    }
+                }
+                for (std::size_t e = 0; e < nedges; ++e)
+                {
+                    if (!add_face(edges[e][0], edges[e][1], ip))
+                    {
+                        return {};
+                    }
+                }
+                if (nfaces == 0)
+                {
+                    return {};
+                }
+            }
+            return {};
+        }
+    }
+
+    /**
+     * @brief Signed distance between two convex shapes given by their support functions.
+     *
+     * The distance between two separated shapes is computed with the Gilbert-Johnson-Keerthi (GJK) algorithm: the point of the
+     * Minkowski difference \f$ A - B \f$ closest to the origin is approached by a sequence of simplices whose vertices are support
+     * points. If the origin is in the Minkowski difference, the shapes overlap and the penetration is computed with the expanding
+     * polytope algorithm (EPA). No memory is allocated.
+     *
+     * The closest points are the support points in the direction of the normal, so they are on the boundary of the shapes if the
+     * shapes are smooth and strictly convex.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam itermax Maximum number of iterations of GJK and of EPA.
+     * @tparam SA Type of the support function of the first shape, \c support_a(d) returns the point of the shape farthest in the
+     * direction \c d.
+     * @tparam SB Type of the support function of the second shape.
+     * @param support_a [in] Support function of the first shape.
+     * @param support_b [in] Support function of the second shape.
+     * @param direction [in] First search direction, for instance from the center of the first shape to the center of the second one.
+     * @param tol [in] Tolerance on the distance.
+     *
+     * @return Closest points, normal and signed distance.
+     */
+    template <std::size_t dim, std::size_t itermax = 128, class SA, class SB>
+    gjk_result<dim> gjk_distance(SA&& support_a, SB&& support_b, const std::array<double, dim>& direction, double tol)
+    {
+        detail::gjk_simplex<dim> s;
+        s.p[0]      = detail::minkowski_support(support_a, support_b, direction);
+        s.lambda[0] = 1.;
+        s.size      = 1;
+        auto v      = s.p[0].w;
+
+        for (std::size_t iter = 0; iter < itermax; ++iter)
+        {
+            const double v2 = detail::gjk_dot<dim>(v, v);
+            if (s.size == dim + 1 || v2 <= tol * tol)
+            {
+                // the origin is in the simplex, the shapes overlap or touch
+                if (!detail::gjk_complete(support_a, support_b, s, tol))
+                {
+                    return {};
+                }
+                return detail::epa<itermax>(support_a, support_b, s, tol);
+            }
+
+            const double vnorm = std::sqrt(v2);
+            std::array<double, dim> n;
+            std::array<double, dim> minus_v;
+            for (std::size_t k = 0; k < dim; ++k)
+            {
+                n[k]       = v[k] / vnorm;
+                minus_v[k] = -v[k];
+            }
+            auto p = detail::minkowski_support(support_a, support_b, minus_v);
+
+            // the distance is between v.w / |v| and |v|
+            if (v2 - detail::gjk_dot<dim>(v, p.w) <= tol * vnorm)
+            {
+                return detail::gjk_make_result<dim>(p, n, vnorm);
+            }
+
+            s.p[s.size++] = p;
+            v             = detail::gjk_reduce(s);
+        }
+        return {};
+    }
+}
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
 #include <xtensor-blas/xlinalg.hpp>
 #include <xtensor/xfixed.hpp>
 #include <xtensor/xnoalias.hpp>
@@ -50,103 +55,366 @@ namespace scopi
         }
     } // namespace detail
 
-    template <class Contacts_t, class Particles_t>
-    class AMatrix
+    /**
+     * @brief Jacobian of the relative velocities at the contacts, assembled once per time step.
+     *
+     * The rows \f$3c\f$ to \f$3c + 2\f$ of \f$\mathbb{A}\mathbf{u}\f$ are the relative velocity at the contact \c c,
+     * \f$\mathbf{v}_i - (\mathbf{p}_i - \mathbf{x}_i) \times R_i \boldsymbol{\omega}_i - \mathbf{v}_j + (\mathbf{p}_j - \mathbf{x}_j)
+     * \times R_j \boldsymbol{\omega}_j\f$. The blocks of the velocities are \f$\pm I\f$, so only the \f$3 \times 3\f$ blocks of the
+     * rotations, \f$\mp [\mathbf{p} - \mathbf{x}]_\times R\f$, are stored for each contact, with the index of the active particles.
+     * The products with \f$\mathbb{A}\f$ and \f$\mathbb{A}^T\f$ are loops over these blocks: the rotation matrices and the lever arms
+     * are not computed again at each iteration of the optimization solver.
+     *
+     * Both products are computed in parallel. \f$\mathbb{A}\mathbf{u}\f$ is a loop over the contacts, each one writes its rows.
+     * \f$\mathbb{A}^T\mathbf{f}\f$ is a loop over the active particles, each one gathers the rows of its contacts, listed in a
+     * compressed sparse row structure: there is no concurrent write and the sums are computed in the same order as in serial.
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    class contact_jacobian
     {
       public:
 
-        static constexpr std::size_t dim = Particles_t::dim;
+        /**
+         * @brief Constructor, assemble the blocks.
+         *
+         * @param contacts [in] Array of contacts.
+         * @param particles [in] Array of particles.
+         */
+        template <class Contacts_t, class Particles_t>
+        contact_jacobian(const Contacts_t& contacts, const Particles_t& particles);
+
+        /**
+         * @brief Compute \f$\mathbb{A}\mathbf{u}\f$.
+         *
+         * @param u [in] Velocities and rotations of the active particles, of size \f$6N_p\f$.
+         * @param out [out] Relative velocities, of size \f$3N_c\f$.
+         */
+        void mat_mult(const xt::xtensor<double, 1>& u, xt::xtensor<double, 1>& out) const;
+        /**
+         * @brief Compute \f$\mathbb{A}^T\mathbf{f}\f$.
+         *
+         * @param f [in] Vector of size \f$3N_c\f$.
+         * @param out [out] Vector of size \f$6N_p\f$.
+         */
+        void transpose_mult(const xt::xtensor<double, 1>& f, xt::xtensor<double, 1>& out) const;
+
+        /**
+         * @brief Compute the rows \f$3c\f$ to \f$3c + 2\f$ of \f$\mathbb{A}\mathbf{u}\f$, the relative velocity at the contact \c ic.
+         *
+         * @param ic [in] Index of the contact.
+         * @param u [in] Velocities and rotations of the active particles, of size \f$6N_p\f$.
+         */
+        std::array<double, 3> contact_mult(std::size_t ic, const xt::xtensor<double, 1>& u) const;
+        /**
+         * @brief Add \f$s \, \mathbb{W} \mathbb{A}_c^T \mathbf{f}\f$ to \c u, where \f$\mathbb{A}_c\f$ are the rows of the contact \c ic.
+         *
+         * Only the velocities and rotations of the particles \c i and \c j of the contact are modified.
+         *
+         * @param ic [in] Index of the contact.
+         * @param f [in] Force at the contact.
+         * @param weights [in] Diagonal of \f$\mathbb{W}\f$, of size \f$6N_p\f$.
+         * @param s [in] Scaling factor.
+         * @param u [in,out] Vector of size \f$6N_p\f$.
+         */
+        void contact_transpose_add(std::size_t ic,
+                                   const std::array<double, 3>& f,
+                                   const xt::xtensor<double, 1>& weights,
+                                   double s,
+                                   xt::xtensor<double, 1>& u) const;
+        /**
+         * @brief Compute the diagonal block \f$s \, \mathbb{A}_c \mathbb{W} \mathbb{A}_c^T\f$ of the contact \c ic, row-major.
+         *
+         * @param ic [in] Index of the contact.
+         * @param weights [in] Diagonal of \f$\mathbb{W}\f$, of size \f$6N_p\f$.
+         * @param s [in] Scaling factor.
+         */
+        std::array<double, 9> diagonal_block(std::size_t ic, const xt::xtensor<double, 1>& weights, double s) const;
+
+        /**
+         * @brief Indices of the active particles \c i and \c j of the contact \c ic, no_body for an obstacle.
+         */
+        const std::array<std::size_t, 2>& bodies(std::size_t ic) const;
+        /**
+         * @brief Number of contacts \f$N_c\f$.
+         */
+        std::size_t nb_contacts() const;
+        /**
+         * @brief Number of active particles \f$N_p\f$.
+         */
+        std::size_t nb_active() const;
+
+        /**
+         * @brief Index of a particle that is not active.
+         */
+        static constexpr std::size_t no_body = std::size_t(-1);
 
-        AMatrix(const Contacts_t& contacts, const Particles_t& particles)
-            : m_contacts{contacts}
-            , m_particles{particles}
-            , m_work{xt::zeros<double>({3 * contacts.size()})}
-        {
-        }
+      private:
 
-        const auto& mat_mult(const xt::xtensor<double, 1>& u) const
+        /**
+         * @brief Indices of the active particles \c i and \c j of each contact, no_body for an obstacle.
+         */
+        std::vector<std::array<std::size_t, 2>> m_bodies;
+        /**
+         * @brief Blocks of the rotations of \c i and \c j of each contact, row-major.
+         */
+        std::vector<std::array<double, 18>> m_blocks;
+        /**
+         * @brief Number of active particles.
+         */
+        std::size_t m_nb_active;
+        /**
+         * @brief The contacts of the active particle \c b are m_body_contacts[m_body_start[b]] to m_body_contacts[m_body_start[b + 1] - 1].
+         */
+        std::vector<std::size_t> m_body_start;
+        /**
+         * @brief Contacts of the active particles, <tt>2 * c + side</tt> with \c side 0 if the particle is \c i of the contact \c c, 1
+         * if it is \c j.
+         */
+        std::vector<std::size_t> m_body_contacts;
+    };
+
+    template <std::size_t dim>
+    template <class Contacts_t, class Particles_t>
+    contact_jacobian<dim>::contact_jacobian(const Contacts_t& contacts, const Particles_t& particles)
+        : m_bodies(contacts.size())
+        , m_blocks(contacts.size())
+        , m_nb_active(particles.nb_active())
+        , m_body_start(particles.nb_active() + 1, 0)
+    {
+        const std::size_t active_offset = particles.nb_inactive();
+        auto pos                        = particles.pos();
+        auto q                          = particles.q();
+#pragma omp parallel for
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
         {
-            m_work.fill(0.);
-            std::size_t active_offset = m_particles.nb_inactive();
-            std::size_t rot_offset    = 3 * m_particles.nb_active();
-            std::size_t row           = 0;
-
-            // for (auto& c : m_contacts)
-            // {
-            //     auto view = xt::view(m_work, xt::range(row, row + 3));
-            //     if (c.i >= active_offset)
-            //     {
-            //         std::size_t start = (c.i - active_offset) * 3;
-            //         auto v_i          = xt::view(u, xt::range(start, start + 3));
-
-            //         start += rot_offset;
-            //         auto omega_i = xt::view(u, xt::range(start, start + 3));
-            //         auto rij_i   = c.pi - m_particles.pos()(c.i);
-            //         auto Ri      = rotation_matrix<3>(m_particles.q()(c.i));
-
-            //         view += v_i - detail::cross<dim>(rij_i, detail::mat_mult(Ri, omega_i));
-            //     }
-            //     if (c.j >= active_offset)
-            //     {
-            //         std::size_t start = (c.j - active_offset) * 3;
-            //         auto v_j          = xt::view(u, xt::range(start, start + 3));
-
-            //         start += rot_offset;
-            //         auto omega_j = xt::view(u, xt::range(start, start + 3));
-            //         auto rij_j   = c.pj - m_particles.pos()(c.j);
-            //         auto Rj      = rotation_matrix<3>(m_particles.q()(c.j));
-
-            //         view -= v_j - detail::cross<dim>(rij_j, detail::mat_mult(Rj, omega_j));
-            //     }
-            //     row += 3;
-            // }
-
-            auto pos = m_particles.pos();
-            auto q   = m_particles.q();
-            for (auto& c : m_contacts)
+            const auto& c = contacts[ic];
+            for (std::size_t side = 0; side < 2; ++side)
             {
-                auto view = xt::view(m_work, xt::range(row, row + 3));
-                if (c.i >= active_offset)
+                const std::size_t k = side == 0 ? c.i : c.j;
+                if (k < active_offset)
                 {
-                    std::size_t start                            = (c.i - active_offset) * 3;
-                    xt::xtensor_fixed<double, xt::xshape<3>> v_i = xt::view(u, xt::range(start, start + 3));
+                    m_bodies[ic][side] = no_body;
+                    continue;
+                }
+                m_bodies[ic][side] = k - active_offset;
 
-                    start += rot_offset;
-                    xt::xtensor_fixed<double, xt::xshape<3>> omega_i = xt::view(u, xt::range(start, start + 3));
-                    xt::xtensor_fixed<double, xt::xshape<3>> rij_i   = c.pi - pos(c.i);
-                    auto Ri                                          = rotation_matrix<3>(q(c.i));
+                // lever arm, the third component is 0 in 2D
+                const auto& p = side == 0 ? c.pi : c.pj;
+                std::array<double, 3> r{0., 0., 0.};
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    r[d] = p(d) - pos(k)(d);
+                }
+                const auto R      = rotation_matrix<3>(q(k));
+                const double sign = side == 0 ? -1. : 1.;
+                double* W         = m_blocks[ic].data() + 9 * side;
+                for (std::size_t b = 0; b < 3; ++b)
+                {
+                    W[b]     = sign * (r[1] * R(2, b) - r[2] * R(1, b));
+                    W[3 + b] = sign * (r[2] * R(0, b) - r[0] * R(2, b));
+                    W[6 + b] = sign * (r[0] * R(1, b) - r[1] * R(0, b));
+                }
+            }
+        }
 
-                    auto cross = detail::cross<dim>(rij_i, detail::mat_mult(Ri, omega_i));
-                    for (std::size_t d = 0; d < 3; ++d)
-                    {
-                        view(d) += v_i(d) - cross(d);
-                    }
+        for (const auto& bodies : m_bodies)
+        {
+            for (std::size_t body : bodies)
+            {
+                if (body != no_body)
+                {
+                    m_body_start[body + 1]++;
                 }
-                if (c.j >= active_offset)
+            }
+        }
+        for (std::size_t b = 0; b < m_nb_active; ++b)
+        {
+            m_body_start[b + 1] += m_body_start[b];
+        }
+        m_body_contacts.resize(m_body_start[m_nb_active]);
+        std::vector<std::size_t> next(m_body_start.cbegin(), m_body_start.cend() - 1);
+        for (std::size_t ic = 0; ic < m_bodies.size(); ++ic)
+        {
+            for (std::size_t side = 0; side < 2; ++side)
+            {
+                if (m_bodies[ic][side] != no_body)
                 {
-                    std::size_t start                            = (c.j - active_offset) * 3;
-                    xt::xtensor_fixed<double, xt::xshape<3>> v_j = xt::view(u, xt::range(start, start + 3));
+                    m_body_contacts[next[m_bodies[ic][side]]++] = 2 * ic + side;
+                }
+            }
+        }
+    }
 
-                    start += rot_offset;
-                    xt::xtensor_fixed<double, xt::xshape<3>> omega_j = xt::view(u, xt::range(start, start + 3));
-                    xt::xtensor_fixed<double, xt::xshape<3>> rij_j   = c.pj - pos(c.j);
-                    auto Rj                                          = rotation_matrix<3>(q(c.j));
+    template <std::size_t dim>
+    void contact_jacobian<dim>::mat_mult(const xt::xtensor<double, 1>& u, xt::xtensor<double, 1>& out) const
+    {
+#pragma omp parallel for
+        for (std::size_t ic = 0; ic < m_bodies.size(); ++ic)
+        {
+            const auto row = contact_mult(ic, u);
+            for (std::size_t a = 0; a < 3; ++a)
+            {
+                out[3 * ic + a] = row[a];
+            }
+        }
+    }
 
-                    auto cross = detail::cross<dim>(rij_j, detail::mat_mult(Rj, omega_j));
-                    for (std::size_t d = 0; d < 3; ++d)
+    template <std::size_t dim>
+    inline std::array<double, 3> contact_jacobian<dim>::contact_mult(std::size_t ic, const xt::xtensor<double, 1>& u) const
+    {
+        const double* v     = u.data();
+        const double* omega = u.data() + 3 * m_nb_active;
+        std::array<double, 3> row{0., 0., 0.};
+        for (std::size_t side = 0; side < 2; ++side)
+        {
+            const std::size_t body = m_bodies[ic][side];
+            if (body == no_body)
+            {
+                continue;
+            }
+            const double sign = side == 0 ? 1. : -1.;
+            const double* W   = m_blocks[ic].data() + 9 * side;
+            const double* v_b = v + 3 * body;
+            const double* o_b = omega + 3 * body;
+            for (std::size_t a = 0; a < 3; ++a)
+            {
+                row[a] += sign * v_b[a] + W[3 * a] * o_b[0] + W[3 * a + 1] * o_b[1] + W[3 * a + 2] * o_b[2];
+            }
+        }
+        return row;
+    }
+
+    template <std::size_t dim>
+    inline void contact_jacobian<dim>::contact_transpose_add(std::size_t ic,
+                                                             const std::array<double, 3>& f,
+                                                             const xt::xtensor<double, 1>& weights,
+                                                             double s,
+                                                             xt::xtensor<double, 1>& u) const
+    {
+        const std::size_t offset = 3 * m_nb_active;
+        for (std::size_t side = 0; side < 2; ++side)
+        {
+            const std::size_t body = m_bodies[ic][side];
+            if (body == no_body)
+            {
+                continue;
+            }
+            const double sign = side == 0 ? 1. : -1.;
+            const double* W   = m_blocks[ic].data() + 9 * side;
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                u[3 * body + d] += s * weights[3 * body + d] * sign * f[d];
+                u[offset + 3 * body + d] += s * weights[offset + 3 * body + d] * (W[d] * f[0] + W[3 + d] * f[1] + W[6 + d] * f[2]);
+            }
+        }
+    }
+
+    template <std::size_t dim>
+    std::array<double, 9> contact_jacobian<dim>::diagonal_block(std::size_t ic, const xt::xtensor<double, 1>& weights, double s) const
+    {
+        const std::size_t offset = 3 * m_nb_active;
+        std::array<double, 9> out{};
+        for (std::size_t side = 0; side < 2; ++side)
+        {
+            const std::size_t body = m_bodies[ic][side];
+            if (body == no_body)
+            {
+                continue;
+            }
+            const double* W = m_blocks[ic].data() + 9 * side;
+            for (std::size_t a = 0; a < 3; ++a)
+            {
+                out[4 * a] += s * weights[3 * body + a];
+                for (std::size_t b = 0; b < 3; ++b)
+                {
+                    for (std::size_t e = 0; e < 3; ++e)
                     {
-                        view(d) -= v_j(d) - cross(d);
+                        out[3 * a + b] += s * W[3 * a + e] * weights[offset + 3 * body + e] * W[3 * b + e];
                     }
                 }
-                row += 3;
             }
+        }
+        return out;
+    }
+
+    template <std::size_t dim>
+    void contact_jacobian<dim>::transpose_mult(const xt::xtensor<double, 1>& f, xt::xtensor<double, 1>& out) const
+    {
+        double* v     = out.data();
+        double* omega = out.data() + 3 * m_nb_active;
+#pragma omp parallel for
+        for (std::size_t b = 0; b < m_nb_active; ++b)
+        {
+            std::array<double, 3> v_b{0., 0., 0.};
+            std::array<double, 3> o_b{0., 0., 0.};
+            for (std::size_t k = m_body_start[b]; k < m_body_start[b + 1]; ++k)
+            {
+                const std::size_t ic   = m_body_contacts[k] / 2;
+                const std::size_t side = m_body_contacts[k] % 2;
+                const double sign      = side == 0 ? 1. : -1.;
+                const double* W        = m_blocks[ic].data() + 9 * side;
+                const double* f_c      = f.data() + 3 * ic;
+                for (std::size_t d = 0; d < 3; ++d)
+                {
+                    v_b[d] += sign * f_c[d];
+                    o_b[d] += W[d] * f_c[0] + W[3 + d] * f_c[1] + W[6 + d] * f_c[2];
+                }
+            }
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                v[3 * b + d]     = v_b[d];
+                omega[3 * b + d] = o_b[d];
+            }
+        }
+    }
+
+    template <std::size_t dim>
+    inline const std::array<std::size_t, 2>& contact_jacobian<dim>::bodies(std::size_t ic) const
+    {
+        return m_bodies[ic];
+    }
+
+    template <std::size_t dim>
+    inline std::size_t contact_jacobian<dim>::nb_contacts() const
+    {
+        return m_bodies.size();
+    }
+
+    template <std::size_t dim>
+    inline std::size_t contact_jacobian<dim>::nb_active() const
+    {
+        return m_nb_active;
+    }
+
+    template <class Contacts_t, class Particles_t>
+    class AMatrix
+    {
+      public:
+
+        static constexpr std::size_t dim = Particles_t::dim;
+
+        AMatrix(const Contacts_t& contacts, const Particles_t& particles)
+            : m_jacobian{std::make_shared<const contact_jacobian<dim>>(contacts, particles)}
+            , m_work{xt::zeros<double>({3 * contacts.size()})}
+        {
+        }
+
+        const auto& mat_mult(const xt::xtensor<double, 1>& u) const
+        {
+            m_jacobian->mat_mult(u, m_work);
             return m_work;
         }
 
+        const auto& jacobian() const
+        {
+            return m_jacobian;
+        }
+
       private:
 
-        const Contacts_t& m_contacts;
-        const Particles_t& m_particles;
+        std::shared_ptr<const contact_jacobian<dim>> m_jacobian;
         mutable xt::xtensor<double, 1> m_work;
     };
 
@@ -158,105 +426,27 @@ namespace scopi
         static constexpr std::size_t dim = Particles_t::dim;
 
         ATMatrix(const Contacts_t& contacts, const Particles_t& particles)
-            : m_contacts{contacts}
-            , m_particles{particles}
+            : m_jacobian{std::make_shared<const contact_jacobian<dim>>(contacts, particles)}
             , m_work{xt::zeros<double>({6 * particles.nb_active()})}
         {
         }
 
-        const auto& mat_mult(const xt::xtensor<double, 1>& f) const
+        // share the blocks assembled for A
+        explicit ATMatrix(const AMatrix<Contacts_t, Particles_t>& A)
+            : m_jacobian{A.jacobian()}
+            , m_work{xt::zeros<double>({6 * m_jacobian->nb_active()})}
         {
-            m_work.fill(0.);
-            std::size_t active_offset = m_particles.nb_inactive();
-            std::size_t rot_offset    = 3 * m_particles.nb_active();
-            std::size_t row           = 0;
-
-            // for (auto& c : m_contacts)
-            // {
-            //     auto f_view = xt::view(f, xt::range(row, row + 3));
-
-            //     if (c.i >= active_offset)
-            //     {
-            //         std::size_t start = (c.i - active_offset) * 3;
-            //         auto v_i          = xt::view(m_work, xt::range(start, start + 3));
-
-            //         v_i += f_view;
-
-            //         start += rot_offset;
-            //         auto omega_i = xt::view(m_work, xt::range(start, start + 3));
-            //         auto rij_i   = c.pi - m_particles.pos()(c.i);
-            //         auto R_i     = rotation_matrix<3>(m_particles.q()(c.i));
-
-            //         omega_i += detail::mat_mult(xt::transpose(R_i), detail::cross<dim>(rij_i, f_view));
-            //     }
-            //     if (c.j >= active_offset)
-            //     {
-            //         std::size_t start = (c.j - active_offset) * 3;
-            //         auto v_j          = xt::view(m_work, xt::range(start, start + 3));
-
-            //         v_j -= f_view;
-
-            //         start += rot_offset;
-            //         auto omega_j = xt::view(m_work, xt::range(start, start + 3));
-            //         auto rij_j   = c.pj - m_particles.pos()(c.j);
-            //         auto R_j     = rotation_matrix<3>(m_particles.q()(c.j));
-
-            //         omega_j -= detail::mat_mult(xt::transpose(R_j), detail::cross<dim>(rij_j, f_view));
-            //     }
-            //     row += 3;
-            // }
-
-            auto pos = m_particles.pos();
-            auto q   = m_particles.q();
-            for (auto& c : m_contacts)
-            {
-                auto f_view = xt::view(f, xt::range(row, row + 3));
-
-                if (c.i >= active_offset)
-                {
-                    std::size_t start = (c.i - active_offset) * 3;
-                    auto v_i          = xt::view(m_work, xt::range(start, start + 3));
-
-                    start += rot_offset;
-                    auto omega_i                                   = xt::view(m_work, xt::range(start, start + 3));
-                    xt::xtensor_fixed<double, xt::xshape<3>> rij_i = c.pi - pos(c.i);
-                    auto R_i                                       = rotation_matrix<3>(q(c.i));
-
-                    xt::xtensor_fixed<double, xt::xshape<3>> result = detail::mat_mult(xt::transpose(R_i), detail::cross<dim>(rij_i, f_view));
-                    for (std::size_t d = 0; d < 3; ++d)
-                    {
-                        v_i(d) += f_view(d);
-                        omega_i(d) += result(d);
-                    }
-                    // omega_i += result;
-                }
-                if (c.j >= active_offset)
-                {
-                    std::size_t start = (c.j - active_offset) * 3;
-                    auto v_j          = xt::view(m_work, xt::range(start, start + 3));
-
-                    start += rot_offset;
-                    auto omega_j                                   = xt::view(m_work, xt::range(start, start + 3));
-                    xt::xtensor_fixed<double, xt::xshape<3>> rij_j = c.pj - pos(c.j);
-                    auto R_j                                       = rotation_matrix<3>(q(c.j));
+        }
 
-                    xt::xtensor_fixed<double, xt::xshape<3>> result = detail::mat_mult(xt::transpose(R_j), detail::cross<dim>(rij_j, f_view));
-                    for (std::size_t d = 0; d < 3; ++d)
-                    {
-                        v_j(d) -= f_view(d);
-                        omega_j(d) -= result(d);
-                    }
-                    // omega_j -= result;
-                }
-                row += 3;
-            }
+        const auto& mat_mult(const xt::xtensor<double, 1>& f) const
+        {
+            m_jacobian->transpose_mult(f, m_work);
             return m_work;
         }
 
       private:
 
-        const Contacts_t& m_contacts;
-        const Particles_t& m_particles;
+        std::shared_ptr<const contact_jacobian<dim>> m_jacobian;
         mutable xt::xtensor<double, 1> m_work;
     };
 
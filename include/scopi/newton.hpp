@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace scopi
+{
+    namespace detail
+    {
+        /**
+         * @brief Solver of a dense linear system of fixed size.
+         *
+         * LU factorization with partial pivoting. The bounds of the loops are known at compile time, so the compiler unrolls them for
+         * the small systems of closest_points (4 x 4 in 3D).
+         *
+         * @tparam N Size of the system.
+         */
+        template <std::size_t N>
+        struct linear_solver
+        {
+            /**
+             * @brief Solve \f$ A x = b \f$ in place.
+             *
+             * @param a [inout] Matrix \f$ A \f$, row major, overwritten by its factorization.
+             * @param b [inout] Right-hand side, overwritten by the solution.
+             *
+             * @return Whether the matrix is invertible.
+             */
+            static bool solve(std::array<double, N * N>& a, std::array<double, N>& b)
+            {
+                for (std::size_t k = 0; k < N; ++k)
+                {
+                    std::size_t pivot = k;
+                    for (std::size_t i = k + 1; i < N; ++i)
+                    {
+                        if (std::abs(a[N * i + k]) > std::abs(a[N * pivot + k]))
+                        {
+                            pivot = i;
+                        }
+                    }
+                    if (a[N * pivot + k] == 0.)
+                    {
+                        return false;
+                    }
+                    if (pivot != k)
+                    {
+                        for (std::size_t j = 0; j < N; ++j)
+                        {
+                            std::swap(a[N * k + j], a[N * pivot + j]);
+                        }
+                        std::swap(b[k], b[pivot]);
+                    }
+                    for (std::size_t i = k + 1; i < N; ++i)
+                    {
+                        const double l = a[N * i + k] / a[N * k + k];
+                        for (std::size_t j = k + 1; j < N; ++j)
+                        {
+                            a[N * i + j] -= l * a[N * k + j];
+                        }
+                        b[i] -= l * b[k];
+                    }
+                }
+                for (std::size_t k = N; k-- > 0;)
+                {
+                    double sum = b[k];
+                    for (std::size_t j = k + 1; j < N; ++j)
+                    {
+                        sum -= a[N * k + j] * b[j];
+                    }
+                    b[k] = sum / a[N * k + k];
+                }
+                return true;
+            }
+        };
+
+        /**
+         * @brief Solver of a linear system of size 2, with Cramer's rule.
+         */
+        template <>
+        struct linear_solver<2>
+        {
+            /**
+             * @brief Solve \f$ A x = b \f$ in place.
+             *
+             * @param a [in] Matrix \f$ A \f$, row major.
+             * @param b [inout] Right-hand side, overwritten by the solution.
+             *
+             * @return Whether the matrix is invertible.
+             */
+            static bool solve(std::array<double, 4>& a, std::array<double, 2>& b)
+            {
+                const double det = a[0] * a[3] - a[1] * a[2];
+                if (det == 0.)
+                {
+                    return false;
+                }
+                const double x0 = (b[0] * a[3] - a[1] * b[1]) / det;
+                const double x1 = (a[0] * b[1] - a[2] * b[0]) / det;
+                b[0]            = x0;
+                b[1]            = x1;
+                return true;
+            }
+        };
+
+        template <std::size_t N, class V>
+        double fixed_norm(const V& v)
+        {
+            double norm2 = 0.;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                norm2 += v[i] * v[i];
+            }
+            return std::sqrt(norm2);
+        }
+    }
+
+    /**
+     * @brief Newton method with line search for a system of fixed size.
+     *
+     * The unknowns, the step and the Jacobian matrix are stored in \c std::array and the linear systems are solved by
+     * detail::linear_solver, so an iteration does not allocate memory. The step is halved until the residual decreases, at most
+     * 10 times, so an iteration evaluates the residual at most 11 times.
+     *
+     * @tparam N Number of unknowns.
+     * @tparam F Type of the function, \c f(u, args) returns a vector of size \c N indexable with [].
+     * @tparam DF Type of the Jacobian, \c grad_f(u, args) returns a matrix of size \c N x \c N indexable with (i, j).
+     * @tparam A Type of the parameters of the function.
+     * @param u0 [in] Starting point.
+     * @param f [in] Function.
+     * @param grad_f [in] Jacobian of the function.
+     * @param args [in] Parameters of the function.
+     * @param itermax [in] Maximum number of iterations.
+     * @param ftol [in] Tolerance on the norm of the residual.
+     * @param xtol [in] Tolerance on the norm of the step.
+     *
+     * @return Solution and number of iterations, -1 if the method did not converge.
+     */
+    template <std::size_t N, class F, class DF, class A>
+    std::pair<std::array<double, N>, int>
+    newton_method(const std::array<double, N>& u0, F&& f, DF&& grad_f, const A& args, int itermax, double ftol, double xtol)
+    {
+        std::array<double, N> u = u0;
+        std::array<double, N> v;
+        std::array<double, N> d;
+        std::array<double, N * N> jacobian;
+
+        for (int iter = 0; iter < itermax; ++iter)
+        {
+            const auto fu  = f(u, args);
+            const auto dfu = grad_f(u, args);
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                d[i] = -fu[i];
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    jacobian[N * i + j] = dfu(i, j);
+                }
+            }
+            if (!detail::linear_solver<N>::solve(jacobian, d))
+            {
+                break;
+            }
+            if (detail::fixed_norm<N>(d) < xtol)
+            {
+                return {u, iter};
+            }
+            const double ferr = detail::fixed_norm<N>(fu);
+            if (ferr < ftol)
+            {
+                return {u, iter};
+            }
+
+            // backtracking line search
+            constexpr int max_halvings = 10;
+            double t                   = 1.;
+            for (int k = 0; k < max_halvings; ++k, t *= 0.5)
+            {
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    v[i] = u[i] + t * d[i];
+                }
+                if (detail::fixed_norm<N>(f(v, args)) <= ferr)
+                {
+                    break;
+                }
+            }
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                u[i] += t * d[i];
+            }
+        }
+        return {u, -1};
+    }
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 #include <xtl/xmultimethods.hpp>
 
 namespace scopi
@@ -14,6 +18,71 @@ namespace scopi
     {
     };
 
+    namespace detail
+    {
+        /**
+         * @brief Number of types in a list.
+         */
+        template <class L>
+        struct type_list_size;
+
+        template <class... T>
+        struct type_list_size<mpl::vector<T...>> : std::integral_constant<std::size_t, sizeof...(T)>
+        {
+        };
+
+        /**
+         * @brief Position of a type in a list, regardless of const, or size of the list if the type is not in the list.
+         */
+        template <class T, class L>
+        struct type_position;
+
+        template <class T>
+        struct type_position<T, mpl::vector<>> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <class T, class U, class... V>
+        struct type_position<T, mpl::vector<U, V...>>
+            : std::integral_constant<std::size_t,
+                                     std::is_same<std::remove_cv_t<T>, std::remove_cv_t<U>>::value
+                                         ? 0
+                                         : 1 + type_position<T, mpl::vector<V...>>::value>
+        {
+        };
+
+        /**
+         * @brief Whether a type is in a list, regardless of const.
+         */
+        template <class T, class L>
+        struct type_in_list : std::integral_constant<bool, (type_position<T, L>::value < type_list_size<L>::value)>
+        {
+        };
+
+        /**
+         * @brief Type at a given position in a list.
+         */
+        template <std::size_t I, class L>
+        struct type_at;
+
+        template <class T, class... U>
+        struct type_at<0, mpl::vector<T, U...>>
+        {
+            using type = T;
+        };
+
+        template <std::size_t I, class T, class... U>
+        struct type_at<I, mpl::vector<T, U...>> : type_at<I - 1, mpl::vector<U...>>
+        {
+        };
+
+        /**
+         * @brief Type \c T with the same const qualification as \c B.
+         */
+        template <class B, class T>
+        using same_const_t = std::conditional_t<std::is_const<B>::value, const std::remove_cv_t<T>, std::remove_cv_t<T>>;
+    }
+
     /*********************
      * static_dispatcher *
      *********************/
@@ -47,6 +116,31 @@ namespace scopi
             return dispatch_lhs(lhs, mpl::vector<U...>(), std::forward<Args>(args)...);
         }
 
+        template <class G, class... Args>
+        static return_type dispatch_type(base_lhs& lhs, Args&&... args)
+        {
+            if constexpr (detail::type_in_list<G, lhs_type_list>::value)
+            {
+                return invoke_executor(static_cast<detail::same_const_t<base_lhs, G>&>(lhs), std::forward<Args>(args)...);
+            }
+            else
+            {
+                return dispatch_lhs(lhs, mpl::vector<>(), std::forward<Args>(args)...);
+            }
+        }
+
+        template <class... G, class... Args>
+        static return_type dispatch_tag_impl(mpl::vector<G...>, std::size_t tag, base_lhs& lhs, Args&&... args)
+        {
+            using function_type                    = return_type (*)(base_lhs&, Args&&...);
+            static constexpr function_type table[] = {&dispatch_type<G, Args...>...};
+            if (tag < sizeof...(G))
+            {
+                return table[tag](lhs, std::forward<Args>(args)...);
+            }
+            return dispatch(lhs, std::forward<Args>(args)...);
+        }
+
       public:
 
         template <class... Args>
@@ -54,6 +148,23 @@ namespace scopi
         {
             return dispatch_lhs(lhs, lhs_type_list(), std::forward<Args>(args)...);
         }
+
+        /**
+         * @brief Dispatch with a tag giving the type of \c lhs.
+         *
+         * The tag is the position of the type of \c lhs in \c tag_list. The executor is found in a table generated at compile time,
+         * without \c dynamic_cast. If the tag is not smaller than the size of \c tag_list, the dispatch falls back to dispatch.
+         *
+         * @tparam tag_list List of the types that can be tagged.
+         * @param tag [in] Tag of \c lhs.
+         * @param lhs [in] Object.
+         * @param args [in] Arguments of the executor.
+         */
+        template <class tag_list, class... Args>
+        static return_type dispatch_tag(std::size_t tag, base_lhs& lhs, Args&&... args)
+        {
+            return dispatch_tag_impl(tag_list(), tag, lhs, std::forward<Args>(args)...);
+        }
     };
 
     template <class executor,
@@ -119,6 +230,46 @@ namespace scopi
             return dispatch_lhs(lhs, rhs, mpl::vector<U...>(), std::forward<Args>(args)...);
         }
 
+        template <class lhs_tag_type, class rhs_tag_type, class... Args>
+        static return_type dispatch_types(base_lhs& lhs, base_rhs& rhs, Args&&... args)
+        {
+            constexpr bool lhs_in_list = detail::type_in_list<lhs_tag_type, lhs_type_list>::value;
+            constexpr bool rhs_in_list = detail::type_in_list<rhs_tag_type, rhs_type_list>::value;
+            if constexpr (lhs_in_list && rhs_in_list)
+            {
+                constexpr size_t lhs_index = detail::type_position<lhs_tag_type, lhs_type_list>::value;
+                constexpr size_t rhs_index = detail::type_position<rhs_tag_type, rhs_type_list>::value;
+                constexpr bool swap        = std::is_same<symmetric, symmetric_dispatch>::value && (rhs_index < lhs_index);
+                using invoke_flag          = std::integral_constant<bool, swap>;
+                return invoke_executor(static_cast<detail::same_const_t<base_lhs, lhs_tag_type>&>(lhs),
+                                       static_cast<detail::same_const_t<base_rhs, rhs_tag_type>&>(rhs),
+                                       invoke_flag(),
+                                       std::forward<Args>(args)...);
+            }
+            else
+            {
+                return dispatch_lhs(lhs, rhs, mpl::vector<>(), std::forward<Args>(args)...);
+            }
+        }
+
+        template <class lhs_tag_list, class rhs_tag_list, std::size_t... K, class... Args>
+        static return_type
+        dispatch_tag_impl(std::index_sequence<K...>, std::size_t tag_lhs, base_lhs& lhs, std::size_t tag_rhs, base_rhs& rhs, Args&&... args)
+        {
+            constexpr std::size_t nlhs = detail::type_list_size<lhs_tag_list>::value;
+            constexpr std::size_t nrhs = detail::type_list_size<rhs_tag_list>::value;
+
+            using function_type                    = return_type (*)(base_lhs&, base_rhs&, Args&&...);
+            static constexpr function_type table[] = {&dispatch_types<typename detail::type_at<K / nrhs, lhs_tag_list>::type,
+                                                                      typename detail::type_at<K % nrhs, rhs_tag_list>::type,
+                                                                      Args...>...};
+            if (tag_lhs < nlhs && tag_rhs < nrhs)
+            {
+                return table[tag_lhs * nrhs + tag_rhs](lhs, rhs, std::forward<Args>(args)...);
+            }
+            return dispatch(lhs, rhs, std::forward<Args>(args)...);
+        }
+
       public:
 
         template <class... Args>
@@ -126,6 +277,32 @@ namespace scopi
         {
             return dispatch_lhs(lhs, rhs, lhs_type_list(), std::forward<Args>(args)...);
         }
+
+        /**
+         * @brief Dispatch with tags giving the types of \c lhs and \c rhs.
+         *
+         * The tags are the positions of the types in \c lhs_tag_list and \c rhs_tag_list. The executor is found in a 2D table generated
+         * at compile time, without \c dynamic_cast. If a tag is out of its list, the dispatch falls back to dispatch.
+         *
+         * @tparam lhs_tag_list List of the types that can be tagged for \c lhs.
+         * @tparam rhs_tag_list List of the types that can be tagged for \c rhs.
+         * @param tag_lhs [in] Tag of \c lhs.
+         * @param lhs [in] First object.
+         * @param tag_rhs [in] Tag of \c rhs.
+         * @param rhs [in] Second object.
+         * @param args [in] Arguments of the executor.
+         */
+        template <class lhs_tag_list, class rhs_tag_list = lhs_tag_list, class... Args>
+        static return_type dispatch_tag(std::size_t tag_lhs, base_lhs& lhs, std::size_t tag_rhs, base_rhs& rhs, Args&&... args)
+        {
+            constexpr std::size_t ntags = detail::type_list_size<lhs_tag_list>::value * detail::type_list_size<rhs_tag_list>::value;
+            return dispatch_tag_impl<lhs_tag_list, rhs_tag_list>(std::make_index_sequence<ntags>(),
+                                                                 tag_lhs,
+                                                                 lhs,
+                                                                 tag_rhs,
+                                                                 rhs,
+                                                                 std::forward<Args>(args)...);
+        }
     };
 
 }
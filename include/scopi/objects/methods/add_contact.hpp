@@ -2,6 +2,7 @@
 
 #include "../dispatch.hpp"
 #include "../neighbor.hpp"
+#include "../types/sphere.hpp"
 #include "../types/worm.hpp"
 #include "closest_points.hpp"
 
@@ -14,7 +15,10 @@ namespace scopi
         using problem_t = typename Contacts::value_type::problem_t;
         for (std::size_t i = 0; i < w.size() - 1; ++i)
         {
-            auto neigh = closest_points_dispatcher<problem_t, dim>::dispatch(*w.get_sphere(i), *w.get_sphere(i + 1));
+            // the spheres are views on the stack, the dispatch is known at compile time
+            const sphere<dim, false> si(&w.internal_pos()[i], &w.internal_q()[i], w.radius());
+            const sphere<dim, false> sj(&w.internal_pos()[i + 1], &w.internal_q()[i + 1], w.radius());
+            auto neigh = closest_points<problem_t>(si, sj);
             neigh.i    = offset + i;
             neigh.j    = offset + i + 1;
             neigh.nij *= -1;
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "../../types.hpp"
+#include "../dispatch.hpp"
+#include "../types/plane.hpp"
+#include "../types/segment.hpp"
+#include "../types/sphere.hpp"
+#include "../types/superellipsoid.hpp"
+#include "../types/worm.hpp"
+
+namespace scopi
+{
+    // SPHERE
+    /**
+     * @brief Half size of the axis-aligned bounding box of a sphere.
+     *
+     * The box is centered at the position of the sphere.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Sphere.
+     *
+     * @return Half size of the box in each direction.
+     */
+    template <std::size_t dim>
+    type::position_t<dim> bounding_box(const sphere<dim, false>& s)
+    {
+        type::position_t<dim> half_size;
+        half_size.fill(s.radius());
+        return half_size;
+    }
+
+    // SUPERELLIPSOID
+    /**
+     * @brief Half size of the axis-aligned bounding box of a superellipsoid.
+     *
+     * The box is centered at the position of the superellipsoid.
+     * In the frame of the superellipsoid, the superellipsoid is included in the box of half sizes \f$ r_k \f$, so the half size in the
+     * direction \f$ d \f$ is \f$ \sum_k |R_{dk}| r_k \f$, where \f$ R \f$ is the rotation matrix.
+     * If all the squareness parameters are greater or equal to 1, the superellipsoid is included in the ellipsoid of same radiuses and
+     * the half size is \f$ \sqrt{\sum_k R_{dk}^2 r_k^2} \f$.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Superellipsoid.
+     *
+     * @return Half size of the box in each direction.
+     */
+    template <std::size_t dim>
+    type::position_t<dim> bounding_box(const superellipsoid<dim, false>& s)
+    {
+        auto radius          = s.radius();
+        auto squareness      = s.squareness();
+        auto rotation        = s.rotation();
+        const bool ellipsoid = std::all_of(squareness.cbegin(),
+                                           squareness.cend(),
+                                           [](double e)
+                                           {
+                                               return e >= 1.;
+                                           });
+
+        type::position_t<dim> half_size;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            half_size(d) = 0.;
+            for (std::size_t k = 0; k < dim; ++k)
+            {
+                half_size(d) += ellipsoid ? rotation(d, k) * rotation(d, k) * radius(k) * radius(k) : std::abs(rotation(d, k)) * radius(k);
+            }
+            if (ellipsoid)
+            {
+                half_size(d) = std::sqrt(half_size(d));
+            }
+        }
+        return half_size;
+    }
+
+    // PLANE
+    /**
+     * @brief A plane is not bounded.
+     *
+     * @tparam dim Dimension (2 or 3).
+     *
+     * @return Infinity in each direction.
+     */
+    template <std::size_t dim>
+    type::position_t<dim> bounding_box(const plane<dim, false>&)
+    {
+        type::position_t<dim> half_size;
+        half_size.fill(std::numeric_limits<double>::infinity());
+        return half_size;
+    }
+
+    // SEGMENT
+    /**
+     * @brief Half size of the axis-aligned bounding box of a segment.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Segment.
+     *
+     * @return Half size of the box in each direction.
+     */
+    template <std::size_t dim>
+    type::position_t<dim> bounding_box(const segment<dim, false>& s)
+    {
+        auto pts = s.extrema();
+        type::position_t<dim> half_size;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            half_size(d) = 0.5 * std::abs(pts[1](d) - pts[0](d));
+        }
+        return half_size;
+    }
+
+    // WORM
+    /**
+     * @brief Half size of the axis-aligned bounding box of each sphere of the worm.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param w [in] Worm.
+     *
+     * @return Half size of the box in each direction.
+     */
+    template <std::size_t dim>
+    type::position_t<dim> bounding_box(const worm<dim, false>& w)
+    {
+        type::position_t<dim> half_size;
+        half_size.fill(w.radius());
+        return half_size;
+    }
+
+    template <std::size_t dim>
+    struct bounding_box_functor
+    {
+        using return_type = type::position_t<dim>;
+
+        template <class T>
+        return_type run(const T& obj) const
+        {
+            return bounding_box(obj);
+        }
+
+        return_type on_error(const object<dim, false>&) const
+        {
+            return_type half_size;
+            half_size.fill(std::numeric_limits<double>::infinity());
+            return half_size;
+        }
+    };
+
+    template <std::size_t dim>
+    using bounding_box_dispatcher = unit_static_dispatcher<bounding_box_functor<dim>,
+                                                           const object<dim, false>,
+                                                           mpl::vector<const sphere<dim, false>,
+                                                                       const superellipsoid<dim, false>,
+                                                                       const worm<dim, false>,
+                                                                       const plane<dim, false>,
+                                                                       const segment<dim, false>>,
+                                                           typename bounding_box_functor<dim>::return_type>;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include <xtensor-blas/xlinalg.hpp>
+
+#include "../dispatch.hpp"
+#include "../types/plane.hpp"
+#include "../types/segment.hpp"
+#include "../types/sphere.hpp"
+#include "../types/superellipsoid.hpp"
+#include "../types/worm.hpp"
+
+namespace scopi
+{
+    // SPHERE
+    /**
+     * @brief Radius of the smallest ball centered at the position of the sphere that contains it.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Sphere.
+     *
+     * @return Radius of the sphere.
+     */
+    template <std::size_t dim>
+    double bounding_radius(const sphere<dim, false>& s)
+    {
+        return s.radius();
+    }
+
+    // SUPERELLIPSOID
+    /**
+     * @brief Radius of a ball centered at the position of the superellipsoid that contains it.
+     *
+     * In the frame of the superellipsoid, every point of the surface satisfies \f$ |x_k| \le r_k \f$.
+     * If all the squareness parameters are greater or equal to 1, the superellipsoid is included in the ellipsoid of same radiuses
+     * and the largest radius is enough. Otherwise, the corners of the bounding box are used.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Superellipsoid.
+     *
+     * @return Bounding radius of the superellipsoid.
+     */
+    template <std::size_t dim>
+    double bounding_radius(const superellipsoid<dim, false>& s)
+    {
+        auto radius     = s.radius();
+        auto squareness = s.squareness();
+        if (std::all_of(squareness.cbegin(),
+                        squareness.cend(),
+                        [](double e)
+                        {
+                            return e >= 1.;
+                        }))
+        {
+            return *std::max_element(radius.cbegin(), radius.cend());
+        }
+        return xt::linalg::norm(radius);
+    }
+
+    // PLANE
+    /**
+     * @brief A plane is not bounded.
+     *
+     * @tparam dim Dimension (2 or 3).
+     *
+     * @return Infinity.
+     */
+    template <std::size_t dim>
+    double bounding_radius(const plane<dim, false>&)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // SEGMENT
+    /**
+     * @brief Half length of the segment.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param s [in] Segment.
+     *
+     * @return Bounding radius of the segment.
+     */
+    template <std::size_t dim>
+    double bounding_radius(const segment<dim, false>& s)
+    {
+        auto pts = s.extrema();
+        return 0.5 * xt::linalg::norm(pts[1] - pts[0]);
+    }
+
+    // WORM
+    /**
+     * @brief Bounding radius of each sphere of the worm.
+     *
+     * Contacts are computed between the spheres of a worm, so the bounding radius of a particle in a worm is the radius of the spheres.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param w [in] Worm.
+     *
+     * @return Radius of the spheres in the worm.
+     */
+    template <std::size_t dim>
+    double bounding_radius(const worm<dim, false>& w)
+    {
+        return w.radius();
+    }
+
+    template <std::size_t dim>
+    struct bounding_radius_functor
+    {
+        using return_type = double;
+
+        template <class T>
+        return_type run(const T& obj) const
+        {
+            return bounding_radius(obj);
+        }
+
+        return_type on_error(const object<dim, false>&) const
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+    };
+
+    template <std::size_t dim>
+    using bounding_radius_dispatcher = unit_static_dispatcher<bounding_radius_functor<dim>,
+                                                              const object<dim, false>,
+                                                              mpl::vector<const sphere<dim, false>,
+                                                                          const superellipsoid<dim, false>,
+                                                                          const worm<dim, false>,
+                                                                          const plane<dim, false>,
+                                                                          const segment<dim, false>>,
+                                                              typename bounding_radius_functor<dim>::return_type>;
+}
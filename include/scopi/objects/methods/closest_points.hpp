@@ -1,6 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <numeric>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <xtensor-blas/xlinalg.hpp>
 #include <xtensor/xarray.hpp>
@@ -9,7 +14,8 @@
 #include <xtensor/xsort.hpp>
 #include <xtensor/xview.hpp>
 
-#include "../../minpack.hpp"
+#include "../../gjk.hpp"
+#include "../../newton.hpp"
 
 #include "../dispatch.hpp"
 #include "../neighbor.hpp"
@@ -49,23 +55,178 @@ namespace scopi
         return neigh;
     }
 
+    /**
+     * @brief Method of closest_points between two superellipsoids.
+     */
+    enum class superellipsoid_method
+    {
+        /**
+         * @brief Newton method on the angles of the two closest points, started from the previous time step or from sampled points.
+         */
+        newton,
+        /**
+         * @brief gjk_distance with the support functions of the two superellipsoids.
+         */
+        gjk
+    };
+
+    /**
+     * @brief Method of closest_points between two superellipsoids for a problem.
+     *
+     * The Newton method is used by default. Another method is chosen at compile time by specializing this structure, for instance
+     * \code{.cpp}
+     * template <>
+     * struct scopi::superellipsoid_closest_points<scopi::DryWithoutFriction>
+     * {
+     *     static constexpr scopi::superellipsoid_method value = scopi::superellipsoid_method::gjk;
+     * };
+     * \endcode
+     *
+     * @tparam problem_t Problem.
+     */
+    template <class problem_t>
+    struct superellipsoid_closest_points
+    {
+        static constexpr superellipsoid_method value = superellipsoid_method::newton;
+    };
+
+    /**
+     * @brief Neighbor between two superellipsoids with gjk_distance.
+     *
+     * The support points are computed in the frame of each superellipsoid (see superellipsoid::support) and rotated with its rotation
+     * matrix. The search starts from the normal of the previous time step if \c guess is given, from the line between the centers
+     * otherwise.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam owner
+     * @param s1 [in] Superellipsoid \c i.
+     * @param s2 [in] Superellipsoid \c j.
+     * @param guess [in] Normal at the previous time step, can be null.
+     * @param neigh [out] Neighbor struct for contact between superellipsoid \c i and superellipsoid \c j.
+     *
+     * @return Whether gjk_distance converged, \c neigh is not modified otherwise.
+     */
+    template <class problem_t, std::size_t dim, bool owner>
+    bool closest_points_gjk(const superellipsoid<dim, owner>& s1,
+                            const superellipsoid<dim, owner>& s2,
+                            const surface_parameters* guess,
+                            neighbor<dim, problem_t>& neigh)
+    {
+        auto support = [](const superellipsoid<dim, owner>& s, const type::matrix_rotation_t<dim>& r)
+        {
+            return [&s, &r](const std::array<double, dim>& d)
+            {
+                type::position_t<dim> direction;
+                for (std::size_t k = 0; k < dim; ++k)
+                {
+                    direction(k) = 0.;
+                    for (std::size_t l = 0; l < dim; ++l)
+                    {
+                        direction(k) += r(l, k) * d[l];
+                    }
+                }
+                const auto pt  = s.support(direction);
+                const auto pos = s.pos(0);
+                std::array<double, dim> res;
+                for (std::size_t k = 0; k < dim; ++k)
+                {
+                    res[k] = pos(k);
+                    for (std::size_t l = 0; l < dim; ++l)
+                    {
+                        res[k] += r(k, l) * pt(l);
+                    }
+                }
+                return res;
+            };
+        };
+        const type::matrix_rotation_t<dim> r1 = s1.rotation();
+        const type::matrix_rotation_t<dim> r2 = s2.rotation();
+
+        // the normal goes from j to i and the search direction from i to j
+        std::array<double, dim> direction;
+        for (std::size_t k = 0; k < dim; ++k)
+        {
+            direction[k] = (guess != nullptr && guess->valid) ? -guess->u[k] : s2.pos(0)(k) - s1.pos(0)(k);
+        }
+
+        const auto result = gjk_distance<dim>(support(s1, r1), support(s2, r2), direction, 1e-12);
+        if (!result.converged)
+        {
+            return false;
+        }
+        for (std::size_t k = 0; k < dim; ++k)
+        {
+            neigh.pi(k)  = result.pa[k];
+            neigh.pj(k)  = result.pb[k];
+            neigh.nij(k) = result.normal[k];
+            neigh.u.u[k] = result.normal[k];
+        }
+        neigh.u.valid = true;
+        neigh.dij     = result.distance;
+        return true;
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Flat indices of the smallest entries of an array, in increasing order.
+         *
+         * @param distances [in] Array of distances between samples.
+         * @param n [in] Maximum number of indices.
+         */
+        template <class E>
+        std::vector<std::size_t> closest_samples(const E& distances, std::size_t n)
+        {
+            std::vector<std::size_t> order(distances.size());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            n = std::min(n, order.size());
+            std::partial_sort(order.begin(),
+                              order.begin() + static_cast<std::ptrdiff_t>(n),
+                              order.end(),
+                              [&](std::size_t a, std::size_t b)
+                              {
+                                  return distances.data()[a] < distances.data()[b];
+                              });
+            order.resize(n);
+            return order;
+        }
+    }
+
     // SUPERELLIPSOID 2D - SUPERELLIPSOID 2D
     /**
      * @brief Neighbor between two superellipsoids in 2D.
      *
      * See neighbor.hpp.
      *
+     * The Newton method starts from \c guess if it is given, for instance the parameters of the same pair at the previous time step.
+     * The starting point is found by sampling the two surfaces only if there is no guess or if the Newton method fails from it: the
+     * Newton method is then started from the closest pairs of samples, up to 4 of them, until it converges. There is no other
+     * fallback, so the closest points are found without allocating the temporaries of minpack; if no start converges, the last
+     * iterate is used.
+     * If the problem uses superellipsoid_method::gjk (see superellipsoid_closest_points), the Newton method is only used when
+     * closest_points_gjk does not converge.
+     *
      * @tparam owner
      * @param s1 [in] Superellipsoid \c i.
      * @param s2 [in] Superellipsoid \c j.
+     * @param guess [in] Starting point of the Newton method, can be null.
      *
      * @return Neighbor struct for contact between superellipsoid \c i and superellipsoid \c j.
      */
     template <class problem_t, bool owner>
-    auto closest_points(const superellipsoid<2, owner>& s1, const superellipsoid<2, owner>& s2)
+    auto closest_points(const superellipsoid<2, owner>& s1, const superellipsoid<2, owner>& s2, const surface_parameters* guess = nullptr)
     {
         // std::cout << "closest_points : SUPERELLIPSOID - SUPERELLIPSOID" << std::endl;
         neighbor<2, problem_t> neigh;
+        if constexpr (superellipsoid_closest_points<problem_t>::value == superellipsoid_method::gjk)
+        {
+            if (closest_points_gjk(s1, s2, guess, neigh))
+            {
+                return neigh;
+            }
+            // the shapes touch or the penetration did not converge, the guess is a normal and not angles
+            guess = nullptr;
+        }
         // xt::xtensor_fixed<double, xt::xshape<2*(2*dim+dim-1+dim*dim)>> args = xt::hstack(xt::xtuple(
         xt::xtensor_fixed<double, xt::xshape<18>> args = xt::hstack(xt::xtuple(xt::view(s1.pos(), 0),
                                                                                s1.radius(),
@@ -76,10 +237,10 @@ namespace scopi
                                                                                s2.squareness(),
                                                                                xt::flatten(s2.rotation())));
 
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double b1    = u(0);
-            double b2    = u(1);
+            double b1    = u[0];
+            double b2    = u[1];
             double s1xc  = args(0);
             double s1yc  = args(1);
             double s1rx  = args(2);
@@ -126,10 +287,10 @@ namespace scopi
                          * std::sqrt(std::pow(N01 * F5 + N00 * F7, 2) + std::pow(N11 * F5 + N10 * F7, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double b1    = u(0);
-            double b2    = u(1);
+            double b1    = u[0];
+            double b2    = u[1];
             double s1xc  = args(0);
             double s1yc  = args(1);
             double s1rx  = args(2);
@@ -192,53 +353,55 @@ namespace scopi
             return res;
         };
 
-        int num        = 4;
-        auto binit1_xy = xt::unique(xt::adapt(s1.binit_xy(num)));
-        // std::cout << "binit1_xy = " << binit1_xy << std::endl;
-        auto binit2_xy = xt::unique(xt::adapt(s2.binit_xy(num)));
-        // std::cout << "binit2_xy = " << binit2_xy << std::endl;
+        auto solve = [&](const std::array<double, 2>& u0)
+        {
+            auto [u, iter] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-10);
+            return std::make_pair(u, iter >= 0 ? 1 : 0);
+        };
 
-        xt::xtensor<double, 2> distances = xt::zeros<double>({binit1_xy.size(), binit2_xy.size()});
-        for (std::size_t i = 0; i < binit1_xy.size(); i++)
+        std::array<double, 2> u;
+        int info = 0;
+        if (guess != nullptr && guess->valid)
         {
-            for (std::size_t j = 0; j < binit2_xy.size(); j++)
-            {
-                distances(i, j) = xt::linalg::norm(xt::flatten(s1.point(binit1_xy(i))) - xt::flatten(s2.point(binit2_xy(j))), 2)
-                                + 2 * (1 + xt::linalg::vdot(s1.normal(binit1_xy(i)), s2.normal(binit2_xy(j))));
-            }
+            std::tie(u, info) = solve({guess->u[0], guess->u[1]});
         }
-        // std::cout << "distances =" << distances << std::endl;
-        auto dmin = xt::amin(distances);
-        // std::cout << "distance min =" << dmin << std::endl;
-        auto indmin = xt::from_indices(xt::where(xt::equal(distances, dmin(0)))); // xt::argmin(distances);
-        // std::cout << "indmin =" << indmin << std::endl;
-        // std::cout << "indmin(0,0) =" << xt::row(indmin,0)(0) << std::endl;
-        // std::cout << "indmin(1,0) =" << xt::row(indmin,1)(0) << std::endl;
-
-        // std::cout << "pt s1 = " << s1.point(binit1_xy(xt::row(indmin,0)(0))) << std::endl;
-        // std::cout << "pt s2 = " << s2.point(binit2_xy(xt::row(indmin,1)(0))) << std::endl;
-        xt::xtensor_fixed<double, xt::xshape<2>> u0 = {binit1_xy(xt::row(indmin, 0)(0)), binit2_xy(xt::row(indmin, 1)(0))};
-        // std::cout << "u0 =" << u0 << std::endl;
-        auto [xx, info] = hybrd1(u0, newton_F, newton_GradF, args);
-        xt::xtensor_fixed<double, xt::xshape<2>> u;
-        for (int j = 0; j < 2; j++)
+        // new pair, or the Newton method failed from the guess: the starting point is found by sampling the surfaces
+        if (info != 1)
         {
-            u(j) = xx[j];
+            int num        = 4;
+            auto binit1_xy = xt::unique(xt::adapt(s1.binit_xy(num)));
+            // std::cout << "binit1_xy = " << binit1_xy << std::endl;
+            auto binit2_xy = xt::unique(xt::adapt(s2.binit_xy(num)));
+            // std::cout << "binit2_xy = " << binit2_xy << std::endl;
+
+            xt::xtensor<double, 2> distances = xt::zeros<double>({binit1_xy.size(), binit2_xy.size()});
+            for (std::size_t i = 0; i < binit1_xy.size(); i++)
+            {
+                for (std::size_t j = 0; j < binit2_xy.size(); j++)
+                {
+                    distances(i, j) = xt::linalg::norm(xt::flatten(s1.point(binit1_xy(i))) - xt::flatten(s2.point(binit2_xy(j))), 2)
+                                    + 2 * (1 + xt::linalg::vdot(s1.normal(binit1_xy(i)), s2.normal(binit2_xy(j))));
+                }
+            }
+            // std::cout << "distances =" << distances << std::endl;
+            // the Newton method starts from the closest pairs of samples until it converges
+            for (std::size_t k : detail::closest_samples(distances, 4))
+            {
+                const std::size_t i = k / distances.shape(1);
+                const std::size_t j = k % distances.shape(1);
+                std::tie(u, info)   = solve({binit1_xy(i), binit2_xy(j)});
+                if (info == 1)
+                {
+                    break;
+                }
+            }
         }
         // auto [ u, info ] = newton_method(u0,newton_F,newton_GradF,args,2000,1.0e-10,1.0e-7);
-        if (info == -1)
-        {
-            std::cout << "\ns1 : " << std::endl;
-            s1.print();
-            std::cout << "s2 : " << std::endl;
-            s2.print();
-            std::cout << "s1.pos = " << s1.pos() << " s1.rotation = " << xt::flatten(s1.rotation()) << std::endl;
-            std::cout << "s2.pos = " << s2.pos() << " s2.rotation = " << xt::flatten(s2.rotation()) << std::endl;
-            exit(0);
-        }
-        neigh.pi  = s1.point(u(0));
-        neigh.pj  = s2.point(u(1));
-        neigh.nij = s2.normal(u(1));
+        neigh.pi  = s1.point(u[0]);
+        neigh.pj  = s2.point(u[1]);
+        neigh.nij = s2.normal(u[1]);
+        // with gjk, the parameters of the next time step are a normal
+        neigh.u   = {{u[0], u[1]}, superellipsoid_closest_points<problem_t>::value == superellipsoid_method::newton};
         // neigh.dij = xt::linalg::dot(neigh.pi - neigh.pj, neigh.nij)[0];
         auto xtsign = xt::sign(xt::eval(xt::linalg::dot(xt::flatten(neigh.pi) - xt::flatten(neigh.pj), xt::flatten(neigh.nij))));
         neigh.dij   = xtsign(0) * xt::linalg::norm(xt::flatten(neigh.pi) - xt::flatten(neigh.pj), 2);
@@ -254,17 +417,29 @@ namespace scopi
      *
      * See neighbor.hpp.
      *
+     * The starting point of the Newton method is chosen as in the 2D case.
+     *
      * @tparam owner
      * @param s1 [in] Superellipsoid \c i.
      * @param s2 [in] Superellipsod \c j.
+     * @param guess [in] Starting point of the Newton method, can be null.
      *
      * @return Neighbor struct for contact between superellispoid \c i and superellipsoid \c j.
      */
     template <class problem_t, bool owner>
-    auto closest_points(const superellipsoid<3, owner>& s1, const superellipsoid<3, owner>& s2)
+    auto closest_points(const superellipsoid<3, owner>& s1, const superellipsoid<3, owner>& s2, const surface_parameters* guess = nullptr)
     {
         // std::cout << "closest_points : SUPERELLIPSOID - SUPERELLIPSOID" << std::endl;
         neighbor<3, problem_t> neigh;
+        if constexpr (superellipsoid_closest_points<problem_t>::value == superellipsoid_method::gjk)
+        {
+            if (closest_points_gjk(s1, s2, guess, neigh))
+            {
+                return neigh;
+            }
+            // the shapes touch or the penetration did not converge, the guess is a normal and not angles
+            guess = nullptr;
+        }
         // xt::xtensor_fixed<double, xt::xshape<2*(2*dim+dim-1+dim*dim)>> args = xt::hstack(xt::xtuple(
         xt::xtensor_fixed<double, xt::xshape<34>> args = xt::hstack(xt::xtuple(xt::view(s1.pos(), 0),
                                                                                s1.radius(),
@@ -279,12 +454,12 @@ namespace scopi
         // std::cout << "s1.pos = " << s1.pos() << " s1.rotation = " << xt::flatten(s1.rotation()) << std::endl;
         // std::cout << "s2.pos = " << s2.pos() << " s2.rotation = " << xt::flatten(s2.rotation()) << std::endl;
         // std::cout << "args = " << args << std::endl;
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double a1   = u(0);
-            double b1   = u(1);
-            double a2   = u(2);
-            double b2   = u(3);
+            double a1   = u[0];
+            double b1   = u[1];
+            double a2   = u[2];
+            double b2   = u[3];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1zc = args(2);
@@ -382,12 +557,12 @@ namespace scopi
                                      + std::pow(N20 * B4 + N21 * B5 + N22 * B6, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double a1   = u(0);
-            double b1   = u(1);
-            double a2   = u(2);
-            double b2   = u(3);
+            double a1   = u[0];
+            double b1   = u[1];
+            double a2   = u[2];
+            double b2   = u[3];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1zc = args(2);
@@ -601,106 +776,82 @@ namespace scopi
                       + (M20 * A1 + M21 * A2 + M22 * A3) * (-N20 * B15 + N21 * B16);
             return res;
         };
-        const int num = 6;
-        auto binit1   = xt::unique(xt::adapt(s1.binit_xy(num)));
-        auto ainit1   = xt::unique(xt::adapt(s1.ainit_yz(num)));
-
-        // auto binit1_xy = xt::unique(xt::adapt(s1.binit_xy(num)));
-        // std::cout << " binit1_xy = " << binit1_xy << std::endl;
-        // auto ainit1_yz = xt::unique(xt::adapt(s1.ainit_yz(num)));
-        // std::cout << " ainit1_yz = " << ainit1_yz << std::endl;
-        // auto ainit1_xz = xt::unique(xt::adapt(s1.ainit_xz(num)));
-        // std::cout << " ainit1_xz = " << ainit1_xz << std::endl;
-        // // exit(0);
-        // // std::cout << " binit1_xy.size() = " << binit1_xy.size() << " ainit1_yz.size() = " << ainit1_yz.size() << " ainit1_xz.size() =
-        // " << ainit1_xz.size() << std::endl; auto binit1 = xt::concatenate(xt::xtuple(binit1_xy,binit1_xy)); auto ainit1 =
-        // xt::concatenate(xt::xtuple(ainit1_yz,ainit1_xz)); std::cout << " ainit1.size() = " << ainit1.size() << " binit1.size() = " <<
-        // binit1.size() << std::endl;
-        auto [agrid1, bgrid1] = xt::meshgrid(ainit1, binit1);
-        auto fl_agrid1        = xt::flatten(agrid1);
-        auto fl_bgrid1        = xt::flatten(bgrid1);
-        // std::cout << "agrid1 = " << agrid1 << "bgrid1 = " << bgrid1 << std::endl;
-        // std::cout << "flatten agrid1 =" << fl_agrid1 << std::endl;
-        // std::cout << "flatten bgrid1 =" << fl_bgrid1 << std::endl;
-
-        auto binit2 = xt::unique(xt::adapt(s2.binit_xy(num)));
-        auto ainit2 = xt::unique(xt::adapt(s2.ainit_yz(num)));
-        // auto binit2_xy = xt::unique(xt::adapt(s2.binit_xy(num)));
-        // std::cout << " binit2_xy = " << binit2_xy << std::endl;
-        // auto ainit2_yz = xt::unique(xt::adapt(s2.ainit_yz(num)));
-        // std::cout << " ainit2_yz = " << ainit2_yz << std::endl;
-        // auto ainit2_xz = xt::unique(xt::adapt(s2.ainit_xz(num)));
-        // std::cout << " ainit2_xz = " << ainit2_xz << std::endl;
-        // // std::cout << " binit2_xy.size() = " << binit2_xy.size() << " ainit2_yz.size() = " << ainit2_yz.size() << " ainit2_xz.size() =
-        // " << ainit2_xz.size() << std::endl; auto binit2 = xt::concatenate(xt::xtuple(binit2_xy,binit2_xy)); auto ainit2 =
-        // xt::concatenate(xt::xtuple(ainit2_yz,ainit2_xz)); std::cout << " ainit2.size() = " << ainit2.size() << " binit2.size() = " <<
-        // binit2.size() << std::endl;
-        auto [agrid2, bgrid2] = xt::meshgrid(ainit2, binit2);
-        // std::cout << "agrid2 = " << agrid2 << "bgrid2 = " << bgrid2 << std::endl;
-
-        auto fl_agrid2 = xt::flatten(agrid2);
-        auto fl_bgrid2 = xt::flatten(bgrid2);
-        // std::cout << "flatten agrid2 =" << fl_agrid2 << std::endl;
-        // std::cout << "flatten bgrid2 =" << fl_bgrid2 << std::endl;
-        //
-        // std::cout << " fl_agrid1.size() = " << fl_agrid1.size() << " fl_agrid2.size() = " << fl_agrid2.size() << std::endl;
-        xt::xtensor<double, 2> distances = xt::zeros<double>({fl_agrid1.size(), fl_agrid2.size()});
-        for (std::size_t i = 0; i < fl_agrid1.size(); i++)
+        auto solve = [&](const std::array<double, 4>& u0)
         {
-            for (std::size_t j = 0; j < fl_agrid2.size(); j++)
-            {
-                distances(i, j) = xt::linalg::norm(
-                                      xt::flatten(s1.point(fl_agrid1(i), fl_bgrid1(i))) - xt::flatten(s2.point(fl_agrid2(j), fl_bgrid2(j))),
-                                      2)
-                                + 2 * (1 + xt::linalg::vdot(s1.normal(fl_agrid1(i), fl_bgrid1(i)), s2.normal(fl_agrid2(j), fl_bgrid2(j))));
-            }
-        }
-        // std::cout << "distances =" << distances << std::endl;
-        auto dmin = xt::amin(distances);
-        // std::cout << "distance min =" << dmin << std::endl;
-        auto indmin = xt::from_indices(xt::where(xt::equal(distances, dmin(0)))); // xt::argmin(distances);
-        // std::cout << "indmin =" << indmin << std::endl;
-        // std::cout << "indmin(0,0) =" << xt::row(indmin,0)(0) << std::endl;
-        // std::cout << "indmin(1,0) =" << xt::row(indmin,1)(0) << std::endl;
-
-        // for (int l=0; xt::row(indmin,0).size(); ++l){
-        //     std::cout << "l =" << l << " pt s1 = " << s1.point(fl_agrid1(xt::row(indmin,0)(l)),fl_bgrid1(xt::row(indmin,0)(l))) <<
-        //     std::endl; std::cout << "l =" << l << " pt s2 = " <<
-        //     s2.point(fl_agrid1(xt::row(indmin,1)(l)),fl_bgrid1(xt::row(indmin,1)(l))) << std::endl;
-        // }
-        // std::cout << "pt s1 = " << s1.point(fl_agrid1(xt::row(indmin,0)(0)),fl_bgrid1(xt::row(indmin,0)(0))) << std::endl;
-        // std::cout << "pt s2 = " << s2.point(fl_agrid2(xt::row(indmin,1)(0)),fl_bgrid2(xt::row(indmin,1)(0))) << std::endl;
-        // xt::xtensor_fixed<double, xt::xshape<4>> u0 = {fl_agrid1(iindmin(0,0)),fl_bgrid1(indmin(0,1)),
-        //                                                fl_agrid2(indmin(1,0)),fl_bgrid2(indmin(1,1))};
-        xt::xtensor_fixed<double, xt::xshape<4>> u0 = {fl_agrid1(xt::row(indmin, 0)(0)),
-                                                       fl_bgrid1(xt::row(indmin, 0)(0)),
-                                                       fl_agrid2(xt::row(indmin, 1)(0)),
-                                                       fl_bgrid2(xt::row(indmin, 1)(0))};
-        // std::cout << "u0 =" << u0 << std::endl;
+            auto [u, iter] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-10);
+            return std::make_pair(u, iter >= 0 ? 1 : 0);
+        };
 
-        // exit(0);
-        // auto ainit = xt::linspace<double>(-pi/2, pi/2, num);
-        // auto binit = xt::linspace<double>(-pi, pi, num);
-        // xt::xtensor_fixed<double, xt::xshape<num,num>> dinit;
-        // for (std::size_t i = 0; i < binit.size(); i++) {
-        //   for (std::size_t j = 0; j < binit.size(); j++) {
-        //     dinit(i,j) = xt::linalg::norm(s1.point(ainit(i),binit(i))-s2.point(ainit(j),binit(j)),2);
-        //   }
-        // }
-        // // std::cout << "initialization : b = " << binit << " distances = " << dinit << std::endl;
-        // auto dmin = xt::amin(dinit);
-        // // std::cout << "initialization : dmin = " << dmin << std::endl;
-        // auto indmin = xt::from_indices(xt::where(xt::equal(dinit, dmin)));
-        // // std::cout << "initialization : indmin = " << indmin << std::endl;
-        // // std::cout << "initialization : imin = " << indmin(0,0) << " jmin = " << indmin(1,0) << std::endl;
-        // xt::xtensor_fixed<double, xt::xshape<4>> u0 = { ainit(indmin(0,0)), binit(indmin(0,0)), ainit(indmin(1,0)), binit(indmin(1,0)) };
-        // std::cout << "u0 = "<< u0 << std::endl;
-        // std::cout << "newton_GradF(u0,args) = " << newton_GradF(u0,args) << " newton_F(u0,args) = " << newton_F(u0,args) << std::endl;
-        auto [xx, info] = hybrd1(u0, newton_F, newton_GradF, args);
-        xt::xtensor_fixed<double, xt::xshape<4>> u;
-        for (int j = 0; j < 4; j++)
+        std::array<double, 4> u;
+        int info = 0;
+        if (guess != nullptr && guess->valid)
         {
-            u(j) = xx[j];
+            std::tie(u, info) = solve({guess->u[0], guess->u[1], guess->u[2], guess->u[3]});
+        }
+        // new pair, or the Newton method failed from the guess: the starting point is found by sampling the surfaces
+        if (info != 1)
+        {
+            const int num = 6;
+            auto binit1   = xt::unique(xt::adapt(s1.binit_xy(num)));
+            auto ainit1   = xt::unique(xt::adapt(s1.ainit_yz(num)));
+
+            // auto binit1_xy = xt::unique(xt::adapt(s1.binit_xy(num)));
+            // std::cout << " binit1_xy = " << binit1_xy << std::endl;
+            // auto ainit1_yz = xt::unique(xt::adapt(s1.ainit_yz(num)));
+            // std::cout << " ainit1_yz = " << ainit1_yz << std::endl;
+            // auto ainit1_xz = xt::unique(xt::adapt(s1.ainit_xz(num)));
+            // std::cout << " ainit1_xz = " << ainit1_xz << std::endl;
+            // // exit(0);
+            auto [agrid1, bgrid1] = xt::meshgrid(ainit1, binit1);
+            auto fl_agrid1        = xt::flatten(agrid1);
+            auto fl_bgrid1        = xt::flatten(bgrid1);
+            // std::cout << "agrid1 = " << agrid1 << "bgrid1 = " << bgrid1 << std::endl;
+            // std::cout << "flatten agrid1 =" << fl_agrid1 << std::endl;
+            // std::cout << "flatten bgrid1 =" << fl_bgrid1 << std::endl;
+
+            auto binit2 = xt::unique(xt::adapt(s2.binit_xy(num)));
+            auto ainit2 = xt::unique(xt::adapt(s2.ainit_yz(num)));
+            // auto binit2_xy = xt::unique(xt::adapt(s2.binit_xy(num)));
+            // std::cout << " binit2_xy = " << binit2_xy << std::endl;
+            // auto ainit2_yz = xt::unique(xt::adapt(s2.ainit_yz(num)));
+            // std::cout << " ainit2_yz = " << ainit2_yz << std::endl;
+            // auto ainit2_xz = xt::unique(xt::adapt(s2.ainit_xz(num)));
+            // std::cout << " ainit2_xz = " << ainit2_xz << std::endl;
+            auto [agrid2, bgrid2] = xt::meshgrid(ainit2, binit2);
+            // std::cout << "agrid2 = " << agrid2 << "bgrid2 = " << bgrid2 << std::endl;
+
+            auto fl_agrid2 = xt::flatten(agrid2);
+            auto fl_bgrid2 = xt::flatten(bgrid2);
+            // std::cout << "flatten agrid2 =" << fl_agrid2 << std::endl;
+            // std::cout << "flatten bgrid2 =" << fl_bgrid2 << std::endl;
+            //
+            // std::cout << " fl_agrid1.size() = " << fl_agrid1.size() << " fl_agrid2.size() = " << fl_agrid2.size() << std::endl;
+            xt::xtensor<double, 2> distances = xt::zeros<double>({fl_agrid1.size(), fl_agrid2.size()});
+            for (std::size_t i = 0; i < fl_agrid1.size(); i++)
+            {
+                for (std::size_t j = 0; j < fl_agrid2.size(); j++)
+                {
+                    distances(i, j) = xt::linalg::norm(xt::flatten(s1.point(fl_agrid1(i), fl_bgrid1(i)))
+                                                           - xt::flatten(s2.point(fl_agrid2(j), fl_bgrid2(j))),
+                                                       2)
+                                    + 2
+                                          * (1
+                                             + xt::linalg::vdot(s1.normal(fl_agrid1(i), fl_bgrid1(i)),
+                                                                s2.normal(fl_agrid2(j), fl_bgrid2(j))));
+                }
+            }
+            // std::cout << "distances =" << distances << std::endl;
+            // the Newton method starts from the closest pairs of samples until it converges
+            for (std::size_t k : detail::closest_samples(distances, 4))
+            {
+                const std::size_t i = k / distances.shape(1);
+                const std::size_t j = k % distances.shape(1);
+                std::tie(u, info)   = solve({fl_agrid1(i), fl_bgrid1(i), fl_agrid2(j), fl_bgrid2(j)});
+                if (info == 1)
+                {
+                    break;
+                }
+            }
         }
         // std::cout << " u hybr = " << u << std::endl;
         // std::cout << " info hybr = " << info << std::endl;
@@ -717,13 +868,11 @@ namespace scopi
         // std::cout << "s2.pos = " << s2.pos() << " s2.rotation = " << xt::flatten(s2.rotation()) << std::endl;
         // exit(0);
         // }
-        if (info == -1)
-        {
-            exit(0);
-        }
-        neigh.pi    = s1.point(u(0), u(1));
-        neigh.pj    = s2.point(u(2), u(3));
-        neigh.nij   = s2.normal(u(2), u(3));
+        neigh.pi    = s1.point(u[0], u[1]);
+        neigh.pj    = s2.point(u[2], u[3]);
+        neigh.nij   = s2.normal(u[2], u[3]);
+        // with gjk, the parameters of the next time step are a normal
+        neigh.u     = {{u[0], u[1], u[2], u[3]}, superellipsoid_closest_points<problem_t>::value == superellipsoid_method::newton};
         auto xtsign = xt::sign(xt::eval(xt::linalg::dot(xt::flatten(neigh.pi) - xt::flatten(neigh.pj), xt::flatten(neigh.nij))));
         neigh.dij   = xtsign(0) * xt::linalg::norm(xt::flatten(neigh.pi) - xt::flatten(neigh.pj), 2);
         // std::cout << "pi = " << neigh.pi << " pj = " << neigh.pj << std::endl;
@@ -957,12 +1106,12 @@ namespace scopi
                                                                                xts2r,
                                                                                xt::flatten(s2.rotation())));
         // std::cout << "args = " << args << std::endl;
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double a1   = u(0);
-            double b1   = u(1);
-            double a2   = u(2);
-            double b2   = u(3);
+            double a1   = u[0];
+            double b1   = u[1];
+            double a2   = u[2];
+            double b2   = u[3];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1zc = args(2);
@@ -1050,12 +1199,12 @@ namespace scopi
                                      + std::pow(N20 * B4 + N21 * B5 + N22 * B6, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double a1   = u(0);
-            double b1   = u(1);
-            double a2   = u(2);
-            double b2   = u(3);
+            double a1   = u[0];
+            double b1   = u[1];
+            double a2   = u[2];
+            double b2   = u[3];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1zc = args(2);
@@ -1269,13 +1418,13 @@ namespace scopi
         auto indmin = xt::from_indices(xt::where(xt::equal(dinit, dmin)));
         // std::cout << "initialization : indmin = " << indmin << std::endl;
         // std::cout << "initialization : imin = " << indmin(0,0) << " jmin = " << indmin(1,0) << std::endl;
-        xt::xtensor_fixed<double, xt::xshape<4>> u0 = {ainit(indmin(0, 0)), binit(indmin(0, 0)), ainit(indmin(1, 0)), binit(indmin(1, 0))};
+        std::array<double, 4> u0 = {ainit(indmin(0, 0)), binit(indmin(0, 0)), ainit(indmin(1, 0)), binit(indmin(1, 0))};
         // std::cout << "u0 = "<< u0 << std::endl;
         // std::cout << "newton_GradF(u0,args) = " << newton_GradF(u0,args) << " newton_F(u0,args) = " << newton_F(u0,args) << std::endl;
         auto [u, info] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-7);
-        neigh.pi       = s1.point(u(0), u(1));
-        neigh.pj       = s2.point(u(2), u(3));
-        neigh.nij      = s2.normal(u(2), u(3));
+        neigh.pi       = s1.point(u[0], u[1]);
+        neigh.pj       = s2.point(u[2], u[3]);
+        neigh.nij      = s2.normal(u[2], u[3]);
         neigh.dij      = xt::linalg::dot(neigh.pi - neigh.pj, neigh.nij)[0];
         return neigh;
     }
@@ -1329,10 +1478,10 @@ namespace scopi
                                                                                xts2r,
                                                                                xt::flatten(s2.rotation())));
         // std::cout << "args = " << args << std::endl;
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double b1   = u(0);
-            double b2   = u(1);
+            double b1   = u[0];
+            double b2   = u[1];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1rx = args(2);
@@ -1365,10 +1514,10 @@ namespace scopi
                          * std::sqrt(std::pow(M00 * D3 + M01 * D1, 2) + std::pow(M10 * D3 + M11 * D1, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double b1   = u(0);
-            double b2   = u(1);
+            double b1   = u[0];
+            double b2   = u[1];
             double s1xc = args(0);
             double s1yc = args(1);
             double s1rx = args(2);
@@ -1432,12 +1581,12 @@ namespace scopi
         auto indmin = xt::from_indices(xt::where(xt::equal(dinit, dmin)));
         // std::cout << "initialization : indmin = " << indmin << std::endl;
         // std::cout << "initialization : imin = " << indmin(0,0) << " jmin = " << indmin(1,0) << std::endl;
-        xt::xtensor_fixed<double, xt::xshape<2>> u0 = {binit(indmin(0, 0)), binit(indmin(1, 0))};
+        std::array<double, 2> u0 = {binit(indmin(0, 0)), binit(indmin(1, 0))};
         // std::cout << "newton_GradF(u0,args) = " << newton_GradF(u0,args) << " newton_F(u0,args) = " << newton_F(u0,args) << std::endl;
         auto [u, info] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-7);
-        neigh.pi       = s1.point(u(0));
-        neigh.pj       = s2.point(u(1));
-        neigh.nij      = s2.normal(u(1));
+        neigh.pi       = s1.point(u[0]);
+        neigh.pj       = s2.point(u[1]);
+        neigh.nij      = s2.normal(u[1]);
         neigh.dij      = xt::linalg::dot(neigh.pi - neigh.pj, neigh.nij)[0];
         return neigh;
     }
@@ -1493,12 +1642,12 @@ namespace scopi
                                                                                xt::flatten(p2.rotation()),
                                                                                xt_sign_p2s));
         // std::cout << "args = " << args << std::endl;
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double a1       = u(0);
-            double b1       = u(1);
-            double a2       = u(2);
-            double b2       = u(3);
+            double a1       = u[0];
+            double b1       = u[1];
+            double a2       = u[2];
+            double b2       = u[3];
             double s1xc     = args(0);
             double s1yc     = args(1);
             double s1zc     = args(2);
@@ -1571,12 +1720,12 @@ namespace scopi
                                      + std::pow(M20 * A1 + M21 * A2 + M22 * A3, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double a1       = u(0);
-            double b1       = u(1);
-            double a2       = u(2);
-            double b2       = u(3);
+            double a1       = u[0];
+            double b1       = u[1];
+            double a2       = u[2];
+            double b2       = u[3];
             double s1xc     = args(0);
             double s1yc     = args(1);
             double s1zc     = args(2);
@@ -1734,12 +1883,12 @@ namespace scopi
         auto indmin = xt::from_indices(xt::where(xt::equal(dinit, dmin)));
         // std::cout << "initialization : indmin = " << indmin << std::endl;
         // std::cout << "initialization : imin = " << indmin(0,0) << " jmin = " << indmin(1,0) << std::endl;
-        xt::xtensor_fixed<double, xt::xshape<4>> u0 = {ainit(indmin(0, 0)), binit(indmin(0, 0)), ainit(indmin(1, 0)), binit(indmin(1, 0))};
+        std::array<double, 4> u0 = {ainit(indmin(0, 0)), binit(indmin(0, 0)), ainit(indmin(1, 0)), binit(indmin(1, 0))};
         // std::cout << "u0 = "<< u0 << std::endl;
         // std::cout << "newton_GradF(u0,args) = " << newton_GradF(u0,args) << " newton_F(u0,args) = " << newton_F(u0,args) << std::endl;
         auto [u, info] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-7);
-        neigh.pi       = s1.point(u(0), u(1));
-        neigh.pj       = p2.point(u(2), u(3));
+        neigh.pi       = s1.point(u[0], u[1]);
+        neigh.pj       = p2.point(u[2], u[3]);
         neigh.nij      = p2.normal();
         neigh.dij      = xt::linalg::dot(neigh.pi - neigh.pj, neigh.nij)[0];
         return neigh;
@@ -1797,10 +1946,10 @@ namespace scopi
                                                                                xt::flatten(d2.rotation()),
                                                                                xt_sign_d2s));
         // std::cout << "args = " << args << std::endl;
-        auto newton_F = [](auto u, auto args)
+        auto newton_F = [](const auto& u, const auto& args)
         {
-            double b1       = u(0);
-            double a2       = u(1);
+            double b1       = u[0];
+            double a2       = u[1];
             double s1xc     = args(0);
             double s1yc     = args(1);
             double s1rx     = args(2);
@@ -1839,10 +1988,10 @@ namespace scopi
                          * std::sqrt(std::pow(M00 * A1 + M01 * A2, 2) + std::pow(M10 * A1 + M11 * A2, 2));
             return res;
         };
-        auto newton_GradF = [](auto u, auto args)
+        auto newton_GradF = [](const auto& u, const auto& args)
         {
-            double b1       = u(0);
-            double a2       = u(1);
+            double b1       = u[0];
+            double a2       = u[1];
             double s1xc     = args(0);
             double s1yc     = args(1);
             double s1rx     = args(2);
@@ -1915,7 +2064,7 @@ namespace scopi
         auto indmin = xt::from_indices(xt::where(xt::equal(dinit, dmin)));
         // std::cout << "initialization : indmin = " << indmin << std::endl;
         // std::cout << "initialization : imin = " << indmin(0,0) << " jmin = " << indmin(1,0) << std::endl;
-        xt::xtensor_fixed<double, xt::xshape<2>> u0 = {binit(indmin(0, 0)), ainit(indmin(1, 0))};
+        std::array<double, 2> u0 = {binit(indmin(0, 0)), ainit(indmin(1, 0))};
         // std::cout << "newton_GradF(u0,args) = " << newton_GradF(u0,args) << " newton_F(u0,args) = " << newton_F(u0,args) << std::endl;
         auto [u, info] = newton_method(u0, newton_F, newton_GradF, args, 200, 1.0e-10, 1.0e-7);
         // std::cout << "info = " << info << std::endl;
@@ -1928,8 +2077,8 @@ namespace scopi
             std::cout << "s1.pos = " << s1.pos() << " s1.rotation = " << xt::flatten(s1.rotation()) << std::endl;
             std::cout << "d2.pos = " << d2.pos() << " d2.rotation = " << xt::flatten(d2.rotation()) << std::endl;
         }
-        neigh.pi  = s1.point(u(0));
-        neigh.pj  = d2.point(u(1));
+        neigh.pi  = s1.point(u[0]);
+        neigh.pj  = d2.point(u[1]);
         neigh.nij = d2.normal();
         neigh.dij = xt::linalg::dot(neigh.pi - neigh.pj, neigh.nij)[0];
         return neigh;
@@ -1957,6 +2106,24 @@ namespace scopi
         return neigh;
     }
 
+    /**
+     * @brief Neighbor between two objects whose closest points are not computed by an iterative method.
+     *
+     * The starting point is ignored.
+     *
+     * @tparam T1 Type of the first object.
+     * @tparam T2 Type of the second object.
+     * @param obj1 [in] First object.
+     * @param obj2 [in] Second object.
+     *
+     * @return Neighbor struct for contact between \c obj1 and \c obj2.
+     */
+    template <class problem_t, class T1, class T2>
+    auto closest_points(const T1& obj1, const T2& obj2, const surface_parameters*)
+    {
+        return closest_points<problem_t>(obj1, obj2);
+    }
+
     /**
      * @brief
      *
@@ -2010,6 +2177,23 @@ namespace scopi
             return closest_points<problem_t>(obj1, obj2, i1, i2);
         }
 
+        /**
+         * @brief Closest points with a starting point for the iterative methods.
+         *
+         * @tparam T1 Type of the first object.
+         * @tparam T2 Type of the second object.
+         * @param obj1 [in] First object.
+         * @param obj2 [in] Second object.
+         * @param guess [in] Parameters of the closest points at the previous time step, can be null.
+         *
+         * @return Neighbor struct for contact between \c obj1 and \c obj2.
+         */
+        template <class T1, class T2>
+        return_type run(const T1& obj1, const T2& obj2, const surface_parameters* guess) const
+        {
+            return closest_points<problem_t>(obj1, obj2, guess);
+        }
+
         /**
          * @brief
          *
@@ -2024,6 +2208,14 @@ namespace scopi
         {
             return {};
         }
+
+        /**
+         * @brief Error with a starting point, see on_error.
+         */
+        return_type on_error(const object<dim, false>&, const object<dim, false>&, const surface_parameters*) const
+        {
+            return {};
+        }
     };
 
     /**
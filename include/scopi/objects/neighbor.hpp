@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <xtensor/xfixed.hpp>
 #include <xtensor/xio.hpp>
 
@@ -12,6 +14,25 @@
 namespace scopi
 {
 
+    /**
+     * @brief Parameters of the closest points on the surfaces of two particles.
+     *
+     * They are the angles found by the Newton method of closest_points between two superellipsoids: one angle per surface in 2D, two
+     * angles per surface in 3D. They are used as starting point when the same pair is computed again at the next time step.
+     * With superellipsoid_method::gjk, they are the coordinates of the normal, used as first search direction.
+     */
+    struct surface_parameters
+    {
+        /**
+         * @brief Angles of the closest point on the surface of \c i, then on the surface of \c j.
+         */
+        std::array<double, 4> u{};
+        /**
+         * @brief Whether the angles have been computed.
+         */
+        bool valid{false};
+    };
+
     /**
      * @brief Structure of a neighbor.
      *
@@ -52,6 +73,15 @@ namespace scopi
          * @brief The s for contact \c i \c j in fixed point algorithm
          */
         double sij;
+        /**
+         * @brief Parameters of the closest points, set by closest_points between two superellipsoids.
+         */
+        surface_parameters u;
+        /**
+         * @brief Force of the contact found by the optimization solver (Lagrange multiplier in the global frame), zero for a new
+         * contact. It is the starting point of the solver at the next time step.
+         */
+        std::array<double, dim> lambda{};
 
         contact_property<problem_t> property;
 
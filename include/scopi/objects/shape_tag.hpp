@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../types.hpp"
+#include "dispatch.hpp"
+#include "types/plane.hpp"
+#include "types/segment.hpp"
+#include "types/sphere.hpp"
+#include "types/superellipsoid.hpp"
+#include "types/worm.hpp"
+
+namespace scopi
+{
+    /**
+     * @brief Types of the shapes known by the tag dispatch.
+     *
+     * The tag of a shape is its position in this list (see dispatch_tag in unit_static_dispatcher and double_static_dispatcher).
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    using shape_types = mpl::
+        vector<sphere<dim, false>, superellipsoid<dim, false>, worm<dim, false>, plane<dim, false>, segment<dim, false>>;
+
+    /**
+     * @brief Compact tag of the type of a shape.
+     */
+    using shape_tag_t = std::uint8_t;
+
+    /**
+     * @brief Tag of a type of shape.
+     *
+     * @tparam T Type of the shape (for instance <tt>sphere<dim, false></tt>).
+     */
+    template <class T>
+    constexpr shape_tag_t shape_tag_v = static_cast<shape_tag_t>(detail::type_position<T, shape_types<T::dim>>::value);
+
+    /**
+     * @brief Tag of the shapes which are not in shape_types.
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    constexpr shape_tag_t unknown_shape_tag_v = static_cast<shape_tag_t>(detail::type_list_size<shape_types<dim>>::value);
+
+    namespace detail
+    {
+        template <std::size_t dim>
+        shape_tag_t shape_tag_impl(const object<dim, false>&, mpl::vector<>)
+        {
+            return unknown_shape_tag_v<dim>;
+        }
+
+        template <std::size_t dim, class T, class... U>
+        shape_tag_t shape_tag_impl(const object<dim, false>& obj, mpl::vector<T, U...>)
+        {
+            if (dynamic_cast<const T*>(&obj))
+            {
+                return shape_tag_v<T>;
+            }
+            return shape_tag_impl(obj, mpl::vector<U...>());
+        }
+
+        template <class T, std::size_t dim, class Func>
+        auto visit_view_as(const object<dim, false>& prototype, type::position_t<dim>* pos, type::quaternion_t* q, Func& f)
+        {
+            T view(static_cast<const T&>(prototype));
+            view.internal_pos() = pos;
+            view.internal_q()   = q;
+            return f(static_cast<const object<dim, false>&>(view), shape_tag_v<T>);
+        }
+
+        template <std::size_t dim, class Func, class... T>
+        auto visit_view_impl(mpl::vector<T...>,
+                             shape_tag_t tag,
+                             const object<dim, false>& prototype,
+                             type::position_t<dim>* pos,
+                             type::quaternion_t* q,
+                             Func& f)
+        {
+            using return_type   = std::invoke_result_t<Func&, const object<dim, false>&, shape_tag_t>;
+            using position_type = type::position_t<dim>;
+            using function_type = return_type (*)(const object<dim, false>&, position_type*, type::quaternion_t*, Func&);
+
+            static constexpr function_type table[] = {&visit_view_as<T, dim, Func>...};
+            return table[tag](prototype, pos, q, f);
+        }
+    }
+
+    /**
+     * @brief Tag of an object.
+     *
+     * The type is found with \c dynamic_cast, so the tag should be computed once and stored.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param obj [in] Object.
+     *
+     * @return Tag of the object, unknown_shape_tag_v if its type is not in shape_types.
+     */
+    template <std::size_t dim>
+    shape_tag_t shape_tag(const object<dim, false>& obj)
+    {
+        return detail::shape_tag_impl(obj, shape_types<dim>());
+    }
+
+    /**
+     * @brief Call a function with a view on the stack.
+     *
+     * The view is a copy of \c prototype, of the type given by \c tag, that points to \c pos and \c q. The function is called with the
+     * view and its tag, and the view is destroyed when it returns. No memory is allocated.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam Func Type of the function, with signature \c R(const object<dim, false>&, shape_tag_t).
+     * @param tag [in] Tag of the prototype, smaller than unknown_shape_tag_v.
+     * @param prototype [in] Object with the parameters of the shape (radius, ...).
+     * @param pos [in] Positions of the view.
+     * @param q [in] Quaternions of the view.
+     * @param f [in] Function.
+     *
+     * @return Result of the function.
+     */
+    template <std::size_t dim, class Func>
+    auto visit_view(shape_tag_t tag, const object<dim, false>& prototype, type::position_t<dim>* pos, type::quaternion_t* q, Func&& f)
+    {
+        return detail::visit_view_impl(shape_types<dim>(), tag, prototype, pos, q, f);
+    }
+}
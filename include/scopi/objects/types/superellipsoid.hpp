@@ -147,6 +147,18 @@ namespace scopi
          * @return (x, y, z) coordinates of two vectors in the tangent plane.
          */
         auto tangents(double a, double b) const; // dim = 3
+        /**
+         * @brief Get the support point of the superellipsoid in a direction.
+         *
+         * The support point is the point of the superellipsoid farthest in the direction. In the frame of the superellipsoid, it has a
+         * closed form: the superellipsoid is the unit ball of an \f$ \ell^{2 / e_0} \f$ norm (nested with an \f$ \ell^{2 / e_1} \f$
+         * norm in 3D) scaled by the radiuses. The squareness must be in \f$ (0, 2) \f$, where the superellipsoid is convex.
+         *
+         * @param direction [in] Direction in the frame of the superellipsoid (see rotation).
+         *
+         * @return Coordinates of the support point in the frame of the superellipsoid.
+         */
+        type::position_t<dim> support(const type::position_t<dim>& direction) const;
         /**
          * @brief Return a regular angle b distribution, used to initialize newton method.
          *
@@ -355,6 +367,60 @@ namespace scopi
         return std::make_pair(tgt1, tgt2);
     }
 
+    namespace detail
+    {
+        /**
+         * @brief Point \f$ y \f$ of the unit ball of the \f$ \ell^{2 / e} \f$ norm in 2D which maximizes \f$ c \cdot y \f$.
+         *
+         * @param c0 [in] First coordinate of \f$ c \f$.
+         * @param c1 [in] Second coordinate of \f$ c \f$.
+         * @param e [in] Squareness, in \f$ (0, 2) \f$.
+         * @param y0 [out] First coordinate of \f$ y \f$.
+         * @param y1 [out] Second coordinate of \f$ y \f$.
+         *
+         * @return Maximum of \f$ c \cdot y \f$, the dual norm of \f$ c \f$.
+         */
+        inline double lp_ball_support(double c0, double c1, double e, double& y0, double& y1)
+        {
+            const double m = std::max(std::abs(c0), std::abs(c1));
+            if (m == 0.)
+            {
+                y0 = 0.;
+                y1 = 0.;
+                return 0.;
+            }
+            // exponent of the dual norm, 1 / q + e / 2 = 1
+            const double q    = 2. / (2. - e);
+            const double a0   = std::abs(c0) / m;
+            const double a1   = std::abs(c1) / m;
+            const double norm = std::pow(std::pow(a0, q) + std::pow(a1, q), 1. / q);
+            y0                = sign(c0) * std::pow(a0 / norm, q - 1.);
+            y1                = sign(c1) * std::pow(a1 / norm, q - 1.);
+            return m * norm;
+        }
+    }
+
+    template <std::size_t dim, bool owner>
+    type::position_t<dim> superellipsoid<dim, owner>::support(const type::position_t<dim>& direction) const
+    {
+        type::position_t<dim> pt;
+        const double c =
+            detail::lp_ball_support(m_radius(0) * direction(0), m_radius(1) * direction(1), m_squareness(0), pt(0), pt(1));
+        if constexpr (dim == 3)
+        {
+            // the plane (x, y) and the axis z are balanced by the second squareness
+            double rho = 0.;
+            detail::lp_ball_support(c, m_radius(2) * direction(2), m_squareness(1), rho, pt(2));
+            pt(0) *= rho;
+            pt(1) *= rho;
+        }
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            pt(d) *= m_radius(d);
+        }
+        return pt;
+    }
+
     // return a regular angle b distribution, used to initialize newton method
     template <std::size_t dim, bool owner>
     std::vector<double> superellipsoid<dim, owner>::binit_xy(int n) const
@@ -10,6 +10,7 @@
 #include <plog/Log.h>
 
 #include "contact/property.hpp"
+#include "space_filling_curve.hpp"
 #include "utils.hpp"
 
 namespace scopi
@@ -124,6 +125,21 @@ namespace scopi
          * Default value is false.
          */
         bool binary_output;
+        /**
+         * @brief Frequency to sort the particles along a space-filling curve (see scopi_container::reorder).
+         *
+         * The particles are sorted at the beginning of the iterations that are a multiple of \c reorder_frequency.
+         * If \c reorder_frequency is <tt> std::size_t(-1) </tt>, then the particles are never sorted.
+         * Default value is <tt> std::size_t(-1) </tt>.
+         * \note \c reorder_frequency > 0
+         */
+        std::size_t reorder_frequency;
+        /**
+         * @brief Space-filling curve used to sort the particles.
+         *
+         * Default value is space_filling_curve::hilbert.
+         */
+        space_filling_curve reorder_curve;
     };
 
     /**
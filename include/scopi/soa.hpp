@@ -0,0 +1,698 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <xtensor/xfixed.hpp>
+#include <xtensor/xjson.hpp>
+
+namespace nl = nlohmann;
+
+namespace scopi
+{
+    namespace detail
+    {
+        /**
+         * @brief Type of an element of a soa_array.
+         *
+         * Scalar if there is one column, vector otherwise (as type::rotation_t and type::moment_t in 2D and 3D).
+         *
+         * @tparam N Number of columns.
+         */
+        template <std::size_t N>
+        using soa_value_t = std::conditional_t<N == 1, double, xt::xtensor_fixed<double, xt::xshape<N>>>;
+
+        /**
+         * @brief Deleter of the aligned memory of a soa_array.
+         */
+        struct soa_deleter
+        {
+            void operator()(double* data) const
+            {
+                ::operator delete[](data, std::align_val_t(64));
+            }
+        };
+    }
+
+    ///////////////////////////////
+    // soa_reference definition //
+    ///////////////////////////////
+    /**
+     * @brief Reference to an element of a soa_array.
+     *
+     * The \c N components of the element are in \c N columns, so they are not contiguous. The reference behaves as the
+     * \c xtensor_fixed it replaces for the accesses of the container: components are read and written with \c (d) or \c [d], an
+     * expression (or another reference) is assigned component by component, and it is converted to an \c xtensor_fixed by value()
+     * or implicitly. The arithmetic operators with a reference give \c xtensor expressions of this copy.
+     *
+     * @tparam N Number of components.
+     * @tparam is_const Whether the components are read-only.
+     */
+    template <std::size_t N, bool is_const>
+    class soa_reference
+    {
+      public:
+
+        /**
+         * @brief Alias for the type of the element.
+         */
+        using value_type = detail::soa_value_t<N>;
+        /**
+         * @brief Alias for the type of a pointer to a component.
+         */
+        using pointer = std::conditional_t<is_const, const double*, double*>;
+        /**
+         * @brief Alias for the type of a reference to a component.
+         */
+        using reference = std::conditional_t<is_const, const double&, double&>;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param data [in] Pointer to the first component.
+         * @param stride [in] Distance between two components (capacity of the soa_array).
+         */
+        soa_reference(pointer data, std::size_t stride);
+        soa_reference(const soa_reference&) = default;
+
+        /**
+         * @brief Component \c d of the element.
+         *
+         * @param d [in] Index of the component.
+         */
+        reference operator()(std::size_t d) const;
+        /**
+         * @brief Component \c d of the element.
+         *
+         * @param d [in] Index of the component.
+         */
+        reference operator[](std::size_t d) const;
+        /**
+         * @brief Number of components.
+         */
+        static constexpr std::size_t size();
+
+        /**
+         * @brief Copy of the element.
+         */
+        value_type value() const;
+        /**
+         * @brief Copy of the element.
+         */
+        operator value_type() const;
+
+        /**
+         * @brief Copy the components of another element.
+         */
+        soa_reference& operator=(const soa_reference& rhs);
+        /**
+         * @brief Copy the components of an expression of size \c N.
+         *
+         * @tparam E Type of the expression, whose components are accessed with \c (d).
+         */
+        template <class E>
+        soa_reference& operator=(const E& e);
+        /**
+         * @brief Copy a list of \c N components.
+         */
+        soa_reference& operator=(std::initializer_list<double> list);
+        /**
+         * @brief Set all the components to a scalar.
+         */
+        soa_reference& operator=(double a);
+        template <class E>
+        soa_reference& operator+=(const E& e);
+        template <class E>
+        soa_reference& operator-=(const E& e);
+        soa_reference& operator*=(double a);
+        soa_reference& operator/=(double a);
+
+      private:
+
+        /**
+         * @brief Pointer to the first component.
+         */
+        pointer m_data;
+        /**
+         * @brief Distance between two components.
+         */
+        std::size_t m_stride;
+    };
+
+    template <std::size_t N, bool is_const>
+    inline soa_reference<N, is_const>::soa_reference(pointer data, std::size_t stride)
+        : m_data(data)
+        , m_stride(stride)
+    {
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator()(std::size_t d) const -> reference
+    {
+        return m_data[d * m_stride];
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator[](std::size_t d) const -> reference
+    {
+        return m_data[d * m_stride];
+    }
+
+    template <std::size_t N, bool is_const>
+    constexpr std::size_t soa_reference<N, is_const>::size()
+    {
+        return N;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::value() const -> value_type
+    {
+        value_type out;
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            out(d) = (*this)(d);
+        }
+        return out;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline soa_reference<N, is_const>::operator value_type() const
+    {
+        return value();
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator=(const soa_reference& rhs) -> soa_reference&
+    {
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            (*this)(d) = rhs(d);
+        }
+        return *this;
+    }
+
+    template <std::size_t N, bool is_const>
+    template <class E>
+    inline auto soa_reference<N, is_const>::operator=(const E& e) -> soa_reference&
+    {
+        // the expression is copied first, it may use the components of this element
+        value_type tmp;
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            tmp(d) = e(d);
+        }
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            (*this)(d) = tmp(d);
+        }
+        return *this;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator=(std::initializer_list<double> list) -> soa_reference&
+    {
+        std::size_t d = 0;
+        for (double a : list)
+        {
+            (*this)(d++) = a;
+        }
+        return *this;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator=(double a) -> soa_reference&
+    {
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            (*this)(d) = a;
+        }
+        return *this;
+    }
+
+    template <std::size_t N, bool is_const>
+    template <class E>
+    inline auto soa_reference<N, is_const>::operator+=(const E& e) -> soa_reference&
+    {
+        value_type tmp = value();
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            tmp(d) += e(d);
+        }
+        return *this = tmp;
+    }
+
+    template <std::size_t N, bool is_const>
+    template <class E>
+    inline auto soa_reference<N, is_const>::operator-=(const E& e) -> soa_reference&
+    {
+        value_type tmp = value();
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            tmp(d) -= e(d);
+        }
+        return *this = tmp;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator*=(double a) -> soa_reference&
+    {
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            (*this)(d) *= a;
+        }
+        return *this;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_reference<N, is_const>::operator/=(double a) -> soa_reference&
+    {
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            (*this)(d) /= a;
+        }
+        return *this;
+    }
+
+    namespace detail
+    {
+        template <class T>
+        struct is_soa_reference : std::false_type
+        {
+        };
+
+        template <std::size_t N, bool is_const>
+        struct is_soa_reference<soa_reference<N, is_const>> : std::true_type
+        {
+        };
+
+        /**
+         * @brief Whether one of the operands is a soa_reference.
+         */
+        template <class... E>
+        constexpr bool has_soa_reference_v = std::disjunction_v<is_soa_reference<std::decay_t<E>>...>;
+
+        /**
+         * @brief Operand of an arithmetic operator: a soa_reference is replaced by its value, the other operands are forwarded.
+         */
+        template <class E>
+        inline decltype(auto) soa_operand(E&& e)
+        {
+            if constexpr (is_soa_reference<std::decay_t<E>>::value)
+            {
+                return e.value();
+            }
+            else
+            {
+                return std::forward<E>(e);
+            }
+        }
+    }
+
+    /**
+     * @name Arithmetic operators
+     *
+     * An expression with a soa_reference is the expression with the \c xtensor_fixed copy of the element, so \c v()(i) - a with
+     * \c a an \c xtensor expression is an \c xtensor expression, as with the arrays of \c xtensor_fixed the soa_array replaces.
+     */
+    ///@{
+    template <class E, class = std::enable_if_t<detail::has_soa_reference_v<E>>>
+    inline auto operator-(E&& e)
+    {
+        return -detail::soa_operand(std::forward<E>(e));
+    }
+
+    template <class E1, class E2, class = std::enable_if_t<detail::has_soa_reference_v<E1, E2>>>
+    inline auto operator+(E1&& e1, E2&& e2)
+    {
+        return detail::soa_operand(std::forward<E1>(e1)) + detail::soa_operand(std::forward<E2>(e2));
+    }
+
+    template <class E1, class E2, class = std::enable_if_t<detail::has_soa_reference_v<E1, E2>>>
+    inline auto operator-(E1&& e1, E2&& e2)
+    {
+        return detail::soa_operand(std::forward<E1>(e1)) - detail::soa_operand(std::forward<E2>(e2));
+    }
+
+    template <class E1, class E2, class = std::enable_if_t<detail::has_soa_reference_v<E1, E2>>>
+    inline auto operator*(E1&& e1, E2&& e2)
+    {
+        return detail::soa_operand(std::forward<E1>(e1)) * detail::soa_operand(std::forward<E2>(e2));
+    }
+
+    template <class E1, class E2, class = std::enable_if_t<detail::has_soa_reference_v<E1, E2>>>
+    inline auto operator/(E1&& e1, E2&& e2)
+    {
+        return detail::soa_operand(std::forward<E1>(e1)) / detail::soa_operand(std::forward<E2>(e2));
+    }
+    ///@}
+
+    /**
+     * @brief Write an element of a soa_array in json format, as the \c xtensor_fixed it replaces.
+     */
+    template <std::size_t N, bool is_const>
+    void to_json(nl::json& j, const soa_reference<N, is_const>& r)
+    {
+        j = r.value();
+    }
+
+    //////////////////////////
+    // soa_view definition //
+    //////////////////////////
+    /**
+     * @brief Accessor of a soa_array.
+     *
+     * Returned by the accessors of scopi_container (scopi_container::v(), scopi_container::f(),...). As the adaptors of arrays of
+     * \c xtensor_fixed they replace, \c (i) or \c [i] is the element \c i: a \c double if there is one column, a soa_reference
+     * otherwise. The columns are also available as pointers, for the loops that update all the particles.
+     *
+     * @tparam N Number of columns.
+     * @tparam is_const Whether the elements are read-only.
+     */
+    template <std::size_t N, bool is_const>
+    class soa_view
+    {
+      public:
+
+        /**
+         * @brief Alias for the type of a pointer to a column.
+         */
+        using pointer = std::conditional_t<is_const, const double*, double*>;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param data [in] Pointer to the first column.
+         * @param size [in] Number of elements.
+         * @param stride [in] Distance between two columns.
+         */
+        soa_view(pointer data, std::size_t size, std::size_t stride);
+
+        /**
+         * @brief Element \c i.
+         *
+         * @param i [in] Index of the element.
+         */
+        decltype(auto) operator()(std::size_t i) const;
+        /**
+         * @brief Element \c i.
+         *
+         * @param i [in] Index of the element.
+         */
+        decltype(auto) operator[](std::size_t i) const;
+        /**
+         * @brief Number of elements.
+         */
+        std::size_t size() const;
+        /**
+         * @brief Column \c d, aligned on 64 bytes.
+         *
+         * @param d [in] Index of the column.
+         */
+        pointer column(std::size_t d) const;
+
+      private:
+
+        /**
+         * @brief Pointer to the first column.
+         */
+        pointer m_data;
+        /**
+         * @brief Number of elements.
+         */
+        std::size_t m_size;
+        /**
+         * @brief Distance between two columns.
+         */
+        std::size_t m_stride;
+    };
+
+    template <std::size_t N, bool is_const>
+    inline soa_view<N, is_const>::soa_view(pointer data, std::size_t size, std::size_t stride)
+        : m_data(data)
+        , m_size(size)
+        , m_stride(stride)
+    {
+    }
+
+    template <std::size_t N, bool is_const>
+    inline decltype(auto) soa_view<N, is_const>::operator()(std::size_t i) const
+    {
+        if constexpr (N == 1)
+        {
+            return static_cast<std::conditional_t<is_const, const double&, double&>>(m_data[i]);
+        }
+        else
+        {
+            return soa_reference<N, is_const>(m_data + i, m_stride);
+        }
+    }
+
+    template <std::size_t N, bool is_const>
+    inline decltype(auto) soa_view<N, is_const>::operator[](std::size_t i) const
+    {
+        return (*this)(i);
+    }
+
+    template <std::size_t N, bool is_const>
+    inline std::size_t soa_view<N, is_const>::size() const
+    {
+        return m_size;
+    }
+
+    template <std::size_t N, bool is_const>
+    inline auto soa_view<N, is_const>::column(std::size_t d) const -> pointer
+    {
+        return m_data + d * m_stride;
+    }
+
+    ////////////////////////////
+    // soa_array definition //
+    ////////////////////////////
+    /**
+     * @brief Array of elements of \c N doubles stored in structure of arrays.
+     *
+     * The component \c d of all the elements are contiguous (column \c d) and each column is aligned on 64 bytes, so the loops on
+     * the elements are vectorized. The capacity is rounded up to a multiple of 8 elements, which keeps all the columns aligned.
+     *
+     * @tparam N Number of components of an element.
+     */
+    template <std::size_t N>
+    class soa_array
+    {
+      public:
+
+        /**
+         * @brief Alias for the type of an element.
+         */
+        using value_type = detail::soa_value_t<N>;
+
+        soa_array() = default;
+        soa_array(const soa_array& rhs);
+        soa_array& operator=(const soa_array& rhs);
+        soa_array(soa_array&& rhs) noexcept;
+        soa_array& operator=(soa_array&& rhs) noexcept;
+
+        /**
+         * @brief Appends an element.
+         *
+         * @tparam V Type of the element, a \c double if \c N = 1, accessed with \c (d) otherwise.
+         * @param v [in] Element.
+         */
+        template <class V>
+        void push_back(const V& v);
+        /**
+         * @brief Increase the capacity of the array.
+         *
+         * @param size [in] New capacity of the array.
+         */
+        void reserve(std::size_t size);
+        /**
+         * @brief Change the number of elements, the new elements are zero.
+         *
+         * @param size [in] New number of elements.
+         */
+        void resize(std::size_t size);
+        /**
+         * @brief Number of elements.
+         */
+        std::size_t size() const;
+        /**
+         * @brief Reorder the elements.
+         *
+         * @param new_to_old [in] Permutation of the elements: the element \c k is the element \c new_to_old[k] before the call.
+         */
+        void permute(const std::vector<std::size_t>& new_to_old);
+
+        /**
+         * @brief Accessor of the elements.
+         */
+        soa_view<N, true> view() const;
+        /**
+         * @brief Accessor of the elements.
+         */
+        soa_view<N, false> view();
+
+      private:
+
+        /**
+         * @brief Reallocate the columns.
+         *
+         * @param capacity [in] New capacity, multiple of 8.
+         */
+        void reallocate(std::size_t capacity);
+
+        /**
+         * @brief Columns, one after the other.
+         */
+        std::unique_ptr<double[], detail::soa_deleter> m_data;
+        /**
+         * @brief Number of elements.
+         */
+        std::size_t m_size{0};
+        /**
+         * @brief Capacity of a column.
+         */
+        std::size_t m_capacity{0};
+    };
+
+    template <std::size_t N>
+    soa_array<N>::soa_array(const soa_array& rhs)
+    {
+        *this = rhs;
+    }
+
+    template <std::size_t N>
+    auto soa_array<N>::operator=(const soa_array& rhs) -> soa_array&
+    {
+        if (this != &rhs)
+        {
+            m_size = 0;
+            reserve(rhs.m_size);
+            m_size = rhs.m_size;
+            for (std::size_t d = 0; d < N; ++d)
+            {
+                std::copy_n(rhs.m_data.get() + d * rhs.m_capacity, m_size, m_data.get() + d * m_capacity);
+            }
+        }
+        return *this;
+    }
+
+    // the moved-from array is left empty, so it can be filled again
+    template <std::size_t N>
+    soa_array<N>::soa_array(soa_array&& rhs) noexcept
+        : m_data(std::move(rhs.m_data))
+        , m_size(std::exchange(rhs.m_size, 0))
+        , m_capacity(std::exchange(rhs.m_capacity, 0))
+    {
+    }
+
+    template <std::size_t N>
+    auto soa_array<N>::operator=(soa_array&& rhs) noexcept -> soa_array&
+    {
+        if (this != &rhs)
+        {
+            m_data     = std::move(rhs.m_data);
+            m_size     = std::exchange(rhs.m_size, 0);
+            m_capacity = std::exchange(rhs.m_capacity, 0);
+        }
+        return *this;
+    }
+
+    template <std::size_t N>
+    template <class V>
+    void soa_array<N>::push_back(const V& v)
+    {
+        if (m_size == m_capacity)
+        {
+            reallocate(std::max<std::size_t>(8, 2 * m_capacity));
+        }
+        if constexpr (N == 1)
+        {
+            m_data[m_size] = v;
+        }
+        else
+        {
+            for (std::size_t d = 0; d < N; ++d)
+            {
+                m_data[d * m_capacity + m_size] = v(d);
+            }
+        }
+        ++m_size;
+    }
+
+    template <std::size_t N>
+    void soa_array<N>::reserve(std::size_t size)
+    {
+        if (size > m_capacity)
+        {
+            reallocate((size + 7) / 8 * 8);
+        }
+    }
+
+    template <std::size_t N>
+    void soa_array<N>::resize(std::size_t size)
+    {
+        reserve(size);
+        if (size > m_size)
+        {
+            for (std::size_t d = 0; d < N; ++d)
+            {
+                std::fill(m_data.get() + d * m_capacity + m_size, m_data.get() + d * m_capacity + size, 0.);
+            }
+        }
+        m_size = size;
+    }
+
+    template <std::size_t N>
+    inline std::size_t soa_array<N>::size() const
+    {
+        return m_size;
+    }
+
+    template <std::size_t N>
+    void soa_array<N>::permute(const std::vector<std::size_t>& new_to_old)
+    {
+        std::unique_ptr<double[], detail::soa_deleter> data(new (std::align_val_t(64)) double[N * m_capacity]);
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            const double* in = m_data.get() + d * m_capacity;
+            double* out      = data.get() + d * m_capacity;
+            for (std::size_t k = 0; k < m_size; ++k)
+            {
+                out[k] = in[new_to_old[k]];
+            }
+        }
+        m_data = std::move(data);
+    }
+
+    template <std::size_t N>
+    inline soa_view<N, true> soa_array<N>::view() const
+    {
+        return {m_data.get(), m_size, m_capacity};
+    }
+
+    template <std::size_t N>
+    inline soa_view<N, false> soa_array<N>::view()
+    {
+        return {m_data.get(), m_size, m_capacity};
+    }
+
+    template <std::size_t N>
+    void soa_array<N>::reallocate(std::size_t capacity)
+    {
+        std::unique_ptr<double[], detail::soa_deleter> data(new (std::align_val_t(64)) double[N * capacity]);
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            std::copy_n(m_data.get() + d * m_capacity, m_size, data.get() + d * capacity);
+        }
+        m_data     = std::move(data);
+        m_capacity = capacity;
+    }
+}
@@ -6,6 +6,7 @@
 #include <functional>
 #include <iostream>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <CLI/CLI.hpp>
@@ -24,12 +25,17 @@
 #include "objects/methods/write_objects.hpp"
 #include "objects/neighbor.hpp"
 #include "quaternion.hpp"
+#include "sphere_container.hpp"
 
+#include "contact/contact_bvh.hpp"
+#include "contact/contact_cell_list.hpp"
 #include "contact/contact_kdtree.hpp"
+#include "contact/contact_sweep_and_prune.hpp"
 #include "contact/property.hpp"
 #include "params.hpp"
 #include "solvers/OptimGradient.hpp"
 #include "solvers/apgd.hpp"
+#include "solvers/pgs.hpp"
 #include "vap/vap_fixed.hpp"
 
 namespace nl = nlohmann;
@@ -44,19 +50,19 @@ namespace scopi
      * In 2D, the rotation velocity is a scalar, whereas in 3D it is a vector.
      * Therefore, the way to update it in the container is different.
      *
-     * @tparam dim Dimension (2 or 3).
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
      * @param particles [out] Container whose field \c omega is updated.
      * @param i [in] Index of the particle to update.
      * @param wadapt [in] \f$N \times 3\f$ array that contains the new velocity, where \f$N\f$ is the total number of particles.
      */
-    template <std::size_t dim, class xt_container>
-    inline std::enable_if_t<dim == 2, void> update_velocity_omega(scopi_container<dim>& particles, std::size_t i, const xt_container& wadapt)
+    template <class particles_t, class xt_container>
+    inline std::enable_if_t<particles_t::dim == 2, void> update_velocity_omega(particles_t& particles, std::size_t i, const xt_container& wadapt)
     {
         particles.omega()(i + particles.nb_inactive()) = wadapt(i, 2);
     }
 
-    template <std::size_t dim, class xt_container>
-    inline std::enable_if_t<dim == 3, void> update_velocity_omega(scopi_container<dim>& particles, std::size_t i, const xt_container& wadapt)
+    template <class particles_t, class xt_container>
+    inline std::enable_if_t<particles_t::dim == 3, void> update_velocity_omega(particles_t& particles, std::size_t i, const xt_container& wadapt)
     {
         for (std::size_t d = 0; d < 3; ++d)
         {
@@ -74,6 +80,7 @@ namespace scopi
      * @tparam optim_solver_t Optimization solver (Mosek, Uzawa, ...)
      * @tparam contact_method_t Algorithm to search closest contacts (k-d tree, brute force, ...)
      * @tparam vap_t A priori velocity, problem dependant
+     * @tparam particle_container_t Array of particles: scopi_container, or sphere_container if there are only spheres and planes
      *
      * Solve the contact problem: at each time step
      *      - Move obstacles (particles with an imposed velocity);
@@ -92,7 +99,8 @@ namespace scopi
               class problem_type                         = NoFriction,
               class optim_solver_type                    = OptimGradient<apgd>,
               template <class> class contact_method_type = contact_kdtree,
-              class vap_type                             = vap_fixed>
+              class vap_type                             = vap_fixed,
+              class particle_container_type              = scopi_container<dim>>
     class ScopiSolver
     {
       public:
@@ -101,10 +109,10 @@ namespace scopi
         using optim_solver_t   = optim_solver_type;
         using contact_method_t = contact_method_type<problem_t>;
         using vap_t            = vap_type;
-        using params_t         = Params<ScopiSolver<dim, problem_t, optim_solver_t, contact_method_type, vap_t>>;
+        using params_t         = Params<ScopiSolver<dim, problem_t, optim_solver_t, contact_method_type, vap_t, particle_container_type>>;
 
         using contact_container_t  = std::vector<neighbor<dim, problem_t>>;
-        using particle_container_t = scopi_container<dim>;
+        using particle_container_t = particle_container_type;
 
         /**
          * @brief Constructor.
@@ -114,7 +122,7 @@ namespace scopi
          * @param dt Time step. It is fixed during the simulation.
          * @param params Parameters for the different steps of the algorithm.
          */
-        explicit ScopiSolver(const BoxDomain<dim>& box, scopi_container<dim>& particles);
+        explicit ScopiSolver(const BoxDomain<dim>& box, particle_container_t& particles);
 
         /**
          * @brief Constructor.
@@ -123,7 +131,7 @@ namespace scopi
          * @param dt Time step. It is fixed during the simulation.
          * @param params Parameters for the different steps of the algorithm.
          */
-        explicit ScopiSolver(scopi_container<dim>& particles);
+        explicit ScopiSolver(particle_container_t& particles);
 
         void init_options();
 
@@ -135,6 +143,30 @@ namespace scopi
          */
         void run(double dt, std::size_t total_it, std::size_t initial_iter = 0);
 
+        /**
+         * @brief Run the simulation, with a function called at the beginning of each iteration.
+         *
+         * The function can append particles to the container (see scopi_container::push_back) and remove particles with erase, for
+         * instance to model an inlet and an outlet.
+         *
+         * @tparam Func Type of the function, with signature \c void(std::size_t nite).
+         * @param total_it [in] Total number of iterations to perform.
+         * @param initial_iter [in] Initial index of iteration. Used for restart or to change external parameters.
+         * @param before_step [in] Function called with the index of the iteration.
+         */
+        template <class Func>
+        void run(double dt, std::size_t total_it, std::size_t initial_iter, Func&& before_step);
+
+        /**
+         * @brief Remove active objects from the container and from the contacts of the previous time step.
+         *
+         * The contacts of the removed particles are dropped and the other contacts are renumbered (see scopi_container::erase), so
+         * that their history is kept.
+         *
+         * @param objects [in] Indices of the objects to remove.
+         */
+        void erase(std::vector<std::size_t> objects);
+
         /**
          * @brief Return the current contacts of the simulation.
          *
@@ -151,6 +183,13 @@ namespace scopi
 
         void set_timestep(double dt);
 
+        /**
+         * @brief Sort the particles along a space-filling curve and renumber the contacts of the previous time step.
+         *
+         * See scopi_container::reorder and ScopiParams::reorder_frequency.
+         */
+        void reorder_particles();
+
         /**
          * @brief Move obstacles (particles with an imposed velocity).
          */
@@ -205,9 +244,14 @@ namespace scopi
         std::size_t m_current_save = 0;
     };
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::ScopiSolver(const BoxDomain<dim>& box,
-                                                                                      scopi_container<dim>& particles)
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::ScopiSolver(const BoxDomain<dim>& box,
+                                                                                                            particle_container_t& particles)
         : m_box(box)
         , m_particles(particles)
         , m_optim_solver()
@@ -217,8 +261,13 @@ namespace scopi
         init_options();
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::ScopiSolver(scopi_container<dim>& particles)
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::ScopiSolver(particle_container_t& particles)
         : m_particles(particles)
         , m_optim_solver()
         , m_contact_method()
@@ -253,18 +302,88 @@ namespace scopi
             if (auto search = indices.find({c.i, c.j}); search != indices.end())
             {
                 c.property = m_old_contacts[search->second].property;
+                c.lambda   = m_old_contacts[search->second].lambda;
             }
         }
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::set_timestep(double dt)
+    /**
+     * @brief Apply a permutation of the particles to contacts (see scopi_container::reorder and scopi_container::erase).
+     *
+     * A contact whose particles change order in the permutation is turned around, so that it keeps the orientation of the contacts
+     * computed at the next time step: \c i < \c j, or \c i > \c j for some contacts with a periodic image (see detail::add_neighbor).
+     * A contact with a removed particle is removed.
+     *
+     * @tparam Contacts Type of the array of contacts.
+     * @param perm [in] Permutation of the particles: the particle \c i is now the particle \c perm[i], <tt>std::size_t(-1)</tt> if
+     * it was removed.
+     * @param contacts [inout] Array of contacts.
+     */
+    template <class Contacts>
+    void renumber(const std::vector<std::size_t>& perm, Contacts& contacts)
+    {
+        contacts.erase(std::remove_if(contacts.begin(),
+                                      contacts.end(),
+                                      [&](const auto& c)
+                                      {
+                                          return perm[c.i] == std::size_t(-1) || perm[c.j] == std::size_t(-1);
+                                      }),
+                       contacts.end());
+        for (auto& c : contacts)
+        {
+            const bool ordered = c.i < c.j;
+            c.i                = perm[c.i];
+            c.j                = perm[c.j];
+            if ((c.i < c.j) != ordered)
+            {
+                std::swap(c.i, c.j);
+                std::swap(c.pi, c.pj);
+                c.nij *= -1.;
+                for (auto& l : c.lambda)
+                {
+                    l = -l;
+                }
+                // the parameters of the closest points are ordered as the particles
+                c.u.valid = false;
+            }
+        }
+    }
+
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::set_timestep(double dt)
     {
         m_dt = dt;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::run(double dt, std::size_t total_it, std::size_t initial_iter)
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::run(double dt,
+                                                                                                         std::size_t total_it,
+                                                                                                         std::size_t initial_iter)
+    {
+        run(dt, total_it, initial_iter, [](std::size_t) {});
+    }
+
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    template <class Func>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::run(double dt,
+                                                                                                         std::size_t total_it,
+                                                                                                         std::size_t initial_iter,
+                                                                                                         Func&& before_step)
     {
         // Time Loop
         write_output_files(m_old_contacts, initial_iter);
@@ -275,6 +394,11 @@ namespace scopi
         {
             PLOG_INFO << "\n\n------------------- Time iteration ----------------> " << nite;
 
+            before_step(nite);
+            if (m_params.reorder_frequency != std::size_t(-1) && nite % m_params.reorder_frequency == 0)
+            {
+                reorder_particles();
+            }
             displacement_obstacles();
             auto contacts = compute_contacts();
 
@@ -302,22 +426,37 @@ namespace scopi
         }
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::init_options()
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::init_options()
     {
         m_params.init_options();
         m_contact_method.init_options();
         m_optim_solver.init_options();
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    auto& ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::current_contacts()
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    auto& ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::current_contacts()
     {
         return m_old_contacts;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    auto ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::get_params() -> params_t
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    auto ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::get_params() -> params_t
     {
         return params_t(m_params,
                         m_optim_solver.get_params(),
@@ -326,8 +465,64 @@ namespace scopi
                         m_vap.get_params());
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::displacement_obstacles()
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::reorder_particles()
+    {
+        tic();
+        const auto perm = m_particles.reorder(m_params.reorder_curve);
+        renumber(perm, m_old_contacts);
+        m_contact_method.renumber(perm);
+        auto duration = toc();
+        PLOG_INFO << "----> CPUTIME : reorder particles = " << duration;
+    }
+
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::erase(std::vector<std::size_t> objects)
+    {
+        tic();
+        std::vector<std::size_t> ids(m_particles.nb_particles(false));
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            ids[i] = m_particles.particle_id(i);
+        }
+
+        // erasing the object i moves the last object into slot i: in descending order, the moved object has a larger index than
+        // i, so it is never one of the objects still to be erased and their indices stay valid
+        std::sort(objects.begin(), objects.end(), std::greater<std::size_t>());
+        objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+        for (std::size_t io : objects)
+        {
+            m_particles.erase(io);
+        }
+
+        std::vector<std::size_t> perm(ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            perm[i] = m_particles.particle_index(ids[i]);
+        }
+        renumber(perm, m_old_contacts);
+        m_contact_method.renumber(perm);
+        auto duration = toc();
+        PLOG_INFO << "----> CPUTIME : erase particles = " << duration;
+    }
+
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::displacement_obstacles()
     {
         tic();
         for (std::size_t i = 0; i < m_particles.nb_inactive(); ++i)
@@ -354,21 +549,46 @@ namespace scopi
         PLOG_INFO << "----> CPUTIME : obstacles = " << duration;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    auto ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::compute_contacts() -> contact_container_t
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    auto ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::compute_contacts()
+        -> contact_container_t
     {
         auto contacts = m_contact_method.run(m_box, m_particles, m_particles.nb_inactive());
-        for (std::size_t i = m_particles.object_index(m_particles.nb_inactive()); i < m_particles.size(); ++i)
+        // the spheres and the planes have no internal contacts
+        if constexpr (!is_sphere_container<particle_container_t>::value)
         {
-            add_contact_from_object_dispatcher<dim>::dispatch(*m_particles[i], m_particles.offset(i), contacts);
+            const std::size_t nb_inactive  = m_particles.nb_inactive();
+            const std::size_t first_active = nb_inactive < m_particles.nb_particles(false) ? m_particles.object_index(nb_inactive)
+                                                                                           : m_particles.size();
+            for (std::size_t i = first_active; i < m_particles.size(); ++i)
+            {
+                const std::size_t offset = m_particles.offset(i);
+                m_particles.visit_object(i,
+                                         [&](const object<dim, false>& obj, shape_tag_t tag)
+                                         {
+                                             using dispatcher_t = add_contact_from_object_dispatcher<dim>;
+                                             dispatcher_t::template dispatch_tag<shape_types<dim>>(tag, obj, offset, contacts);
+                                         });
+            }
         }
         PLOG_INFO << "contacts.size() = " << contacts.size() << std::endl;
         return contacts;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::write_output_files(const contact_container_t& contacts,
-                                                                                                  std::size_t nite)
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::write_output_files(
+        const contact_container_t& contacts,
+        std::size_t nite)
     {
         tic();
 
@@ -383,8 +603,22 @@ namespace scopi
 
         for (std::size_t i = 0; i < m_particles.size(); ++i)
         {
-            auto offset              = m_particles.offset(i);
-            nl::json object          = write_objects_dispatcher<dim>::dispatch(*m_particles[i], offset);
+            auto offset = m_particles.offset(i);
+            auto id     = m_particles.particle_id(offset);
+            nl::json object;
+            if constexpr (is_sphere_container<particle_container_t>::value)
+            {
+                object = write_objects(m_particles, offset);
+            }
+            else
+            {
+                object = m_particles.visit_object(i,
+                                                  [&](const scopi::object<dim, false>& obj, shape_tag_t tag)
+                                                  {
+                                                      using dispatcher_t = write_objects_dispatcher<dim>;
+                                                      return dispatcher_t::template dispatch_tag<shape_types<dim>>(tag, obj, id);
+                                                  });
+            }
             nl::json& prop           = object["properties"];
             prop["velocity"]         = m_particles.v()(offset);
             prop["desired_velocity"] = m_particles.vd()(offset);
@@ -409,7 +643,10 @@ namespace scopi
 
         for (const auto& c : contacts)
         {
-            json_output["contacts"].push_back(c.to_json());
+            nl::json contact = c.to_json();
+            contact["i"]     = m_particles.particle_id(c.i);
+            contact["j"]     = m_particles.particle_id(c.j);
+            json_output["contacts"].push_back(contact);
         }
 
         if (m_params.binary_output)
@@ -431,11 +668,29 @@ namespace scopi
         PLOG_INFO << "----> CPUTIME : write output files = " << duration;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::move_active_particles()
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::move_active_particles()
     {
         tic();
         std::size_t active_offset = m_particles.nb_inactive();
+        auto pos                  = m_particles.pos();
+        auto v                    = m_particles.v();
+        auto omega                = m_particles.omega();
+
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            const double* v_d = v.column(d);
+#pragma omp parallel for
+            for (std::size_t i = active_offset; i < active_offset + m_particles.nb_active(); ++i)
+            {
+                pos(i)(d) += m_dt * v_d[i];
+            }
+        }
 
 #pragma omp parallel for
         for (std::size_t i = 0; i < m_particles.nb_active(); ++i)
@@ -445,12 +700,12 @@ namespace scopi
 
             if constexpr (dim == 2)
             {
-                w     = {0, 0, m_particles.omega()(i + active_offset)};
-                normw = std::abs(m_particles.omega()(i + active_offset));
+                w     = {0, 0, omega(i + active_offset)};
+                normw = std::abs(omega(i + active_offset));
             }
             else
             {
-                w     = m_particles.omega()(i + active_offset);
+                w     = omega(i + active_offset).value();
                 normw = xt::linalg::norm(w);
             }
 
@@ -464,11 +719,6 @@ namespace scopi
             expw_adapt(0)                         = std::cos(0.5 * normw * m_dt);
             xt::view(expw_adapt, xt::range(1, _)) = std::sin(0.5 * normw * m_dt) / normw * w;
 
-            for (std::size_t d = 0; d < dim; ++d)
-            {
-                m_particles.pos()(i + active_offset)(d) += m_dt * m_particles.v()(i + active_offset)(d);
-            }
-
             m_particles.q()(i + active_offset) = mult_quaternion(m_particles.q()(i + active_offset), expw);
             normalize(m_particles.q()(i + active_offset));
         }
@@ -499,7 +749,7 @@ namespace scopi
                     {
                         for (std::size_t offset = m_particles.offset(io); offset < m_particles.offset(io + 1); ++offset)
                         {
-                            auto& p = m_particles.pos()[offset];
+                            auto&& p = m_particles.pos()[offset];
                             p[d] -= m_box.upper_bound(d) - m_box.lower_bound(d);
                         }
                     }
@@ -507,7 +757,7 @@ namespace scopi
                     {
                         for (std::size_t offset = m_particles.offset(io); offset < m_particles.offset(io + 1); ++offset)
                         {
-                            auto& p = m_particles.pos()[offset];
+                            auto&& p = m_particles.pos()[offset];
                             p[d] += m_box.upper_bound(d) - m_box.lower_bound(d);
                         }
                     }
@@ -518,21 +768,31 @@ namespace scopi
         PLOG_INFO << "----> CPUTIME : move active particles = " << duration;
     }
 
-    template <std::size_t dim, class problem_t, class optim_solver_t, template <class> class contact_method_t, class vap_t>
-    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t>::update_velocity()
+    template <std::size_t dim,
+              class problem_t,
+              class optim_solver_t,
+              template <class> class contact_method_t,
+              class vap_t,
+              class particle_container_t>
+    void ScopiSolver<dim, problem_t, optim_solver_t, contact_method_t, vap_t, particle_container_t>::update_velocity()
     {
         tic();
         std::size_t active_offset = m_particles.nb_inactive();
         auto uadapt               = m_optim_solver.get_uadapt();
         auto wadapt               = m_optim_solver.get_wadapt();
 
-#pragma omp parallel for
-        for (std::size_t i = 0; i < m_particles.nb_active(); ++i)
+        for (std::size_t d = 0; d < dim; ++d)
         {
-            for (std::size_t d = 0; d < dim; ++d)
+            double* v_d = m_particles.v().column(d) + active_offset;
+#pragma omp parallel for
+            for (std::size_t i = 0; i < m_particles.nb_active(); ++i)
             {
-                m_particles.v()(i + active_offset)(d) = uadapt(i, d);
+                v_d[i] = uadapt(i, d);
             }
+        }
+#pragma omp parallel for
+        for (std::size_t i = 0; i < m_particles.nb_active(); ++i)
+        {
             update_velocity_omega(m_particles, i, wadapt);
         }
         auto duration = toc();
@@ -107,14 +107,14 @@ namespace scopi
             }
         }
 
-        template <std::size_t dim, class problem_t>
-        void extra_steps_after_solve(std::vector<neighbor<dim, problem_t>>&, const scopi_container<dim>&)
+        template <std::size_t dim, class problem_t, class particles_t>
+        void extra_steps_after_solve(std::vector<neighbor<dim, problem_t>>&, const particles_t&)
         {
             m_should_solve = false;
         }
 
-        template <std::size_t dim>
-        void extra_steps_after_solve(std::vector<neighbor<dim, FrictionFixedPoint>>& contacts, const scopi_container<dim>& particles)
+        template <std::size_t dim, class particles_t>
+        void extra_steps_after_solve(std::vector<neighbor<dim, FrictionFixedPoint>>& contacts, const particles_t& particles)
         {
             if (contacts.size() != 0)
             {
@@ -174,8 +174,8 @@ namespace scopi
             }
         }
 
-        template <std::size_t dim>
-        void extra_steps_after_solve(std::vector<neighbor<dim, ViscousFriction>>& contacts, const scopi_container<dim>& particles)
+        template <std::size_t dim, class particles_t>
+        void extra_steps_after_solve(std::vector<neighbor<dim, ViscousFriction>>& contacts, const particles_t& particles)
         {
             if (contacts.size() != 0)
             {
@@ -249,8 +249,8 @@ namespace scopi
             }
         }
 
-        template <std::size_t dim, class problem_t>
-        void run(const scopi_container<dim>& particles, const std::vector<neighbor<dim, problem_t>>& contacts, std::size_t)
+        template <std::size_t dim, class problem_t, class particles_t>
+        void run(const particles_t& particles, const std::vector<neighbor<dim, problem_t>>& contacts, std::size_t)
         {
             tic();
             std::size_t active_offset = particles.nb_inactive();
@@ -262,7 +262,14 @@ namespace scopi
             {
                 auto min_p = make_minimization_problem<problem_t>(m_dt, contacts, particles);
 
-                m_lambda = m_method(min_p);
+                if (m_method.get_params().warm_start)
+                {
+                    m_lambda = m_method(min_p, min_p.initial_lambda(contacts));
+                }
+                else
+                {
+                    m_lambda = m_method(min_p);
+                }
 
                 auto velocities = min_p.velocities(m_lambda);
 
@@ -305,11 +312,20 @@ namespace scopi
             PLOG_INFO << "----> CPUTIME : solve OptimGradient = " << duration << std::endl;
         }
 
-        template <class Contacts>
-        void update_contact_properties(Contacts& contacts)
+        template <std::size_t dim, class problem_t>
+        void update_contact_properties(std::vector<neighbor<dim, problem_t>>& contacts)
         {
             if (contacts.size() != 0)
             {
+                // before the update of gamma, which changes the layout of the multipliers with viscosity
+                auto lambda_global = make_lagrange_multplier<dim, problem_t>(contacts, m_dt).local2global(m_lambda);
+                for (std::size_t i = 0; i < contacts.size(); ++i)
+                {
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        contacts[i].lambda[d] = lambda_global(3 * i + d);
+                    }
+                }
                 update_contact_properties_impl(m_dt, m_lambda, contacts);
             }
         }
@@ -329,6 +345,11 @@ namespace scopi
             return m_lambda;
         }
 
+        std::size_t nb_iterations() const
+        {
+            return m_method.nb_iterations();
+        }
+
         bool should_solve()
         {
             return m_should_solve;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include <CLI/CLI.hpp>
 
 #include <plog/Log.h>
@@ -17,6 +19,28 @@ namespace scopi
     template <class Problem, class Contacts, class Particles>
     class minimization_problem;
 
+    // |x - y|^2 without temporary
+    inline double squared_distance(const xt::xtensor<double, 1>& x, const xt::xtensor<double, 1>& y)
+    {
+        double out = 0.;
+        for (std::size_t k = 0; k < x.size(); ++k)
+        {
+            out += (x[k] - y[k]) * (x[k] - y[k]);
+        }
+        return out;
+    }
+
+    // g . (x - y) without temporary
+    inline double dot_difference(const xt::xtensor<double, 1>& g, const xt::xtensor<double, 1>& x, const xt::xtensor<double, 1>& y)
+    {
+        double out = 0.;
+        for (std::size_t k = 0; k < x.size(); ++k)
+        {
+            out += g[k] * (x[k] - y[k]);
+        }
+        return out;
+    }
+
     struct pgd_params
     {
         void init_options()
@@ -28,12 +52,17 @@ namespace scopi
                 opt->add_option("--pgd-alpha", alpha, "descent coefficient")->capture_default_str();
                 opt->add_option("--pgd-max-ite", max_ite, "Maximum number of iterations")->capture_default_str();
                 opt->add_option("--pgd-tolerance", tolerance, "Tolerance")->capture_default_str();
+                opt->add_flag("--pgd-warm-start,!--no-pgd-warm-start",
+                              warm_start,
+                              "Start from the Lagrange multipliers of the previous time step (--no-pgd-warm-start starts from zero)")
+                    ->capture_default_str();
             }
         }
 
         double alpha        = 0.05;
         std::size_t max_ite = 10000;
         double tolerance    = 1e-6;
+        bool warm_start     = true;
     };
 
     class pgd
@@ -59,18 +88,27 @@ namespace scopi
 
         template <class Problem, class Contacts, class Particles>
         auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p)
+        {
+            xt::xtensor<double, 1> lambda_0 = xt::zeros<double>({min_p.size()});
+            return (*this)(min_p, lambda_0);
+        }
+
+        template <class Problem, class Contacts, class Particles>
+        auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p, const xt::xtensor<double, 1>& lambda_0)
         {
             std::size_t ite = 0;
 
-            xt::xtensor<double, 1> lambda_n   = xt::zeros<double>({min_p.size()});
+            xt::xtensor<double, 1> lambda_n   = lambda_0;
             xt::xtensor<double, 1> lambda_np1 = xt::zeros<double>({min_p.size()});
+            xt::xtensor<double, 1> dG         = xt::zeros<double>({min_p.size()});
+            auto work                         = min_p.make_workspace();
 
             while (ite < m_params.max_ite)
             {
                 ++ite;
 
-                xt::xtensor<double, 1> dG = min_p.gradient(lambda_n);
-                lambda_np1                = lambda_n - m_params.alpha * dG;
+                min_p.gradient_into(lambda_n, dG, work);
+                xt::noalias(lambda_np1) = lambda_n - m_params.alpha * dG;
                 min_p.projection(lambda_np1);
 
                 // PLOG_INFO << fmt::format("pgd -> ite: {} residual: {}", ite, xt::norm_l2(lambda_np1 - lambda_n)[0]) << std::endl;
@@ -78,7 +116,7 @@ namespace scopi
                 // PLOG_INFO << fmt::format("dG: {}", xt::norm_linf(dG)) << std::endl;
                 // PLOG_INFO << fmt::format("lambda_n: {}", xt::norm_linf(lambda_np1)) << std::endl;
 
-                if (xt::norm_l2(lambda_np1 - lambda_n)[0] < m_params.tolerance)
+                if (std::sqrt(squared_distance(lambda_np1, lambda_n)) < m_params.tolerance)
                 // if (xt::norm_linf(dG)[0] < m_params.tolerance || xt::norm_linf(lambda_np1)[0] < m_params.tolerance)
                 {
                     std::swap(lambda_n, lambda_np1);
@@ -88,12 +126,19 @@ namespace scopi
                 std::swap(lambda_n, lambda_np1);
             }
             PLOG_INFO << fmt::format("pgd converged in {} iterations.", ite) << std::endl;
+            m_nb_iterations = ite;
             return lambda_n;
         }
 
+        std::size_t nb_iterations() const
+        {
+            return m_nb_iterations;
+        }
+
       private:
 
         params_t m_params;
+        std::size_t m_nb_iterations = 0;
     };
 
     struct apgd_params
@@ -108,6 +153,10 @@ namespace scopi
                 opt->add_option("--apgd-max-ite", max_ite, "Maximum number of iterations")->capture_default_str();
                 opt->add_option("--apgd-tolerance", tolerance, "Tolerance")->capture_default_str();
                 opt->add_flag("--apgd-dynamic", dynamic_descent, "Adaptive descent coefficient")->capture_default_str();
+                opt->add_flag("--apgd-warm-start,!--no-apgd-warm-start",
+                              warm_start,
+                              "Start from the Lagrange multipliers of the previous time step (--no-apgd-warm-start starts from zero)")
+                    ->capture_default_str();
             }
         }
 
@@ -115,6 +164,7 @@ namespace scopi
         std::size_t max_ite  = 10000;
         double tolerance     = 1e-7;
         bool dynamic_descent = true;
+        bool warm_start      = true;
     };
 
     class apgd
@@ -140,18 +190,30 @@ namespace scopi
 
         template <class Problem, class Contacts, class Particles>
         auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p)
+        {
+            xt::xtensor<double, 1> lambda_0 = xt::zeros<double>({min_p.size()});
+            return (*this)(min_p, lambda_0);
+        }
+
+        template <class Problem, class Contacts, class Particles>
+        auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p, const xt::xtensor<double, 1>& lambda_0)
         {
             std::size_t ite = 0;
 
-            xt::xtensor<double, 1> lambda_n   = xt::zeros<double>({min_p.size()});
+            xt::xtensor<double, 1> lambda_n   = lambda_0;
             xt::xtensor<double, 1> lambda_np1 = xt::zeros<double>({min_p.size()});
 
             xt::xtensor<double, 1> theta_n   = xt::ones<double>({min_p.size()});
             xt::xtensor<double, 1> theta_np1 = xt::ones<double>({min_p.size()});
 
-            xt::xtensor<double, 1> y_n   = xt::zeros<double>({min_p.size()});
+            xt::xtensor<double, 1> y_n   = lambda_0;
             xt::xtensor<double, 1> y_np1 = xt::zeros<double>({min_p.size()});
 
+            // the objective at y_n reuses the product by Q of the gradient, only lambda_np1 needs a new one
+            xt::xtensor<double, 1> dG = xt::zeros<double>({min_p.size()});
+            auto work_y               = min_p.make_workspace();
+            auto work_lambda          = min_p.make_workspace();
+
             double alpha  = m_params.alpha;
             double lipsch = 1. / alpha; // used only if dynamic_descent = true
 
@@ -159,14 +221,15 @@ namespace scopi
             {
                 ++ite;
 
-                xt::xtensor<double, 1> dG = min_p.gradient(y_n);
-                xt::noalias(lambda_np1)   = y_n - alpha * dG;
+                min_p.gradient_into(y_n, dG, work_y);
+                xt::noalias(lambda_np1) = y_n - alpha * dG;
                 min_p.projection(lambda_np1);
 
                 if (m_params.dynamic_descent)
                 {
-                    while (min_p(lambda_np1) >= min_p(y_n) + xt::linalg::dot(dG, lambda_np1 - y_n)[0]
-                                                    + 0.5 * lipsch * std::pow(xt::norm_l2(lambda_np1 - y_n)[0], 2))
+                    const double G_y = min_p.cached_objective(y_n, work_y);
+                    while (min_p.objective(lambda_np1, work_lambda)
+                           >= G_y + dot_difference(dG, lambda_np1, y_n) + 0.5 * lipsch * squared_distance(lambda_np1, y_n))
                     {
                         lipsch *= 2;
                         alpha                   = 1. / lipsch;
@@ -180,7 +243,7 @@ namespace scopi
                 // PLOG_INFO << fmt::format("dG: {}", xt::norm_linf(dG)) << std::endl;
                 // PLOG_INFO << fmt::format("lambda_n: {}", xt::norm_linf(lambda_np1)) << std::endl;
 
-                if (xt::norm_l2(lambda_np1 - lambda_n)[0] < m_params.tolerance)
+                if (std::sqrt(squared_distance(lambda_np1, lambda_n)) < m_params.tolerance)
                 // if (xt::norm_linf(dG)[0] < m_params.tolerance || xt::norm_linf(lambda_np1)[0] < m_params.tolerance)
                 {
                     std::swap(lambda_n, lambda_np1);
@@ -193,9 +256,9 @@ namespace scopi
 
                 if (m_params.dynamic_descent)
                 {
-                    if (xt::linalg::dot(dG, lambda_np1 - lambda_n)[0] > 0)
+                    if (dot_difference(dG, lambda_np1, lambda_n) > 0)
                     {
-                        y_np1 = lambda_np1;
+                        xt::noalias(y_np1) = lambda_np1;
                         theta_np1.fill(1.);
                     }
                     lipsch *= 0.97;
@@ -206,12 +269,19 @@ namespace scopi
                 std::swap(y_n, y_np1);
             }
             PLOG_INFO << fmt::format("apgd converged in {} iterations.", ite) << std::endl;
+            m_nb_iterations = ite;
             return lambda_n;
         }
 
+        std::size_t nb_iterations() const
+        {
+            return m_nb_iterations;
+        }
+
       private:
 
         params_t m_params;
+        std::size_t m_nb_iterations = 0;
     };
 
 }
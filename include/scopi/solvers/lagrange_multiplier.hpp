@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <xtensor/xnoalias.hpp>
 #include <xtensor/xnorm.hpp>
 #include <xtensor/xtensor.hpp>
 
@@ -8,6 +13,75 @@
 
 namespace scopi
 {
+    // component along the normal of the rows 3 * i to 3 * i + dim of x
+    template <std::size_t dim, class Vec, class Normal>
+    inline double normal_component(const Vec& x, std::size_t i, const Normal& nij)
+    {
+        double out = 0.;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            out += x[3 * i + d] * nij[d];
+        }
+        return out;
+    }
+
+    // projection of the dim components of lambda_i on the Coulomb cone of normal nij and coefficient mu
+    template <std::size_t dim, class Normal>
+    inline void friction_cone_projection(double* lambda_i, const Normal& nij, double mu)
+    {
+        double lambda_n = 0.;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            lambda_n += lambda_i[d] * nij[d];
+        }
+        std::array<double, dim> lambda_t;
+        double norm = 0.;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            lambda_t[d] = lambda_i[d] - lambda_n * nij[d];
+            norm += lambda_t[d] * lambda_t[d];
+        }
+        norm = std::sqrt(norm);
+        if (norm > mu * lambda_n)
+        {
+            if (lambda_n <= -mu * norm)
+            {
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    lambda_i[d] = 0.;
+                }
+            }
+            else
+            {
+                auto new_norm     = (mu * mu) * (norm + lambda_n / mu) / (mu * mu + 1);
+                auto new_lambda_n = new_norm / mu;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    lambda_i[d] = new_norm * lambda_t[d] / norm + new_lambda_n * nij[d];
+                }
+            }
+        }
+    }
+
+    // rows of the multipliers of one contact and their directions in the global frame (the columns of local2global)
+    struct contact_multipliers
+    {
+        std::size_t size = 0;
+        std::array<std::size_t, 4> rows{};
+        std::array<std::array<double, 3>, 4> directions{};
+    };
+
+    template <std::size_t dim, class Normal>
+    inline std::array<double, 3> normal_direction(const Normal& nij, double sign = 1.)
+    {
+        std::array<double, 3> out{0., 0., 0.};
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            out[d] = sign * nij[d];
+        }
+        return out;
+    }
+
     template <class Contacts, class D>
     class LagrangeMultiplierBase : public crtp_base<D>
     {
@@ -54,41 +128,42 @@ namespace scopi
         LagrangeMultiplier(const Contacts& contacts, double)
             : base(contacts)
         {
-            m_S_Vector    = xt::zeros<double>({size()});
-            m_local_work  = xt::zeros<double>({size()});
-            m_global_work = xt::zeros<double>({3 * contacts.size()});
+            m_S_Vector   = xt::zeros<double>({size()});
+            m_local_work = xt::zeros<double>({size()});
         }
 
         const auto& global2local(const xt::xtensor<double, 1>& x) const
+        {
+            global2local(x, m_local_work);
+            return m_local_work;
+        }
+
+        void global2local(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
         {
             assert(x.size() == 3 * this->m_contacts.size());
-            // xt::xtensor<double, 1> out = xt::empty<double>({this->m_contacts.size()});
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
-                // m_local_work[i] = xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
-
-                m_local_work[i] = 0;
-                for (std::size_t d = 0; d < dim; ++d)
-                {
-                    m_local_work[i] += x[3 * i + d] * this->m_contacts[i].nij[d];
-                }
+                out[i] = normal_component<dim>(x, i, this->m_contacts[i].nij);
             }
-            return m_local_work;
         }
 
         auto local2global(const xt::xtensor<double, 1>& x) const
         {
-            assert(x.size() == this->m_contacts.size());
             xt::xtensor<double, 1> out = xt::empty<double>({3 * this->m_contacts.size()});
+            local2global(x, out);
+            return out;
+        }
+
+        void local2global(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            assert(x.size() == this->m_contacts.size());
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
-                for (std::size_t d = 0; d < dim; ++d)
+                for (std::size_t d = 0; d < 3; ++d)
                 {
-                    out(3 * i + d) = x[i] * this->m_contacts[i].nij(d);
+                    out(3 * i + d) = d < dim ? x[i] * this->m_contacts[i].nij(d) : 0.;
                 }
-                // xt::view(out, xt::range(3 * i, 3 * i + dim)) = x[i] * this->m_contacts[i].nij;
             }
-            return out;
         }
 
         std::size_t size() const
@@ -103,13 +178,29 @@ namespace scopi
 
         void projection(xt::xtensor<double, 1>& lambda) const
         {
-            lambda = xt::maximum(lambda, 0.);
+            for (auto& l : lambda)
+            {
+                l = std::max(l, 0.);
+            }
+        }
+
+        contact_multipliers multipliers(std::size_t i) const
+        {
+            contact_multipliers out;
+            out.size          = 1;
+            out.rows[0]       = i;
+            out.directions[0] = normal_direction<dim>(this->m_contacts[i].nij);
+            return out;
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t i) const
+        {
+            lambda[i] = std::max(lambda[i], 0.);
         }
 
       private:
 
         mutable xt::xtensor<double, 1> m_local_work;
-        mutable xt::xtensor<double, 1> m_global_work;
         xt::xtensor<double, 1> m_S_Vector;
     };
 
@@ -124,17 +215,14 @@ namespace scopi
 
         LagrangeMultiplier(const Contacts& contacts, double)
             : base(contacts)
+            , m_negative_rows(contacts.size(), std::size_t(-1))
         {
-            m_size = 0;
+            m_size = contacts.size();
             for (std::size_t i = 0; i < contacts.size(); ++i)
             {
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
-                    m_size += 2;
-                }
-                else
-                {
-                    ++m_size;
+                    m_negative_rows[i] = m_size++;
                 }
             }
             m_S_Vector = xt::zeros<double>({m_size});
@@ -142,45 +230,49 @@ namespace scopi
 
         auto global2local(const xt::xtensor<double, 1>& x) const
         {
-            // std::cout << "in global2local " << m_gamma << std::endl;
-            assert(x.size() == 3 * this->m_contacts.size());
             xt::xtensor<double, 1> out = xt::empty<double>({size()});
+            global2local(x, out);
+            return out;
+        }
+
+        void global2local(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            assert(x.size() == 3 * this->m_contacts.size());
             std::size_t next_gamma_neg = this->m_contacts.size();
 
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
+                out[i] = normal_component<dim>(x, i, this->m_contacts[i].nij);
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
-                    out[i]                = xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
-                    out[next_gamma_neg++] = -xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
-                }
-                else
-                {
-                    out[i] = xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
+                    out[next_gamma_neg++] = -out[i];
                 }
             }
-            return out;
         }
 
         auto local2global(const xt::xtensor<double, 1>& x) const
         {
-            // std::cout << "in local2global " << m_gamma << std::endl;
+            xt::xtensor<double, 1> out = xt::empty<double>({3 * this->m_contacts.size()});
+            local2global(x, out);
+            return out;
+        }
 
+        void local2global(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
             assert(x.size() == size());
-            xt::xtensor<double, 1> out = xt::empty<double>({3 * this->m_contacts.size()});
             std::size_t next_gamma_neg = this->m_contacts.size();
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
+                double x_i = x[i];
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
-                    xt::view(out, xt::range(3 * i, 3 * i + dim)) = (x[i] - x[next_gamma_neg++]) * this->m_contacts[i].nij;
+                    x_i -= x[next_gamma_neg++];
                 }
-                else
+                for (std::size_t d = 0; d < 3; ++d)
                 {
-                    xt::view(out, xt::range(3 * i, 3 * i + dim)) = x[i] * this->m_contacts[i].nij;
+                    out(3 * i + d) = d < dim ? x_i * this->m_contacts[i].nij(d) : 0.;
                 }
             }
-            return out;
         }
 
         std::size_t size() const
@@ -196,12 +288,41 @@ namespace scopi
         void projection(xt::xtensor<double, 1>& lambda) const
         {
             assert(lambda.size() == m_size);
-            lambda = xt::maximum(lambda, 0.);
+            for (auto& l : lambda)
+            {
+                l = std::max(l, 0.);
+            }
+        }
+
+        contact_multipliers multipliers(std::size_t i) const
+        {
+            contact_multipliers out;
+            out.size          = 1;
+            out.rows[0]       = i;
+            out.directions[0] = normal_direction<dim>(this->m_contacts[i].nij);
+            if (m_negative_rows[i] != std::size_t(-1))
+            {
+                out.size          = 2;
+                out.rows[1]       = m_negative_rows[i];
+                out.directions[1] = normal_direction<dim>(this->m_contacts[i].nij, -1.);
+            }
+            return out;
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t i) const
+        {
+            lambda[i] = std::max(lambda[i], 0.);
+            if (m_negative_rows[i] != std::size_t(-1))
+            {
+                lambda[m_negative_rows[i]] = std::max(lambda[m_negative_rows[i]], 0.);
+            }
         }
 
       private:
 
         std::size_t m_size;
+        // row of the second multiplier of the contacts with gamma < -gamma_tol
+        std::vector<std::size_t> m_negative_rows;
         xt::xtensor<double, 1> m_S_Vector;
     };
 
@@ -225,11 +346,21 @@ namespace scopi
             return x;
         }
 
+        void global2local(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            xt::noalias(out) = x;
+        }
+
         auto local2global(const xt::xtensor<double, 1>& x) const
         {
             return x;
         }
 
+        void local2global(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            xt::noalias(out) = x;
+        }
+
         std::size_t size() const
         {
             return 3 * this->m_contacts.size();
@@ -243,28 +374,27 @@ namespace scopi
         void projection(xt::xtensor<double, 1>& lambda) const
         {
             assert(lambda.size() == size());
-            for (std::size_t i = 0, row = 0; i < this->m_contacts.size(); ++i, row += 3)
+            for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
-                auto lambda_i = xt::view(lambda, xt::range(row, row + dim));
-                auto lambda_n = xt::linalg::dot(lambda_i, this->m_contacts[i].nij)[0];
-                auto lambda_t = xt::eval(lambda_i - lambda_n * this->m_contacts[i].nij);
-                auto norm     = xt::norm_l2(lambda_t)[0];
-                double mu     = this->m_contacts[i].property.mu;
-                if (norm > mu * lambda_n)
-                {
-                    if (lambda_n <= -mu * norm)
-                    {
-                        lambda_i = 0;
-                    }
-                    else
-                    {
-                        auto new_norm     = (mu * mu) * (norm + lambda_n / mu) / (mu * mu + 1);
-                        auto new_lambda_n = new_norm / mu;
-                        lambda_t /= norm;
-                        lambda_i = new_norm * lambda_t + new_lambda_n * this->m_contacts[i].nij;
-                    }
-                }
+                projection(lambda, i);
+            }
+        }
+
+        contact_multipliers multipliers(std::size_t i) const
+        {
+            contact_multipliers out;
+            out.size = 3;
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                out.rows[d]          = 3 * i + d;
+                out.directions[d][d] = 1.;
             }
+            return out;
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t i) const
+        {
+            friction_cone_projection<dim>(lambda.data() + 3 * i, this->m_contacts[i].nij, this->m_contacts[i].property.mu);
         }
 
       private:
@@ -297,11 +427,21 @@ namespace scopi
             return x;
         }
 
+        void global2local(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            xt::noalias(out) = x;
+        }
+
         auto local2global(const xt::xtensor<double, 1>& x) const
         {
             return x;
         }
 
+        void local2global(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
+        {
+            xt::noalias(out) = x;
+        }
+
         std::size_t size() const
         {
             return 3 * this->m_contacts.size();
@@ -315,30 +455,29 @@ namespace scopi
         void projection(xt::xtensor<double, 1>& lambda) const
         {
             assert(lambda.size() == size());
-            for (std::size_t i = 0, row = 0; i < this->m_contacts.size(); ++i, row += 3)
+            for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
-                auto lambda_i = xt::view(lambda, xt::range(row, row + dim));
-                auto lambda_n = xt::linalg::dot(lambda_i, this->m_contacts[i].nij)[0];
-                auto lambda_t = xt::eval(lambda_i - lambda_n * this->m_contacts[i].nij);
-                auto norm     = xt::norm_l2(lambda_t)[0];
-                double mu     = this->m_contacts[i].property.mu;
-                if (norm > mu * lambda_n)
-                {
-                    if (lambda_n <= -mu * norm)
-                    {
-                        lambda_i = 0;
-                    }
-                    else
-                    {
-                        auto new_norm     = (mu * mu) * (norm + lambda_n / mu) / (mu * mu + 1);
-                        auto new_lambda_n = new_norm / mu;
-                        lambda_t /= norm;
-                        lambda_i = new_norm * lambda_t + new_lambda_n * this->m_contacts[i].nij;
-                    }
-                }
+                projection(lambda, i);
             }
         }
 
+        contact_multipliers multipliers(std::size_t i) const
+        {
+            contact_multipliers out;
+            out.size = 3;
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                out.rows[d]          = 3 * i + d;
+                out.directions[d][d] = 1.;
+            }
+            return out;
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t i) const
+        {
+            friction_cone_projection<dim>(lambda.data() + 3 * i, this->m_contacts[i].nij, this->m_contacts[i].property.mu);
+        }
+
       private:
 
         xt::xtensor<double, 1> m_S_Vector;
@@ -377,9 +516,11 @@ namespace scopi
                 }
             }
             m_S_Vector      = xt::zeros<double>({size()});
+            m_rows.resize(this->m_contacts.size());
             std::size_t row = 0;
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
+                m_rows[i] = row;
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
                     if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
@@ -401,64 +542,89 @@ namespace scopi
         }
 
         auto global2local(const xt::xtensor<double, 1>& x) const
+        {
+            xt::xtensor<double, 1> out = xt::empty<double>({size()});
+            global2local(x, out);
+            return out;
+        }
+
+        void global2local(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
         {
             assert(x.size() == 3 * this->m_contacts.size());
-            xt::xtensor<double, 1> out = xt::zeros<double>({size()});
-            std::size_t row            = 0;
+            out.fill(0.);
+            std::size_t row = 0;
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
+                const double x_n = normal_component<dim>(x, i, this->m_contacts[i].nij);
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
                     if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
                     {
-                        out[row]     = xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
-                        out[row + 1] = -xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
+                        out[row]     = x_n;
+                        out[row + 1] = -x_n;
                         row += 2;
                     }
                     else
                     {
-                        out[row] = -xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
-                        xt::view(out, xt::range(row + 1, row + 1 + dim)) = xt::view(x, xt::range(3 * i, 3 * i + dim));
+                        out[row] = -x_n;
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            out[row + 1 + d] = x[3 * i + d];
+                        }
                         row += 4;
                     }
                 }
                 else
                 {
-                    out[row] = xt::linalg::dot(xt::view(x, xt::range(3 * i, 3 * i + dim)), this->m_contacts[i].nij)[0];
+                    out[row] = x_n;
                     ++row;
                 }
             }
-            return out;
         }
 
         auto local2global(const xt::xtensor<double, 1>& x) const
+        {
+            xt::xtensor<double, 1> out = xt::empty<double>({3 * this->m_contacts.size()});
+            local2global(x, out);
+            return out;
+        }
+
+        void local2global(const xt::xtensor<double, 1>& x, xt::xtensor<double, 1>& out) const
         {
             assert(x.size() == size());
-            xt::xtensor<double, 1> out = xt::zeros<double>({3 * this->m_contacts.size()});
-            std::size_t row            = 0;
+            out.fill(0.);
+            std::size_t row = 0;
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
+                const auto& nij = this->m_contacts[i].nij;
                 if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
                 {
                     if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
                     {
-                        xt::view(out, xt::range(3 * i, 3 * i + dim)) = (x[row] - x[row + 1]) * this->m_contacts[i].nij;
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            out(3 * i + d) = (x[row] - x[row + 1]) * nij(d);
+                        }
                         row += 2;
                     }
                     else
                     {
-                        xt::view(out, xt::range(3 * i, 3 * i + dim)) = (-x[row]) * this->m_contacts[i].nij
-                                                                     + xt::view(x, xt::range(row + 1, row + 1 + dim));
+                        for (std::size_t d = 0; d < dim; ++d)
+                        {
+                            out(3 * i + d) = -x[row] * nij(d) + x[row + 1 + d];
+                        }
                         row += 4;
                     }
                 }
                 else
                 {
-                    xt::view(out, xt::range(3 * i, 3 * i + dim)) = x[row] * this->m_contacts[i].nij;
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        out(3 * i + d) = x[row] * nij(d);
+                    }
                     row++;
                 }
             }
-            return out;
         }
 
         std::size_t size() const
@@ -474,70 +640,108 @@ namespace scopi
         void projection(xt::xtensor<double, 1>& lambda) const
         {
             assert(lambda.size() == size());
-            std::size_t row = 0;
             for (std::size_t i = 0; i < this->m_contacts.size(); ++i)
             {
-                if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
+                projection(lambda, i);
+            }
+        }
+
+        contact_multipliers multipliers(std::size_t i) const
+        {
+            contact_multipliers out;
+            const std::size_t row = m_rows[i];
+            const auto& nij       = this->m_contacts[i].nij;
+            if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
+            {
+                if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
                 {
-                    if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
+                    out.size          = 2;
+                    out.rows          = {row, row + 1, 0, 0};
+                    out.directions[0] = normal_direction<dim>(nij);
+                    out.directions[1] = normal_direction<dim>(nij, -1.);
+                }
+                else
+                {
+                    out.size          = 4;
+                    out.rows          = {row, row + 1, row + 2, row + 3};
+                    out.directions[0] = normal_direction<dim>(nij, -1.);
+                    for (std::size_t d = 0; d < dim; ++d)
                     {
-                        auto lambda_visqu = xt::view(lambda, xt::range(row, row + 2));
-                        lambda_visqu      = xt::maximum(lambda_visqu, 0.);
-                        row += 2;
+                        out.directions[1 + d][d] = 1.;
                     }
-                    else
+                }
+            }
+            else
+            {
+                out.size          = 1;
+                out.rows[0]       = row;
+                out.directions[0] = normal_direction<dim>(nij);
+            }
+            return out;
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t i) const
+        {
+            const std::size_t row = m_rows[i];
+            if (this->m_contacts[i].property.gamma < -this->m_contacts[i].property.gamma_tol)
+            {
+                if (this->m_contacts[i].property.gamma != this->m_contacts[i].property.gamma_min)
+                {
+                    auto lambda_visqu = xt::view(lambda, xt::range(row, row + 2));
+                    lambda_visqu      = xt::maximum(lambda_visqu, 0.);
+                }
+                else
+                {
+                    auto lambda_i                           = xt::view(lambda, xt::range(row, row + 1 + dim));
+                    auto lambda_f_i                         = xt::view(lambda, xt::range(row + 1, row + 1 + dim));
+                    auto lambda_n                           = xt::linalg::dot(lambda_f_i, this->m_contacts[i].nij)[0];
+                    auto lambda_t                           = xt::eval(lambda_f_i - lambda_n * this->m_contacts[i].nij);
+                    auto norm                               = xt::norm_l2(lambda_t)[0];
+                    double mu                               = this->m_contacts[i].property.mu;
+                    xt::xtensor<double, 1> lambda_proj_fric = xt::zeros<double>({1 + dim});
+                    auto lambda_fproj                       = xt::view(lambda_proj_fric, xt::range(1, 1 + dim));
+                    if (norm > mu * lambda_n)
                     {
-                        auto lambda_i                           = xt::view(lambda, xt::range(row, row + 1 + dim));
-                        auto lambda_f_i                         = xt::view(lambda, xt::range(row + 1, row + 1 + dim));
-                        auto lambda_n                           = xt::linalg::dot(lambda_f_i, this->m_contacts[i].nij)[0];
-                        auto lambda_t                           = xt::eval(lambda_f_i - lambda_n * this->m_contacts[i].nij);
-                        auto norm                               = xt::norm_l2(lambda_t)[0];
-                        double mu                               = this->m_contacts[i].property.mu;
-                        xt::xtensor<double, 1> lambda_proj_fric = xt::zeros<double>({1 + dim});
-                        auto lambda_fproj                       = xt::view(lambda_proj_fric, xt::range(1, 1 + dim));
-                        if (norm > mu * lambda_n)
+                        if (lambda_n <= -mu * norm)
                         {
-                            if (lambda_n <= -mu * norm)
-                            {
-                                lambda_fproj = xt::zeros<double>({dim});
-                            }
-                            else
-                            {
-                                auto new_norm     = (mu * mu) * (norm + lambda_n / mu) / (mu * mu + 1);
-                                auto new_lambda_n = new_norm / mu;
-                                lambda_t /= norm;
-                                lambda_fproj = new_norm * lambda_t + new_lambda_n * this->m_contacts[i].nij;
-                            }
+                            lambda_fproj = xt::zeros<double>({dim});
                         }
                         else
                         {
-                            lambda_fproj = lambda_f_i;
+                            auto new_norm     = (mu * mu) * (norm + lambda_n / mu) / (mu * mu + 1);
+                            auto new_lambda_n = new_norm / mu;
+                            lambda_t /= norm;
+                            lambda_fproj = new_norm * lambda_t + new_lambda_n * this->m_contacts[i].nij;
                         }
+                    }
+                    else
+                    {
+                        lambda_fproj = lambda_f_i;
+                    }
 
-                        xt::xtensor<double, 1> lambda_proj_moins = xt::zeros<double>({1 + dim});
-                        lambda_proj_moins[0]                     = std::max(lambda[row], 0.);
-                        if (xt::norm_l2(xt::eval(lambda_proj_fric - lambda_i))[0] < xt::norm_l2(xt::eval(lambda_proj_moins - lambda_i))[0])
-                        {
-                            lambda_i = lambda_proj_fric;
-                        }
-                        else
-                        {
-                            lambda_i = lambda_proj_moins;
-                        }
-                        row += 4;
+                    xt::xtensor<double, 1> lambda_proj_moins = xt::zeros<double>({1 + dim});
+                    lambda_proj_moins[0]                     = std::max(lambda[row], 0.);
+                    if (xt::norm_l2(xt::eval(lambda_proj_fric - lambda_i))[0] < xt::norm_l2(xt::eval(lambda_proj_moins - lambda_i))[0])
+                    {
+                        lambda_i = lambda_proj_fric;
+                    }
+                    else
+                    {
+                        lambda_i = lambda_proj_moins;
                     }
                 }
-                else
-                {
-                    lambda[row] = std::max(lambda[row], 0.);
-                    ++row;
-                }
+            }
+            else
+            {
+                lambda[row] = std::max(lambda[row], 0.);
             }
         }
 
       private:
 
         std::size_t m_size = 0;
+        // first row of the multipliers of each contact
+        std::vector<std::size_t> m_rows;
         xt::xtensor<double, 1> m_S_Vector;
     };
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+
+#include <xtensor/xnoalias.hpp>
 #include <xtensor/xtensor.hpp>
 
 #include "../matrix/velocities.hpp"
@@ -24,17 +27,19 @@ namespace scopi
             }
             else if constexpr (dim == 3)
             {
-                xt::view(out, xt::range(offset + 3 * i, offset + 3 * i + dim)) = 1. / particles.j()[particles.nb_inactive() + i];
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    out[offset + 3 * i + d] = 1. / particles.j()[particles.nb_inactive() + i](d);
+                }
             }
         }
         return out;
     }
 
     template <class Contacts, class Particles>
-    auto CVector(double dt, const Contacts& contacts, const Particles& particles)
+    auto CVector(double dt, const AMatrix<Contacts, Particles>& A, const Contacts& contacts, const Particles& particles)
     {
         static constexpr std::size_t dim = Particles::dim;
-        AMatrix A(contacts, particles);
         DMatrix D(contacts);
 
         xt::xtensor<double, 1> U = xt::zeros<double>({6 * particles.nb_active()});
@@ -42,14 +47,20 @@ namespace scopi
         std::size_t offset = 3 * particles.nb_active();
         for (std::size_t i = 0; i < particles.nb_active(); ++i)
         {
-            xt::view(U, xt::range(3 * i, 3 * i + dim)) = particles.v()[particles.nb_inactive() + i];
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                U[3 * i + d] = particles.v()[particles.nb_inactive() + i](d);
+            }
             if constexpr (dim == 2)
             {
                 U[offset + 3 * i + 2] = particles.omega()[particles.nb_inactive() + i];
             }
             else if constexpr (dim == 3)
             {
-                xt::view(U, xt::range(offset + 3 * i, offset + 3 * i + dim)) = particles.omega()[particles.nb_inactive() + i];
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    U[offset + 3 * i + d] = particles.omega()[particles.nb_inactive() + i](d);
+                }
             }
         }
 
@@ -69,6 +80,12 @@ namespace scopi
         return value;
     }
 
+    template <class Contacts, class Particles>
+    auto CVector(double dt, const Contacts& contacts, const Particles& particles)
+    {
+        return CVector(dt, AMatrix<Contacts, Particles>(contacts, particles), contacts, particles);
+    }
+
     template <class Contacts, class Particles>
     struct QMatrix
     {
@@ -77,7 +94,7 @@ namespace scopi
         QMatrix(double dt, const Contacts& contacts, const Particles& particles)
             : m_dt(dt)
             , m_A(contacts, particles)
-            , m_AT(contacts, particles)
+            , m_AT(m_A)
             , m_invM(M_inverse(particles))
         {
         }
@@ -91,11 +108,46 @@ namespace scopi
             return m_dt * m_dt * m_A.mat_mult(m_invM * m_AT.mat_mult(lambda));
         }
 
+        // same product into out, u is a work array of size nb_velocities()
+        inline void operator()(const xt::xtensor<double, 1>& lambda, xt::xtensor<double, 1>& out, xt::xtensor<double, 1>& u) const
+        {
+            xt::noalias(u) = (m_dt * m_dt) * m_invM * m_AT.mat_mult(lambda);
+            m_A.jacobian()->mat_mult(u, out);
+        }
+
+        std::size_t nb_velocities() const
+        {
+            return m_invM.size();
+        }
+
+        // rows of Q lambda of the contact ic, with u the work array of operator()(lambda, out, u)
+        inline std::array<double, 3> contact_product(std::size_t ic, const xt::xtensor<double, 1>& u) const
+        {
+            return m_A.jacobian()->contact_mult(ic, u);
+        }
+
+        // update of u when the force f is added to the contact ic
+        inline void add_contact_force(std::size_t ic, const std::array<double, 3>& f, xt::xtensor<double, 1>& u) const
+        {
+            m_A.jacobian()->contact_transpose_add(ic, f, m_invM, m_dt * m_dt, u);
+        }
+
+        // block of the contact ic on the diagonal of Q (Delassus operator)
+        inline std::array<double, 9> diagonal_block(std::size_t ic) const
+        {
+            return m_A.jacobian()->diagonal_block(ic, m_invM, m_dt * m_dt);
+        }
+
         inline auto velocities(const xt::xtensor<double, 1>& lambda) const
         {
             return xt::eval(m_invM * m_AT.mat_mult(lambda));
         }
 
+        const auto& A() const
+        {
+            return m_A;
+        }
+
       private:
 
         double m_dt;
@@ -111,26 +163,75 @@ namespace scopi
 
         static constexpr std::size_t dim = Particles::dim;
 
+        /**
+         * @brief Work arrays of the evaluations of the gradient and of the objective, allocated once per solve by make_workspace().
+         *
+         * After gradient_into() or objective(), they hold the multipliers in the global frame and their product by Q, so that the
+         * objective at the same point is given by cached_objective() without applying Q again.
+         */
+        struct workspace
+        {
+            xt::xtensor<double, 1> lambda_global;
+            xt::xtensor<double, 1> Q_lambda;
+            xt::xtensor<double, 1> u;
+        };
+
         inline minimization_problem(double dt, const Contacts& contacts, const Particles& particles)
             : m_Q(dt, contacts, particles)
-            , m_C(CVector(dt, contacts, particles))
+            , m_C(CVector(dt, m_Q.A(), contacts, particles))
             , m_lagrange(make_lagrange_multplier<Particles::dim, Problem>(contacts, dt))
+            , m_C_local(xt::eval(m_lagrange.global2local(m_C) + m_lagrange.S_Vector()))
         {
             PLOG_DEBUG << "m_C " << m_C << " " << m_lagrange.global2local(m_C) << std::endl;
         }
 
+        inline workspace make_workspace() const
+        {
+            return {xt::zeros<double>({m_C.size()}), xt::zeros<double>({m_C.size()}), xt::zeros<double>({m_Q.nb_velocities()})};
+        }
+
         inline xt::xtensor<double, 1> gradient(const xt::xtensor<double, 1>& lambda) const
         {
-            // std::cout << "local2global " << m_lagrange.local2global(lambda) << std::endl;
-            // std::cout << "Q " << m_Q(m_lagrange.local2global(lambda)) << std::endl;
-            // std::cout << "Q +C" << m_Q(m_lagrange.local2global(lambda) + m_C) << std::endl;
-            return m_lagrange.global2local(m_Q(m_lagrange.local2global(lambda)) + m_C) + m_lagrange.S_Vector();
+            auto work                  = make_workspace();
+            xt::xtensor<double, 1> out = xt::empty<double>({size()});
+            gradient_into(lambda, out, work);
+            return out;
+        }
+
+        // global2local is linear, so the gradient is global2local(Q lambda_global) + global2local(C) + S
+        inline void gradient_into(const xt::xtensor<double, 1>& lambda, xt::xtensor<double, 1>& out, workspace& work) const
+        {
+            apply_Q(lambda, work);
+            m_lagrange.global2local(work.Q_lambda, out);
+            xt::noalias(out) += m_C_local;
         }
 
         inline double operator()(const xt::xtensor<double, 1>& lambda) const
         {
-            auto lambda_global = m_lagrange.local2global(lambda);
-            return xt::linalg::dot(lambda_global, 0.5 * m_Q(lambda_global) + m_C)[0] + xt::linalg::dot(lambda, m_lagrange.S_Vector())[0];
+            auto work = make_workspace();
+            return objective(lambda, work);
+        }
+
+        inline double objective(const xt::xtensor<double, 1>& lambda, workspace& work) const
+        {
+            apply_Q(lambda, work);
+            return cached_objective(lambda, work);
+        }
+
+        // objective at the point of the last call to gradient_into or objective with work
+        inline double cached_objective(const xt::xtensor<double, 1>& lambda, const workspace& work) const
+        {
+            const auto& S = m_lagrange.S_Vector();
+            double out    = 0.;
+            for (std::size_t k = 0; k < m_C.size(); ++k)
+            {
+                out += work.lambda_global[k] * (0.5 * work.Q_lambda[k] + m_C[k]);
+            }
+            for (std::size_t k = 0; k < lambda.size(); ++k)
+            {
+                out += lambda[k] * S[k];
+            }
+            return out;
         }
 
         inline auto velocities(const xt::xtensor<double, 1>& lambda) const
@@ -138,6 +239,98 @@ namespace scopi
             return m_Q.velocities(m_lagrange.local2global(lambda));
         }
 
+        std::size_t nb_contacts() const
+        {
+            return m_Q.A().jacobian()->nb_contacts();
+        }
+
+        // active particles i and j of the contact ic, contact_jacobian::no_body for an obstacle
+        const auto& contact_bodies(std::size_t ic) const
+        {
+            return m_Q.A().jacobian()->bodies(ic);
+        }
+
+        contact_multipliers multipliers(std::size_t ic) const
+        {
+            return m_lagrange.multipliers(ic);
+        }
+
+        // block of the multipliers of the contact ic on the diagonal of the problem: directions^T Q_cc directions
+        std::array<std::array<double, 4>, 4> contact_diagonal_block(std::size_t ic) const
+        {
+            const auto blk = m_lagrange.multipliers(ic);
+            const auto W   = m_Q.diagonal_block(ic);
+            std::array<std::array<double, 4>, 4> out{};
+            for (std::size_t k = 0; k < blk.size; ++k)
+            {
+                for (std::size_t l = 0; l < blk.size; ++l)
+                {
+                    for (std::size_t a = 0; a < 3; ++a)
+                    {
+                        for (std::size_t b = 0; b < 3; ++b)
+                        {
+                            out[k][l] += blk.directions[k][a] * W[3 * a + b] * blk.directions[l][b];
+                        }
+                    }
+                }
+            }
+            return out;
+        }
+
+        // gradient with respect to the multipliers of the contact ic. It only reads work.u = dt^2 M^-1 A^T lambda_global, set by
+        // gradient_into() or objective() and kept up to date by add_contact_multipliers() when the multipliers of one contact change.
+        std::array<double, 4> contact_gradient(std::size_t ic, const workspace& work) const
+        {
+            const auto blk = m_lagrange.multipliers(ic);
+            const auto Qf  = m_Q.contact_product(ic, work.u);
+            std::array<double, 4> out{};
+            for (std::size_t k = 0; k < blk.size; ++k)
+            {
+                out[k] = m_C_local[blk.rows[k]];
+                for (std::size_t a = 0; a < 3; ++a)
+                {
+                    out[k] += blk.directions[k][a] * Qf[a];
+                }
+            }
+            return out;
+        }
+
+        // update of work.u when delta is added to the multipliers of the contact ic
+        void add_contact_multipliers(std::size_t ic, const std::array<double, 4>& delta, workspace& work) const
+        {
+            const auto blk = m_lagrange.multipliers(ic);
+            std::array<double, 3> f{0., 0., 0.};
+            for (std::size_t k = 0; k < blk.size; ++k)
+            {
+                for (std::size_t a = 0; a < 3; ++a)
+                {
+                    f[a] += delta[k] * blk.directions[k][a];
+                }
+            }
+            m_Q.add_contact_force(ic, f, work.u);
+        }
+
+        void projection(xt::xtensor<double, 1>& lambda, std::size_t ic) const
+        {
+            m_lagrange.projection(lambda, ic);
+        }
+
+        // Lagrange multipliers of the previous time step (see neighbor::lambda), projected on the constraints
+        inline xt::xtensor<double, 1> initial_lambda(const Contacts& contacts) const
+        {
+            xt::xtensor<double, 1> lambda_global = xt::zeros<double>({3 * contacts.size()});
+            for (std::size_t i = 0; i < contacts.size(); ++i)
+            {
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    lambda_global(3 * i + d) = contacts[i].lambda[d];
+                }
+            }
+            xt::xtensor<double, 1> lambda = m_lagrange.global2local(lambda_global);
+            m_lagrange.projection(lambda);
+            return lambda;
+        }
+
         void projection(xt::xtensor<double, 1>& lambda) const
         {
             m_lagrange.projection(lambda);
@@ -150,9 +343,16 @@ namespace scopi
 
       private:
 
+        inline void apply_Q(const xt::xtensor<double, 1>& lambda, workspace& work) const
+        {
+            m_lagrange.local2global(lambda, work.lambda_global);
+            m_Q(work.lambda_global, work.Q_lambda, work.u);
+        }
+
         const QMatrix<Contacts, Particles> m_Q;
         const xt::xtensor<double, 1> m_C;
         const LagrangeMultiplier<Particles::dim, Problem, Contacts> m_lagrange;
+        const xt::xtensor<double, 1> m_C_local;
     };
 
     template <class Problem, class Contacts, class Particles>
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <plog/Log.h>
+
+#include <xtensor/xtensor.hpp>
+
+#include "../matrix/velocities.hpp"
+#include "../scopi.hpp"
+#include "../utils.hpp"
+
+namespace scopi
+{
+
+    template <class Problem, class Contacts, class Particles>
+    class minimization_problem;
+
+    struct pgs_params
+    {
+        void init_options()
+        {
+            auto& app = get_app();
+            auto* opt = app.add_option_group("PGS options");
+            if (!check_option(app, "--pgs-max-ite"))
+            {
+                opt->add_option("--pgs-max-ite", max_ite, "Maximum number of iterations")->capture_default_str();
+                opt->add_option("--pgs-tolerance", tolerance, "Tolerance")->capture_default_str();
+                opt->add_option("--pgs-relaxation", relaxation, "Relaxation coefficient of the update of a contact")->capture_default_str();
+                opt->add_flag("--pgs-colored", colored, "Update the contacts color by color, in parallel")->capture_default_str();
+                opt->add_flag("--pgs-warm-start,!--no-pgs-warm-start",
+                              warm_start,
+                              "Start from the Lagrange multipliers of the previous time step (--no-pgs-warm-start starts from zero)")
+                    ->capture_default_str();
+            }
+        }
+
+        std::size_t max_ite = 10000;
+        double tolerance    = 1e-7;
+        double relaxation   = 1.;
+        bool colored        = false;
+        bool warm_start     = true;
+    };
+
+    /**
+     * @brief Projected Gauss-Seidel (non-smooth contact dynamics).
+     *
+     * The contacts are updated one at a time: the multipliers of a contact take a projected gradient step, scaled by the inverse
+     * of a bound of the largest eigenvalue of the diagonal block of the contact, then the velocities of its two particles are
+     * updated. With NoFriction, the update of a contact is its exact minimization. An iteration is a sweep over all the contacts.
+     *
+     * With pgs_params::colored, the contacts are split into colors such that two contacts of the same color have no particle in
+     * common, and the contacts of a color are updated in parallel.
+     */
+    class pgs
+    {
+      public:
+
+        using params_t = pgs_params;
+
+        explicit pgs(const params_t& params = params_t())
+            : m_params(params)
+        {
+        }
+
+        void init_options()
+        {
+            m_params.init_options();
+        }
+
+        params_t& get_params()
+        {
+            return m_params;
+        }
+
+        template <class Problem, class Contacts, class Particles>
+        auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p)
+        {
+            xt::xtensor<double, 1> lambda_0 = xt::zeros<double>({min_p.size()});
+            return (*this)(min_p, lambda_0);
+        }
+
+        template <class Problem, class Contacts, class Particles>
+        auto operator()(const minimization_problem<Problem, Contacts, Particles>& min_p, const xt::xtensor<double, 1>& lambda_0)
+        {
+            std::size_t ite               = 0;
+            const std::size_t nb_contacts = min_p.nb_contacts();
+            xt::xtensor<double, 1> lambda = lambda_0;
+            xt::xtensor<double, 1> dG     = xt::zeros<double>({min_p.size()});
+            auto work                     = min_p.make_workspace();
+            min_p.gradient_into(lambda, dG, work);
+
+            std::vector<double> step(nb_contacts, 0.);
+#pragma omp parallel for
+            for (std::size_t c = 0; c < nb_contacts; ++c)
+            {
+                // Gershgorin bound of the largest eigenvalue of the diagonal block
+                const auto blk = min_p.multipliers(c);
+                const auto D   = min_p.contact_diagonal_block(c);
+                double bound   = 0.;
+                for (std::size_t k = 0; k < blk.size; ++k)
+                {
+                    double row = 0.;
+                    for (std::size_t l = 0; l < blk.size; ++l)
+                    {
+                        row += std::abs(D[k][l]);
+                    }
+                    bound = std::max(bound, row);
+                }
+                if (bound > 0.)
+                {
+                    step[c] = m_params.relaxation / bound;
+                }
+            }
+
+            std::vector<std::vector<std::size_t>> colors;
+            if (m_params.colored)
+            {
+                colors = contact_colors(min_p);
+            }
+
+            while (ite < m_params.max_ite)
+            {
+                ++ite;
+
+                double residual = 0.;
+                if (m_params.colored)
+                {
+                    for (const auto& color : colors)
+                    {
+#pragma omp parallel for reduction(+ : residual)
+                        for (std::size_t k = 0; k < color.size(); ++k)
+                        {
+                            residual += update_contact(min_p, color[k], step[color[k]], lambda, work);
+                        }
+                    }
+                }
+                else
+                {
+                    for (std::size_t c = 0; c < nb_contacts; ++c)
+                    {
+                        residual += update_contact(min_p, c, step[c], lambda, work);
+                    }
+                }
+
+                if (std::sqrt(residual) < m_params.tolerance)
+                {
+                    break;
+                }
+            }
+            PLOG_INFO << fmt::format("pgs converged in {} iterations.", ite) << std::endl;
+            m_nb_iterations = ite;
+            return lambda;
+        }
+
+        std::size_t nb_iterations() const
+        {
+            return m_nb_iterations;
+        }
+
+      private:
+
+        // update of the multipliers of the contact c, returns the square of their variation
+        template <class Min_p, class Workspace>
+        double update_contact(const Min_p& min_p, std::size_t c, double step, xt::xtensor<double, 1>& lambda, Workspace& work) const
+        {
+            if (step == 0.)
+            {
+                return 0.;
+            }
+            const auto blk = min_p.multipliers(c);
+            const auto g   = min_p.contact_gradient(c, work);
+            std::array<double, 4> delta{};
+            for (std::size_t k = 0; k < blk.size; ++k)
+            {
+                delta[k] = lambda[blk.rows[k]];
+                lambda[blk.rows[k]] -= step * g[k];
+            }
+            min_p.projection(lambda, c);
+
+            double out = 0.;
+            for (std::size_t k = 0; k < blk.size; ++k)
+            {
+                delta[k] = lambda[blk.rows[k]] - delta[k];
+                out += delta[k] * delta[k];
+            }
+            min_p.add_contact_multipliers(c, delta, work);
+            return out;
+        }
+
+        // greedy coloring: a contact takes the first color not used by the other contacts of its particles
+        template <class Min_p>
+        std::vector<std::vector<std::size_t>> contact_colors(const Min_p& min_p) const
+        {
+            constexpr std::size_t no_body = contact_jacobian<Min_p::dim>::no_body;
+
+            std::vector<std::vector<std::size_t>> colors;
+            std::vector<std::vector<std::size_t>> body_colors;
+            for (std::size_t c = 0; c < min_p.nb_contacts(); ++c)
+            {
+                const auto& bodies = min_p.contact_bodies(c);
+                for (std::size_t body : bodies)
+                {
+                    if (body != no_body && body >= body_colors.size())
+                    {
+                        body_colors.resize(body + 1);
+                    }
+                }
+
+                std::size_t color = 0;
+                auto used         = [&](std::size_t col)
+                {
+                    return std::any_of(bodies.cbegin(),
+                                       bodies.cend(),
+                                       [&](std::size_t body)
+                                       {
+                                           return body != no_body
+                                               && std::find(body_colors[body].cbegin(), body_colors[body].cend(), col)
+                                                      != body_colors[body].cend();
+                                       });
+                };
+                while (used(color))
+                {
+                    ++color;
+                }
+
+                if (color == colors.size())
+                {
+                    colors.emplace_back();
+                }
+                colors[color].push_back(c);
+                for (std::size_t body : bodies)
+                {
+                    if (body != no_body)
+                    {
+                        body_colors[body].push_back(color);
+                    }
+                }
+            }
+            return colors;
+        }
+
+        params_t m_params;
+        std::size_t m_nb_iterations = 0;
+    };
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace scopi
+{
+    /**
+     * @brief Space-filling curves used to sort the particles (see scopi_container::reorder).
+     */
+    enum class space_filling_curve
+    {
+        /**
+         * @brief Z-order curve: the bits of the coordinates are interleaved.
+         */
+        morton,
+        /**
+         * @brief Hilbert curve: two consecutive cells along the curve are neighbors, so the order keeps more locality than morton.
+         */
+        hilbert
+    };
+
+    /**
+     * @brief Number of bits of each coordinate of a cell, so that the key fits in 64 bits (32 in 2D, 21 in 3D).
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t dim>
+    inline constexpr std::size_t curve_bits = 64 / dim;
+
+    namespace detail
+    {
+        /**
+         * @brief Interleave the bits of the coordinates, from the most significant bit of the first coordinate.
+         *
+         * @tparam dim Dimension (2 or 3).
+         * @param x [in] Coordinates, smaller than \f$ 2^{curve\_bits} \f$.
+         *
+         * @return Key.
+         */
+        template <std::size_t dim>
+        std::uint64_t interleave_bits(const std::array<std::uint32_t, dim>& x)
+        {
+            std::uint64_t key = 0;
+            for (std::size_t b = curve_bits<dim>; b-- > 0;)
+            {
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    key = (key << 1) | ((x[d] >> b) & 1U);
+                }
+            }
+            return key;
+        }
+    }
+
+    /**
+     * @brief Position of a cell along the Morton curve.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param x [in] Coordinates of the cell, smaller than \f$ 2^{curve\_bits} \f$.
+     *
+     * @return Key.
+     */
+    template <std::size_t dim>
+    std::uint64_t morton_key(const std::array<std::uint32_t, dim>& x)
+    {
+        return detail::interleave_bits<dim>(x);
+    }
+
+    /**
+     * @brief Position of a cell along the Hilbert curve.
+     *
+     * The coordinates are converted to the transposed Hilbert index with the algorithm of J. Skilling (Programming the Hilbert curve,
+     * AIP Conference Proceedings 707, 2004), whose bits are then interleaved.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param x [in] Coordinates of the cell, smaller than \f$ 2^{curve\_bits} \f$.
+     *
+     * @return Key.
+     */
+    template <std::size_t dim>
+    std::uint64_t hilbert_key(std::array<std::uint32_t, dim> x)
+    {
+        const std::uint32_t m = std::uint32_t(1) << (curve_bits<dim> - 1);
+
+        // inverse undo
+        for (std::uint32_t q = m; q > 1; q >>= 1)
+        {
+            const std::uint32_t p = q - 1;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                if (x[d] & q)
+                {
+                    x[0] ^= p;
+                }
+                else
+                {
+                    const std::uint32_t t = (x[0] ^ x[d]) & p;
+                    x[0] ^= t;
+                    x[d] ^= t;
+                }
+            }
+        }
+
+        // Gray encode
+        for (std::size_t d = 1; d < dim; ++d)
+        {
+            x[d] ^= x[d - 1];
+        }
+        std::uint32_t t = 0;
+        for (std::uint32_t q = m; q > 1; q >>= 1)
+        {
+            if (x[dim - 1] & q)
+            {
+                t ^= q - 1;
+            }
+        }
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            x[d] ^= t;
+        }
+
+        return detail::interleave_bits<dim>(x);
+    }
+
+    /**
+     * @brief Position of a cell along a space-filling curve.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param curve [in] Curve.
+     * @param x [in] Coordinates of the cell, smaller than \f$ 2^{curve\_bits} \f$.
+     *
+     * @return Key.
+     */
+    template <std::size_t dim>
+    std::uint64_t curve_key(space_filling_curve curve, const std::array<std::uint32_t, dim>& x)
+    {
+        return curve == space_filling_curve::hilbert ? hilbert_key<dim>(x) : morton_key<dim>(x);
+    }
+}
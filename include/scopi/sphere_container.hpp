@@ -0,0 +1,934 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <xtensor/xadapt.hpp>
+#include <xtensor/xview.hpp>
+
+#include "container.hpp"
+#include "objects/methods/write_objects.hpp"
+#include "objects/shape_tag.hpp"
+#include "objects/types/plane.hpp"
+#include "objects/types/sphere.hpp"
+#include "property.hpp"
+#include "quaternion.hpp"
+#include "soa.hpp"
+#include "space_filling_curve.hpp"
+#include "types.hpp"
+
+namespace scopi
+{
+    /////////////////////////////////
+    // sphere_container definition //
+    /////////////////////////////////
+    /**
+     * @brief Array of spheres, with planes as obstacles.
+     *
+     * Container for the simulations that only have spheres, and planes as obstacles. It has the interface of scopi_container used by
+     * ScopiSolver, the contact methods and the vap, but it only stores the position, the quaternion and the radius of each particle
+     * and its state (velocities, rotations, forces, masses and moments of inertia, in columns as in scopi_container). There is no
+     * shape to hash and no view of the particles: each object is one particle, and the obstacles that are planes are marked when
+     * they are added. The radius of a plane is infinite, as its bounding radius.
+     *
+     * The contact methods and ScopiSolver take this type into account at compile time: the contacts are computed from the closed forms
+     * of closest_points (see sphere_batch and compute_exact_distance), there is no internal contact to look for and the output files
+     * are written from the arrays (see write_objects).
+     *
+     * @tparam dim Dimension (2 or 3).
+     */
+    template <std::size_t Dim>
+    class sphere_container
+    {
+      public:
+
+        static constexpr std::size_t dim = Dim;
+        /**
+         * @brief Alias for the type of the position.
+         */
+        using position_type = type::position_t<dim>;
+        /**
+         * @brief Alias for the type of the velocity.
+         */
+        using velocity_type = type::velocity_t<dim>;
+        /**
+         * @brief Alias for the type of the rotation.
+         */
+        using rotation_type = type::rotation_t<dim>;
+        /**
+         * @brief Alias for the type of the force.
+         */
+        using force_type = type::force_t<dim>;
+        /**
+         * @brief Alias for the type of the mass.
+         */
+        using mass_type = double;
+        /**
+         * @brief Alias for the type of the momentum of inertia.
+         */
+        using moment_type = type::moment_t<dim>;
+        /**
+         * @brief Alias for the type of the quaternion.
+         */
+        using quaternion_type = type::quaternion_t;
+        /**
+         * @brief Number of components of a rotation and of a moment of inertia (1 in 2D, 3 in 3D).
+         */
+        static constexpr std::size_t rotation_size = dim == 2 ? 1 : 3;
+
+        /**
+         * @brief Appends a sphere to the end of the container.
+         *
+         * @param s [in] Sphere to append.
+         * @param p [in] Properties of the sphere (see property.hpp).
+         */
+        void push_back(const sphere<dim>& s, const property<dim>& p = property<dim>());
+        /**
+         * @brief Appends a plane to the end of the container.
+         *
+         * \note The plane must be an obstacle (see property::deactivate).
+         *
+         * @param s [in] Plane to append.
+         * @param p [in] Properties of the plane (see property.hpp).
+         */
+        void push_back(const plane<dim>& s, const property<dim>& p);
+        /**
+         * @brief Add a periodic image of a particle.
+         *
+         * See scopi_container::add_periodic_image.
+         *
+         * @param i [in] Index of the particle.
+         * @param shift [in] Shift of the position of the image.
+         */
+        void add_periodic_image(std::size_t i, const position_type& shift);
+
+        /**
+         * @brief Increase the capacity of the container.
+         *
+         * @param size [in] New capacity of the container.
+         */
+        void reserve(std::size_t size);
+
+        /**
+         * @brief Sort the active spheres along a space-filling curve.
+         *
+         * See scopi_container::reorder, the key of a sphere is the cell of the curve that contains its center.
+         *
+         * \pre There is no periodic image.
+         *
+         * @param curve [in] Space-filling curve.
+         *
+         * @return Permutation of the particles: the particle \c i before the call is the particle \c perm[i].
+         */
+        std::vector<std::size_t> reorder(space_filling_curve curve);
+
+        /**
+         * @brief Remove an active sphere.
+         *
+         * The last sphere takes the place of the removed one, in O(1). The other particles keep their identifiers.
+         *
+         * \pre There is no periodic image.
+         *
+         * @param i [in] Index of the sphere, which is not an obstacle.
+         */
+        void erase(std::size_t i);
+
+        /**
+         * @brief Array of particles' positions.
+         */
+        auto pos() const;
+        /**
+         * @brief Array of particles' positions.
+         */
+        auto pos();
+
+        /**
+         * @brief Array of particles' quaternions.
+         */
+        auto q() const;
+        /**
+         * @brief Array of particles' quaternions.
+         */
+        auto q();
+
+        /**
+         * @brief Array of particles' forces.
+         */
+        auto f() const;
+        /**
+         * @brief Array of particles' forces.
+         */
+        auto f();
+
+        /**
+         * @brief Array of particles' masses.
+         */
+        auto m() const;
+        /**
+         * @brief Array of particles' masses.
+         */
+        auto m();
+
+        /**
+         * @brief Array of particles' moments of inertia.
+         */
+        auto j() const;
+        /**
+         * @brief Array of particles' moments of inertia.
+         */
+        auto j();
+
+        /**
+         * @brief Array of particles' velocities.
+         */
+        auto v() const;
+        /**
+         * @brief Array of particles' velocities.
+         */
+        auto v();
+
+        /**
+         * @brief Array of particles' rotation.
+         */
+        auto omega() const;
+        /**
+         * @brief Array of particles' rotation.
+         */
+        auto omega();
+
+        /**
+         * @brief Array of particles' desired rotation.
+         */
+        auto desired_omega() const;
+        /**
+         * @brief Array of particles' desired rotations.
+         */
+        auto desired_omega();
+
+        /**
+         * @brief Array of particles' desired velocities.
+         */
+        auto vd() const;
+        /**
+         * @brief Array of particles' desired velocities.
+         */
+        auto vd();
+
+        /**
+         * @brief Number of objects in the container, which is the number of particles.
+         *
+         * The periodic images are not objects.
+         */
+        std::size_t size() const;
+        /**
+         * @brief Number of particles in the container.
+         *
+         * @param with_periodic [in] Whether the periodic images are counted.
+         */
+        std::size_t nb_particles(bool with_periodic = true) const;
+        /**
+         * @brief Number of active particles in the container.
+         */
+        std::size_t nb_active() const;
+        /**
+         * @brief Number of inactive particles in the container.
+         */
+        std::size_t nb_inactive() const;
+
+        /**
+         * @brief Stable identifier of a particle or of a periodic image (see scopi_container::particle_id).
+         *
+         * @param i [in] Index of the particle.
+         */
+        std::size_t particle_id(std::size_t i) const;
+        /**
+         * @brief Index of a particle from its identifier (see particle_id).
+         *
+         * @param id [in] Identifier of the particle.
+         *
+         * @return Index of the particle, <tt>std::size_t(-1)</tt> if it was removed.
+         */
+        std::size_t particle_index(std::size_t id) const;
+
+        /**
+         * @brief Convert a particle index into an object index.
+         *
+         * Each object is one particle, the object of a periodic image is its particle.
+         *
+         * @param i [in] Index of a particle (or of a periodic image).
+         */
+        std::size_t object_index(std::size_t i) const;
+        /**
+         * @brief Convert an object index into a particle index.
+         *
+         * @param i [in] Index of an object, smaller or equal to size().
+         */
+        std::size_t offset(std::size_t i) const;
+
+        /**
+         * @brief Remove all fictive particles.
+         */
+        void reset_periodic();
+
+        /**
+         * @brief Index of the first periodic image, which is the number of
+         * particles in the container.
+         */
+        std::size_t periodic_ptr() const;
+        /**
+         * @brief Index of the particle of a periodic image.
+         *
+         * @param i [in] Index of the image, relative to periodic_ptr().
+         */
+        std::size_t periodic_index(std::size_t i) const;
+        /**
+         * @brief Shift of the position of a periodic image.
+         *
+         * @param i [in] Index of the image, relative to periodic_ptr().
+         */
+        const position_type& periodic_shift(std::size_t i) const;
+
+        /**
+         * @brief Position of a particle or of a periodic image.
+         *
+         * @param i [in] Index of the particle, smaller than nb_particles().
+         */
+        position_type position(std::size_t i) const;
+
+        /**
+         * @brief Radius of a sphere or of a periodic image.
+         *
+         * The radius of a plane is infinite.
+         *
+         * @param i [in] Index of the particle.
+         */
+        double radius(std::size_t i) const;
+        /**
+         * @brief Bounding radius of a particle or of a periodic image, which is its radius.
+         *
+         * @param i [in] Index of the particle.
+         */
+        double bounding_radius(std::size_t i) const;
+        /**
+         * @brief Largest radius of the active particles.
+         */
+        double max_bounding_radius() const;
+        /**
+         * @brief Whether a particle or a periodic image is a plane.
+         *
+         * @param i [in] Index of the particle.
+         */
+        bool is_plane(std::size_t i) const;
+        /**
+         * @brief Whether a particle or a periodic image is a sphere.
+         *
+         * @param i [in] Index of the particle.
+         */
+        bool is_sphere(std::size_t i) const;
+        /**
+         * @brief Tag of the shape of a particle or of a periodic image (see shape_tag.hpp).
+         *
+         * @param i [in] Index of the particle.
+         */
+        shape_tag_t particle_tag(std::size_t i) const;
+
+      private:
+
+        /**
+         * @brief Appends a particle to the end of the container.
+         *
+         * @param pos [in] Position of the particle.
+         * @param q [in] Quaternion of the particle.
+         * @param radius [in] Radius of the particle.
+         * @param p [in] Properties of the particle.
+         */
+        void push_back_particle(const position_type& pos, const quaternion_type& q, double radius, const property<dim>& p);
+
+        /**
+         * @brief Array of particles' positions.
+         */
+        std::vector<position_type> m_positions; // pos()
+        /**
+         * @brief Array of particles' quaternions.
+         */
+        std::vector<quaternion_type> m_quaternions; // q()
+        /**
+         * @brief Array of particles' radii.
+         */
+        std::vector<double> m_radii; // radius()
+        /**
+         * @brief Array of particles' forces.
+         */
+        soa_array<dim> m_forces; // f()
+        /**
+         * @brief Array of particles' masses.
+         */
+        soa_array<1> m_masses; // m()
+        /**
+         * @brief Array of particles' moments of inertia.
+         */
+        soa_array<rotation_size> m_moments_inertia; // j()
+        /**
+         * @brief Array of particles' velocities.
+         */
+        soa_array<dim> m_velocities; // v()
+        /**
+         * @brief Array of particles' desired velocities.
+         */
+        soa_array<dim> m_desired_velocities; // vd()
+        /**
+         * @brief Array of particles' rotations.
+         */
+        soa_array<rotation_size> m_omega; // omega()
+        /**
+         * @brief Array of particles' desired rotations.
+         */
+        soa_array<rotation_size> m_desired_omega; // desired_omega()
+        /**
+         * @brief Whether each obstacle is a plane.
+         */
+        std::vector<bool> m_is_plane;
+        /**
+         * @brief Array of particles' stable identifiers.
+         */
+        std::vector<std::size_t> m_particle_ids; // particle_id()
+        /**
+         * @brief Index of each particle ever added, indexed by its identifier.
+         */
+        std::vector<std::size_t> m_particle_indices; // particle_index()
+        /**
+         * @brief Indices of the particles of the periodic images.
+         */
+        std::vector<std::size_t> m_periodic_indices;
+        /**
+         * @brief Shifts of the positions of the periodic images.
+         */
+        std::vector<position_type> m_periodic_shifts;
+        /**
+         * @brief Largest radius of the active particles.
+         */
+        double m_max_radius{0.};
+        /**
+         * @brief Number of obstacles (inactive particles).
+         */
+        std::size_t m_nb_inactive{0};
+    };
+
+    template <std::size_t dim>
+    void sphere_container<dim>::push_back_particle(const position_type& pos,
+                                                   const quaternion_type& q,
+                                                   double radius,
+                                                   const property<dim>& p)
+    {
+        assert(m_periodic_indices.empty());
+
+        if (!p.is_active() && m_nb_inactive != m_positions.size())
+        {
+            throw std::runtime_error("All the obstacles must be pushed "
+                                     "before the active particles.");
+        }
+
+        m_positions.push_back(pos);
+        m_quaternions.push_back(q);
+        m_radii.push_back(radius);
+        m_velocities.push_back(p.velocity());
+        m_omega.push_back(p.omega());
+        m_desired_omega.push_back(p.desired_omega());
+        m_desired_velocities.push_back(p.desired_velocity());
+        m_forces.push_back(p.force());
+        m_masses.push_back(p.mass());
+        m_moments_inertia.push_back(p.moment_inertia());
+        m_particle_ids.push_back(m_particle_indices.size());
+        m_particle_indices.push_back(m_positions.size() - 1);
+
+        if (p.is_active())
+        {
+            m_max_radius = std::max(m_max_radius, radius);
+        }
+        else
+        {
+            m_nb_inactive++;
+        }
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::push_back(const sphere<dim>& s, const property<dim>& p)
+    {
+        push_back_particle(s.pos(0), s.q(0), s.radius(), p);
+        if (!p.is_active())
+        {
+            m_is_plane.push_back(false);
+        }
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::push_back(const plane<dim>& s, const property<dim>& p)
+    {
+        if (p.is_active())
+        {
+            throw std::runtime_error("The planes of a sphere_container must be obstacles.");
+        }
+        push_back_particle(s.pos(0), s.q(0), std::numeric_limits<double>::infinity(), p);
+        m_is_plane.push_back(true);
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::add_periodic_image(std::size_t i, const position_type& shift)
+    {
+        assert(i < m_positions.size());
+
+        m_periodic_indices.push_back(i);
+        m_periodic_shifts.push_back(shift);
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::reserve(std::size_t size)
+    {
+        m_positions.reserve(size);
+        m_quaternions.reserve(size);
+        m_radii.reserve(size);
+        m_velocities.reserve(size);
+        m_desired_velocities.reserve(size);
+        m_omega.reserve(size);
+        m_desired_omega.reserve(size);
+        m_forces.reserve(size);
+        m_masses.reserve(size);
+        m_moments_inertia.reserve(size);
+        m_particle_ids.reserve(size);
+        m_particle_indices.reserve(size);
+    }
+
+    template <std::size_t dim>
+    std::vector<std::size_t> sphere_container<dim>::reorder(space_filling_curve curve)
+    {
+        assert(m_periodic_indices.empty());
+
+        const std::size_t npart = m_positions.size();
+        std::vector<std::size_t> perm(npart);
+        std::iota(perm.begin(), perm.end(), 0);
+        if (m_nb_inactive + 1 >= npart)
+        {
+            return perm;
+        }
+
+        std::array<double, dim> lower;
+        std::array<double, dim> upper;
+        lower.fill(std::numeric_limits<double>::max());
+        upper.fill(std::numeric_limits<double>::lowest());
+        for (std::size_t i = m_nb_inactive; i < npart; ++i)
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                lower[d] = std::min(lower[d], m_positions[i](d));
+                upper[d] = std::max(upper[d], m_positions[i](d));
+            }
+        }
+
+        const double ncells = static_cast<double>((std::uint64_t(1) << curve_bits<dim>) - 1);
+        std::vector<std::uint64_t> keys(npart - m_nb_inactive);
+#pragma omp parallel for
+        for (std::size_t k = 0; k < keys.size(); ++k)
+        {
+            std::array<std::uint32_t, dim> cell;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double length = upper[d] - lower[d];
+                const double x      = m_positions[m_nb_inactive + k](d);
+                cell[d]             = length > 0. ? static_cast<std::uint32_t>((x - lower[d]) / length * ncells) : 0;
+            }
+            keys[k] = curve_key<dim>(curve, cell);
+        }
+
+        std::vector<std::size_t> new_to_old(npart);
+        std::iota(new_to_old.begin(), new_to_old.end(), 0);
+        std::stable_sort(new_to_old.begin() + static_cast<std::ptrdiff_t>(m_nb_inactive),
+                         new_to_old.end(),
+                         [&](std::size_t a, std::size_t b)
+                         {
+                             return keys[a - m_nb_inactive] < keys[b - m_nb_inactive];
+                         });
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            perm[new_to_old[k]] = k;
+        }
+
+        detail::permute(m_positions, new_to_old);
+        detail::permute(m_quaternions, new_to_old);
+        detail::permute(m_radii, new_to_old);
+        detail::permute(m_particle_ids, new_to_old);
+        for (std::size_t k = 0; k < npart; ++k)
+        {
+            m_particle_indices[m_particle_ids[k]] = k;
+        }
+        m_velocities.permute(new_to_old);
+        m_desired_velocities.permute(new_to_old);
+        m_omega.permute(new_to_old);
+        m_desired_omega.permute(new_to_old);
+        m_forces.permute(new_to_old);
+        m_masses.permute(new_to_old);
+        m_moments_inertia.permute(new_to_old);
+
+        return perm;
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::erase(std::size_t i)
+    {
+        assert(m_periodic_indices.empty());
+        assert(i < size());
+
+        if (i < m_nb_inactive)
+        {
+            throw std::runtime_error("The obstacles cannot be erased.");
+        }
+
+        const std::size_t last = m_positions.size() - 1;
+        const double radius    = m_radii[i];
+
+        m_particle_indices[m_particle_ids[i]] = std::size_t(-1);
+
+        // the last sphere takes the place of the removed one
+        if (i < last)
+        {
+            m_positions[i]                        = m_positions[last];
+            m_quaternions[i]                      = m_quaternions[last];
+            m_radii[i]                            = m_radii[last];
+            m_velocities.view()(i)                = m_velocities.view()(last);
+            m_desired_velocities.view()(i)        = m_desired_velocities.view()(last);
+            m_omega.view()(i)                     = m_omega.view()(last);
+            m_desired_omega.view()(i)             = m_desired_omega.view()(last);
+            m_forces.view()(i)                    = m_forces.view()(last);
+            m_masses.view()(i)                    = m_masses.view()(last);
+            m_moments_inertia.view()(i)           = m_moments_inertia.view()(last);
+            m_particle_ids[i]                     = m_particle_ids[last];
+            m_particle_indices[m_particle_ids[i]] = i;
+        }
+
+        m_positions.pop_back();
+        m_quaternions.pop_back();
+        m_radii.pop_back();
+        m_particle_ids.pop_back();
+        m_velocities.resize(last);
+        m_desired_velocities.resize(last);
+        m_forces.resize(last);
+        m_omega.resize(last);
+        m_desired_omega.resize(last);
+        m_moments_inertia.resize(last);
+        m_masses.resize(last);
+
+        if (radius == m_max_radius)
+        {
+            m_max_radius = 0.;
+            for (std::size_t k = m_nb_inactive; k < m_radii.size(); ++k)
+            {
+                m_max_radius = std::max(m_max_radius, m_radii[k]);
+            }
+        }
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::size() const
+    {
+        return m_positions.size();
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::nb_particles(bool with_periodic) const
+    {
+        return (with_periodic) ? m_positions.size() + m_periodic_indices.size() : m_positions.size();
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::nb_active() const
+    {
+        return m_positions.size() - m_nb_inactive;
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::nb_inactive() const
+    {
+        return m_nb_inactive;
+    }
+
+    // position
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::pos() const
+    {
+        return xt::adapt(reinterpret_cast<const position_type*>(m_positions.data()), {m_positions.size()});
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::pos()
+    {
+        return xt::adapt(reinterpret_cast<position_type*>(m_positions.data()), {m_positions.size()});
+    }
+
+    // rotation
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::q() const
+    {
+        return xt::adapt(reinterpret_cast<const quaternion_type*>(m_quaternions.data()), {m_quaternions.size()});
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::q()
+    {
+        return xt::adapt(reinterpret_cast<quaternion_type*>(m_quaternions.data()), {m_quaternions.size()});
+    }
+
+    // velocity
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::v() const
+    {
+        return m_velocities.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::v()
+    {
+        return m_velocities.view();
+    }
+
+    // desired velocity
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::vd() const
+    {
+        return m_desired_velocities.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::vd()
+    {
+        return m_desired_velocities.view();
+    }
+
+    // omega
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::omega() const
+    {
+        return m_omega.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::omega()
+    {
+        return m_omega.view();
+    }
+
+    // desired omega
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::desired_omega() const
+    {
+        return m_desired_omega.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::desired_omega()
+    {
+        return m_desired_omega.view();
+    }
+
+    // force
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::f() const
+    {
+        return m_forces.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::f()
+    {
+        return m_forces.view();
+    }
+
+    // mass
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::m() const
+    {
+        return m_masses.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::m()
+    {
+        return m_masses.view();
+    }
+
+    // moment of inertia
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::j() const
+    {
+        return m_moments_inertia.view();
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::j()
+    {
+        return m_moments_inertia.view();
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::particle_id(std::size_t i) const
+    {
+        return m_particle_ids[i < m_positions.size() ? i : m_periodic_indices[i - m_positions.size()]];
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::particle_index(std::size_t id) const
+    {
+        return m_particle_indices[id];
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::object_index(std::size_t i) const
+    {
+        return i < m_positions.size() ? i : m_periodic_indices[i - m_positions.size()];
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::offset(std::size_t i) const
+    {
+        return i;
+    }
+
+    template <std::size_t dim>
+    void sphere_container<dim>::reset_periodic()
+    {
+        m_periodic_indices.clear();
+        m_periodic_shifts.clear();
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::periodic_ptr() const
+    {
+        return m_positions.size();
+    }
+
+    template <std::size_t dim>
+    std::size_t sphere_container<dim>::periodic_index(std::size_t i) const
+    {
+        return m_periodic_indices[i];
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::periodic_shift(std::size_t i) const -> const position_type&
+    {
+        return m_periodic_shifts[i];
+    }
+
+    template <std::size_t dim>
+    auto sphere_container<dim>::position(std::size_t i) const -> position_type
+    {
+        if (i < m_positions.size())
+        {
+            return m_positions[i];
+        }
+        position_type pos = m_positions[m_periodic_indices[i - m_positions.size()]];
+        pos += m_periodic_shifts[i - m_positions.size()];
+        return pos;
+    }
+
+    template <std::size_t dim>
+    double sphere_container<dim>::radius(std::size_t i) const
+    {
+        return (i < m_positions.size()) ? m_radii[i] : m_radii[m_periodic_indices[i - m_positions.size()]];
+    }
+
+    template <std::size_t dim>
+    double sphere_container<dim>::bounding_radius(std::size_t i) const
+    {
+        return radius(i);
+    }
+
+    template <std::size_t dim>
+    double sphere_container<dim>::max_bounding_radius() const
+    {
+        return m_max_radius;
+    }
+
+    template <std::size_t dim>
+    bool sphere_container<dim>::is_plane(std::size_t i) const
+    {
+        // the periodic images are images of active particles, which are spheres
+        return i < m_is_plane.size() && m_is_plane[i];
+    }
+
+    template <std::size_t dim>
+    bool sphere_container<dim>::is_sphere(std::size_t i) const
+    {
+        return !is_plane(i);
+    }
+
+    template <std::size_t dim>
+    shape_tag_t sphere_container<dim>::particle_tag(std::size_t i) const
+    {
+        return is_plane(i) ? shape_tag_v<plane<dim, false>> : shape_tag_v<sphere<dim, false>>;
+    }
+
+    /**
+     * @brief Whether a container only has spheres and planes.
+     *
+     * @tparam particles_t Type of the container.
+     */
+    template <class particles_t>
+    struct is_sphere_container : std::false_type
+    {
+    };
+
+    template <std::size_t dim>
+    struct is_sphere_container<sphere_container<dim>> : std::true_type
+    {
+    };
+
+    /**
+     * @brief Write a sphere or a plane of a sphere_container in json format.
+     *
+     * The output is the same as write_objects for a sphere or a plane, but it is written from the arrays of the container.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @param particles [in] Array of particles.
+     * @param i [in] Index of the particle.
+     *
+     * @return Json object.
+     */
+    template <std::size_t dim>
+    nl::json write_objects(const sphere_container<dim>& particles, std::size_t i)
+    {
+        nl::json object;
+
+        const auto rotation = rotation_matrix<dim>(particles.q()(i));
+        if (particles.is_plane(i))
+        {
+            object["type"]   = "plane";
+            object["normal"] = xt::eval(xt::view(rotation, xt::all(), 0));
+        }
+        else
+        {
+            object["type"]   = "sphere";
+            object["radius"] = particles.radius(i);
+        }
+        object["id"]         = particles.particle_id(i);
+        object["position"]   = particles.pos()(i);
+        object["rotation"]   = xt::flatten(rotation);
+        object["quaternion"] = particles.q()(i);
+
+        return object;
+    }
+}
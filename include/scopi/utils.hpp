@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -62,61 +63,6 @@ std::vector<double> create_binit(std::vector<double> binit, int n, double theta_
  */
 int sign(double val);
 
-template <typename F, typename DF, typename U, typename A>
-/**
- * @brief Newton method (with linesearch).
- *
- * \todo Write documentation.
- *
- * @param u0
- * @param f
- * @param grad_f
- * @param args
- * @param itermax
- * @param ftol
- * @param xtol
- *
- * @return
- */
-auto newton_method(U u0, F f, DF grad_f, A args, int itermax, double ftol, double xtol)
-{
-    // std::cout << "newton_method : u0 = " << u0 << std::endl;
-    // std::cout << "newton_method : args = " << args << std::endl;
-    int cc = 0;
-    auto u = u0;
-    while (cc < itermax)
-    {
-        auto d   = xt::linalg::solve(grad_f(u, args), -f(u, args));
-        auto var = xt::linalg::norm(d);
-        if (var < xtol)
-        {
-            // std::cout << "newton_method : cvgce (xtol) after " << cc << " iterations => RETURN u = " << u << std::endl;
-            return std::make_tuple(u, cc);
-        }
-        // std::cout << "newton_method : iteration " << cc << " => d = " << d << " var = " << var << std::endl;
-        // linesearch
-        double t  = 1;
-        auto ferr = xt::linalg::norm(f(u, args));
-        // std::cout << "newton_method : iteration " << cc << " => ferr = " << ferr << std::endl;
-        if (ferr < ftol)
-        {
-            // std::cout << "newton_method : cvgce (ftol) after " << cc << " iterations => RETURN u = " << u << std::endl;
-            return std::make_tuple(u, cc);
-        }
-        while ((xt::linalg::norm(f(u + t * d, args)) > ferr) && (t > 0.01))
-        {
-            t -= 0.01;
-        }
-        // std::cout << "newton_method : iteration " << cc << " => t = " << t << std::endl;
-        u += t * d;
-        // std::cout << "newton_method : iteration " << cc << " => u = " << u << std::endl;
-        cc += 1;
-    }
-    PLOG_ERROR << "newton_method : !!!!!! FAILED !!!!!! after " << cc << " iterations => RETURN u = " << u;
-
-    return std::make_tuple(u, -1);
-}
-
 namespace scopi
 {
     // namespace detail
@@ -222,36 +168,98 @@ namespace scopi
     template <std::size_t dim>
     class BoxDomain;
 
-    template <std::size_t dim>
-    class scopi_container;
+    /**
+     * @brief Distance to the boundary under which a particle has a periodic image.
+     *
+     * Two particles closer than \c dmax have their centers closer than \c dmax + 2 \c rmax in each direction, where \c rmax is the
+     * largest bounding radius of the active particles. If they are in contact through a periodic boundary, at least one of them is closer
+     * than \c dmax / 2 + \c rmax to the boundary.
+     *
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+     * @param particles [in] Array of particles.
+     * @param dmax [in] Maximum distance between two neighboring particles.
+     *
+     * @return Margin.
+     */
+    template <class particles_t>
+    double periodic_margin(const particles_t& particles, double dmax)
+    {
+        return 0.5 * dmax + particles.max_bounding_radius();
+    }
 
-    template <std::size_t dim>
-    void add_objects_from_periodicity(const BoxDomain<dim>& box, scopi_container<dim>& particles, double dmax)
+    /**
+     * @brief Whether a particle has a periodic image with a given shift in one direction.
+     *
+     * A particle close to the lower boundary has an image shifted by \f$ +L \f$ and a particle close to the upper boundary has an image
+     * shifted by \f$ -L \f$, where \f$ L \f$ is the length of the domain.
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam position_t Type of the position.
+     * @param box [in] Simulation domain.
+     * @param pos [in] Position of the particle.
+     * @param d [in] Direction.
+     * @param shift [in] Shift in the direction \c d.
+     * @param margin [in] Margin (see periodic_margin).
+     */
+    template <std::size_t dim, class position_t>
+    bool has_periodic_image(const BoxDomain<dim>& box, const position_t& pos, std::size_t d, double shift, double margin)
     {
-        using position_t = typename scopi_container<dim>::position_type;
-        for (std::size_t d = 0; d < dim; ++d)
+        return (shift > 0.) ? pos(d) < box.lower_bound(d) + margin : pos(d) > box.upper_bound(d) - margin;
+    }
+
+    /**
+     * @brief Add the periodic images of the active particles.
+     *
+     * A particle closer than periodic_margin to a periodic boundary has an image on the other side of the domain. The images are created
+     * for both the lower and the upper boundaries, and a particle in a corner has an image for each combination of shifts.
+     * Only the index of the particle and the shift are stored (see scopi_container::add_periodic_image).
+     *
+     * @tparam dim Dimension (2 or 3).
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
+     * @param box [in] Simulation domain.
+     * @param particles [inout] Array of particles.
+     * @param dmax [in] Maximum distance between two neighboring particles.
+     */
+    template <std::size_t dim, class particles_t>
+    void add_objects_from_periodicity(const BoxDomain<dim>& box, particles_t& particles, double dmax)
+    {
+        using position_t    = typename particles_t::position_type;
+        const double margin = periodic_margin(particles, dmax);
+
+        for (std::size_t i = particles.nb_inactive(); i < particles.periodic_ptr(); ++i)
         {
-            if (box.is_periodic(d))
+            // the shifts in each direction: 0, L if the particle is close to the lower boundary and -L if it is close to the upper one
+            std::array<std::array<double, 3>, dim> shifts;
+            std::array<std::size_t, dim> nshifts;
+            std::size_t ncombinations = 1;
+            for (std::size_t d = 0; d < dim; ++d)
             {
-                for (std::size_t io = 0; io < particles.size(/*with_periodic = */ false); ++io)
+                shifts[d][0] = 0.;
+                nshifts[d]   = 1;
+                if (box.is_periodic(d))
                 {
-                    for (std::size_t offset = particles.offset(io); offset < particles.offset(io + 1); ++offset)
+                    const double length = box.upper_bound(d) - box.lower_bound(d);
+                    if (has_periodic_image(box, particles.pos()(i), d, length, margin))
+                    {
+                        shifts[d][nshifts[d]++] = length;
+                    }
+                    if (has_periodic_image(box, particles.pos()(i), d, -length, margin))
                     {
-                        const auto& p_pos = particles.pos()[offset];
-                        if (p_pos[d] - dmax < box.lower_bound(d))
-                        {
-                            auto size = particles.offset(io + 1) - particles.offset(io);
-                            std::vector<position_t> newp_pos(size);
-                            for (std::size_t i = 0, ii = particles.offset(io); i < size; ++i, ++ii)
-                            {
-                                newp_pos[i] = particles.pos()[ii];
-                                newp_pos[i][d] += box.upper_bound(d) - box.lower_bound(d);
-                            }
-                            particles.push_back(io, newp_pos);
-                            break;
-                        }
+                        shifts[d][nshifts[d]++] = -length;
                     }
                 }
+                ncombinations *= nshifts[d];
+            }
+
+            // the combination 0 is the particle itself
+            for (std::size_t c = 1; c < ncombinations; ++c)
+            {
+                position_t shift;
+                for (std::size_t d = 0, k = c; d < dim; k /= nshifts[d], ++d)
+                {
+                    shift(d) = shifts[d][k % nshifts[d]];
+                }
+                particles.add_periodic_image(i, shift);
             }
         }
     }
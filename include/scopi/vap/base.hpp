@@ -23,12 +23,12 @@ namespace scopi
         /**
          * @brief Compute the a priori velocity.
          *
-         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [out] Array of particles.
          * @param contacts [in] Array of contacts.
          */
-        template <std::size_t dim, class Contacts>
-        void set_a_priori_velocity(double dt, scopi_container<dim>& particles, const Contacts& contacts);
+        template <class particles_t, class Contacts>
+        void set_a_priori_velocity(double dt, particles_t& particles, const Contacts& contacts);
 
         params_t& get_params();
 
@@ -38,8 +38,8 @@ namespace scopi
     };
 
     template <class D>
-    template <std::size_t dim, class Contacts>
-    void vap_base<D>::set_a_priori_velocity(double dt, scopi_container<dim>& particles, const Contacts& contacts)
+    template <class particles_t, class Contacts>
+    void vap_base<D>::set_a_priori_velocity(double dt, particles_t& particles, const Contacts& contacts)
     {
         tic();
         this->derived_cast().set_a_priori_velocity_impl(dt, particles, contacts);
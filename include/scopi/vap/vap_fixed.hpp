@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base.hpp"
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 
@@ -34,23 +35,28 @@ namespace scopi
         /**
          * @brief Compute the fixed a priori velocity.
          *
-         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [out] Array of particles.
          * @param contacts [in] Array of contacts.
          */
-        template <std::size_t dim, class Contacts>
-        void set_a_priori_velocity_impl(double dt, scopi_container<dim>& particles, const Contacts& contacts);
+        template <class particles_t, class Contacts>
+        void set_a_priori_velocity_impl(double dt, particles_t& particles, const Contacts& contacts);
     };
 
-    template <std::size_t dim, class Contacts>
-    void vap_fixed::set_a_priori_velocity_impl(double, scopi_container<dim>& particles, const Contacts&)
+    template <class particles_t, class Contacts>
+    void vap_fixed::set_a_priori_velocity_impl(double, particles_t& particles, const Contacts&)
     {
+        constexpr std::size_t dim = particles_t::dim;
+
         auto active_ptr = particles.nb_inactive();
         auto nb_active  = particles.nb_active();
-        for (std::size_t i = active_ptr; i < active_ptr + nb_active; ++i)
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            std::copy_n(particles.vd().column(d) + active_ptr, nb_active, particles.v().column(d) + active_ptr);
+        }
+        for (std::size_t d = 0; d < particles_t::rotation_size; ++d)
         {
-            particles.v()(i)     = particles.vd()(i);
-            particles.omega()(i) = particles.desired_omega()(i);
+            std::copy_n(particles.desired_omega().column(d) + active_ptr, nb_active, particles.omega().column(d) + active_ptr);
         }
     }
 }
@@ -35,46 +35,71 @@ namespace scopi
          *
          * \todo External momentum is missing.
          *
-         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [out] Array of particles.
          * @param contacts [in] Array of contacts.
          */
-        template <std::size_t dim, class Contacts>
-        void set_a_priori_velocity_impl(double dt, scopi_container<dim>& particles, const Contacts& contacts);
+        template <class particles_t, class Contacts>
+        void set_a_priori_velocity_impl(double dt, particles_t& particles, const Contacts& contacts);
     };
 
     /**
      * @brief Compute the product \f$\vec{\omega'}^n \land ( \mathbb{J} \vec{\omega'}^n ) \f$.
      *
-     * 2D implementation.
+     * The product is zero in 2D.
      *
+     * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
      * @param particles [in] Particles, to access \f$ \vec{\omega'}^n \f$.
      * @param i [in] Index of the particle.
      *
      * @return
      */
-    type::moment_t<2> cross_product_vap_fpd(const scopi_container<2>& particles, std::size_t i);
-    /**
-     * @brief Compute the product \f$\vec{\omega'}^n \land ( \mathbb{J} \vec{\omega'}^n ) \f$.
-     *
-     * 3D implementation.
-     *
-     * @param particles [in] Particles, to access \f$ \vec{\omega'}^n \f$.
-     * @param i [in] Index of the particle.
-     *
-     * @return
-     */
-    type::moment_t<3> cross_product_vap_fpd(const scopi_container<3>& particles, std::size_t i);
+    template <class particles_t>
+    type::moment_t<particles_t::dim> cross_product_vap_fpd(const particles_t& particles, std::size_t i)
+    {
+        if constexpr (particles_t::dim == 2)
+        {
+            return 0.;
+        }
+        else
+        {
+            double omega_1 = particles.omega()(i)[0];
+            double omega_2 = particles.omega()(i)[1];
+            double omega_3 = particles.omega()(i)[2];
+            double j1      = particles.j()(i)[0];
+            double j2      = particles.j()(i)[1];
+            double j3      = particles.j()(i)[2];
+
+            type::moment_t<3> res;
+            res[0] = omega_2 * omega_3 * (j3 - j2);
+            res[1] = omega_1 * omega_3 * (j1 - j3);
+            res[2] = omega_1 * omega_2 * (j2 - j1);
+
+            return res;
+        }
+    }
 
-    template <std::size_t dim, class Contacts>
-    void vap_fpd::set_a_priori_velocity_impl(double dt, scopi_container<dim>& particles, const Contacts&)
+    template <class particles_t, class Contacts>
+    void vap_fpd::set_a_priori_velocity_impl(double dt, particles_t& particles, const Contacts&)
     {
+        constexpr std::size_t dim = particles_t::dim;
+
         auto active_ptr = particles.nb_inactive();
         auto nb_active  = particles.nb_active();
+        const double* m = particles.m().column(0);
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            double* v_d       = particles.v().column(d);
+            const double* f_d = particles.f().column(d);
+#pragma omp parallel for
+            for (std::size_t i = active_ptr; i < active_ptr + nb_active; ++i)
+            {
+                v_d[i] += dt * f_d[i] / m[i];
+            }
+        }
 #pragma omp parallel for
         for (std::size_t i = active_ptr; i < active_ptr + nb_active; ++i)
         {
-            particles.v()(i) += dt * particles.f()(i) / particles.m()(i);
             // check cross_product (division by J in the formula missing) and add a torque
             particles.omega()(i) += cross_product_vap_fpd(particles, i);
         }
@@ -32,12 +32,12 @@ namespace scopi
         /**
          * @brief Compute the fixed a priori velocity.
          *
-         * @tparam dim Dimension (2 or 3).
+         * @tparam particles_t Type of the array of particles (scopi_container or sphere_container).
          * @param particles [out] Array of particles.
          * @param contacts [in] Array of contacts.
          */
-        template <std::size_t dim, class Contacts>
-        void set_a_priori_velocity_impl(double dt, scopi_container<dim>& particles, const Contacts& contacts_pos);
+        template <class particles_t, class Contacts>
+        void set_a_priori_velocity_impl(double dt, particles_t& particles, const Contacts& contacts_pos);
 
         /**
          * @brief Update \c u and \c w.
@@ -63,9 +63,11 @@ namespace scopi
         xt::xtensor<double, 2> m_w;
     };
 
-    template <std::size_t dim, class Contacts>
-    void vap_projection::set_a_priori_velocity_impl(double, scopi_container<dim>& particles, const Contacts&)
+    template <class particles_t, class Contacts>
+    void vap_projection::set_a_priori_velocity_impl(double, particles_t& particles, const Contacts&)
     {
+        constexpr std::size_t dim = particles_t::dim;
+
         auto active_ptr = particles.nb_inactive();
         auto nb_active  = particles.nb_active();
 
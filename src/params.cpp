@@ -1,6 +1,9 @@
 #include "scopi/params.hpp"
 #include "scopi/scopi.hpp"
 
+#include <map>
+#include <string>
+
 namespace scopi
 {
     ScopiParams::ScopiParams()
@@ -9,6 +12,8 @@ namespace scopi
         , filename("scopi_objects")
         , write_velocity(false)
         , binary_output(false)
+        , reorder_frequency(std::size_t(-1))
+        , reorder_curve(space_filling_curve::hilbert)
     {
     }
 
@@ -23,6 +28,15 @@ namespace scopi
             opt->add_option("--freq", output_frequency, "Output frequency (in iterations)")->capture_default_str();
             opt->add_flag("--write-velocity", write_velocity, "Write the velocity of objects")->capture_default_str();
             opt->add_flag("--binary-output", binary_output, "Write bson output file instead of json")->capture_default_str();
+
+            std::map<std::string, space_filling_curve> curves{
+                {"morton",  space_filling_curve::morton },
+                {"hilbert", space_filling_curve::hilbert}
+            };
+            opt->add_option("--reorder-freq", reorder_frequency, "Frequency to sort the particles along a curve (in iterations)")
+                ->capture_default_str();
+            opt->add_option("--reorder-curve", reorder_curve, "Space-filling curve used to sort the particles")
+                ->transform(CLI::CheckedTransformer(curves, CLI::ignore_case));
         }
     }
 
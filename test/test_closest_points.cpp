@@ -1,6 +1,7 @@
 #include "utils.hpp"
 #include <doctest/doctest.h>
 
+#include <scopi/contact/contact_brute_force.hpp>
 #include <scopi/contact/property.hpp>
 #include <scopi/container.hpp>
 #include <scopi/objects/methods/closest_points.hpp>
@@ -2301,6 +2302,303 @@ namespace scopi
     //     REQUIRE(out.dij == doctest::Approx(0.2));
     // }
 
+    // distance superellipsoid - superellipsoid
+    TEST_CASE("superellipsoid_superellipsoid_2d_warm_start")
+    {
+        constexpr std::size_t dim = 2;
+        superellipsoid<dim> s1(
+            {
+                {-0.2, 0.}
+        },
+            {quaternion(PI / 4)},
+            {{.1, .05}},
+            1);
+        superellipsoid<dim> s2(
+            {
+                {0.2, 0.}
+        },
+            {quaternion(-PI / 4)},
+            {{.1, .05}},
+            1);
+        superellipsoid<dim> s3(
+            {
+                {0.19, 0.01}
+        },
+            {quaternion(-PI / 4 + 0.01)},
+            {{.1, .05}},
+            1);
+
+        auto cold = closest_points<NoFriction>(s1, s2);
+        REQUIRE(cold.u.valid);
+
+        SUBCASE("same position")
+        {
+            auto warm = closest_points<NoFriction>(s1, s2, &cold.u);
+            REQUIRE(warm.dij == doctest::Approx(cold.dij));
+            REQUIRE(warm.u.u[0] == doctest::Approx(cold.u.u[0]));
+            REQUIRE(warm.u.u[1] == doctest::Approx(cold.u.u[1]));
+        }
+
+        SUBCASE("next time step")
+        {
+            auto expected = closest_points<NoFriction>(s1, s3);
+            auto warm     = closest_points<NoFriction>(s1, s3, &cold.u);
+            REQUIRE(warm.dij == doctest::Approx(expected.dij));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                REQUIRE(warm.pi(d) == doctest::Approx(expected.pi(d)));
+                REQUIRE(warm.pj(d) == doctest::Approx(expected.pj(d)));
+                REQUIRE(warm.nij(d) == doctest::Approx(expected.nij(d)));
+            }
+        }
+    }
+
+    TEST_CASE("superellipsoid_superellipsoid_3d_warm_start")
+    {
+        constexpr std::size_t dim = 3;
+        const xt::xtensor_fixed<double, xt::xshape<3>> axis{0., 0.6, 0.8};
+        superellipsoid<dim> s1(
+            {
+                {-0.2, 0., 0.}
+        },
+            {quaternion(PI / 6, axis)},
+            {{0.1, 0.15, 0.12}},
+            {1, 1});
+        superellipsoid<dim> s2(
+            {
+                {0.2, 0.02, 0.}
+        },
+            {quaternion(-PI / 5, axis)},
+            {{0.12, 0.1, 0.15}},
+            {1, 1});
+        superellipsoid<dim> s3(
+            {
+                {0.19, 0.03, 0.01}
+        },
+            {quaternion(-PI / 5 + 0.01, axis)},
+            {{0.12, 0.1, 0.15}},
+            {1, 1});
+
+        auto cold = closest_points<NoFriction>(s1, s2);
+        REQUIRE(cold.u.valid);
+
+        SUBCASE("same position")
+        {
+            auto warm = closest_points<NoFriction>(s1, s2, &cold.u);
+            REQUIRE(warm.dij == doctest::Approx(cold.dij));
+            for (std::size_t k = 0; k < 4; ++k)
+            {
+                REQUIRE(warm.u.u[k] == doctest::Approx(cold.u.u[k]));
+            }
+        }
+
+        SUBCASE("next time step")
+        {
+            auto expected = closest_points<NoFriction>(s1, s3);
+            auto warm     = closest_points<NoFriction>(s1, s3, &cold.u);
+            REQUIRE(warm.dij == doctest::Approx(expected.dij));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                REQUIRE(warm.pi(d) == doctest::Approx(expected.pi(d)));
+                REQUIRE(warm.pj(d) == doctest::Approx(expected.pj(d)));
+                REQUIRE(warm.nij(d) == doctest::Approx(expected.nij(d)));
+            }
+        }
+    }
+
+    TEST_CASE("superellipsoid_superellipsoid_2d_warm_start_contacts")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        superellipsoid<dim> s1(
+            {
+                {-0.2, 0.}
+        },
+            {quaternion(PI / 4)},
+            {{.1, .05}},
+            1);
+        superellipsoid<dim> s2(
+            {
+                {0.2, 0.}
+        },
+            {quaternion(-PI / 4)},
+            {{.1, .05}},
+            1);
+        particles.push_back(s1);
+        particles.push_back(s2);
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force<NoFriction> cont(params);
+
+        // the first call has no previous time step and fills the cache
+        auto contacts = cont.run(particles, 0);
+        REQUIRE(contacts.size() == 1);
+        const auto& cache = cont.get_closest_points_cache();
+        REQUIRE(cache.size() == 1);
+        const surface_parameters* guess = cache.find(0, 1);
+        REQUIRE(guess != nullptr);
+        REQUIRE(guess->valid);
+        REQUIRE(guess->u[0] == doctest::Approx(contacts[0].u.u[0]));
+        REQUIRE(guess->u[1] == doctest::Approx(contacts[0].u.u[1]));
+
+        // the next call starts from the cache and finds the same closest points as without it
+        particles.pos()(1)(0) -= 0.01;
+        particles.pos()(1)(1) += 0.01;
+        particles.q()(1) = quaternion(-PI / 4 + 0.01);
+        auto warm        = cont.run(particles, 0);
+        contact_brute_force<NoFriction> cold_cont(params);
+        auto cold = cold_cont.run(particles, 0);
+        REQUIRE(warm.size() == 1);
+        REQUIRE(cold.size() == 1);
+        REQUIRE(warm[0].dij == doctest::Approx(cold[0].dij));
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            REQUIRE(warm[0].pi(d) == doctest::Approx(cold[0].pi(d)));
+            REQUIRE(warm[0].pj(d) == doctest::Approx(cold[0].pj(d)));
+            REQUIRE(warm[0].nij(d) == doctest::Approx(cold[0].nij(d)));
+        }
+        REQUIRE(cache.find(0, 1)->u[0] == doctest::Approx(warm[0].u.u[0]));
+    }
+
+    class NoFrictionGjk
+    {
+    };
+
+    template <>
+    struct contact_property<NoFrictionGjk> : contact_property<NoFriction>
+    {
+    };
+
+    template <>
+    struct superellipsoid_closest_points<NoFrictionGjk>
+    {
+        static constexpr superellipsoid_method value = superellipsoid_method::gjk;
+    };
+
+    TEST_CASE("superellipsoid_superellipsoid_2d_gjk")
+    {
+        constexpr std::size_t dim = 2;
+
+        SUBCASE("separated")
+        {
+            superellipsoid<dim> s1(
+                {
+                    {-0.2, 0.0}
+            },
+                {quaternion(0.)},
+                {{0.1, 0.2}},
+                1);
+            superellipsoid<dim> s2(
+                {
+                    {0.2, 0.0}
+            },
+                {quaternion(0.)},
+                {{0.1, 0.3}},
+                1);
+
+            auto out = closest_points<NoFrictionGjk>(s1, s2);
+
+            REQUIRE(out.pi(0) == doctest::Approx(-0.1));
+            REQUIRE(out.pi(1) == doctest::Approx(0.));
+            REQUIRE(out.pj(0) == doctest::Approx(0.1));
+            REQUIRE(out.pj(1) == doctest::Approx(0.));
+            REQUIRE(out.nij(0) == doctest::Approx(-1.));
+            REQUIRE(out.nij(1) == doctest::Approx(0.));
+            REQUIRE(out.dij == doctest::Approx(0.2));
+        }
+
+        SUBCASE("overlap")
+        {
+            superellipsoid<dim> s1(
+                {
+                    {-0.05, 0.0}
+            },
+                {quaternion(0.)},
+                {{0.1, 0.2}},
+                1);
+            superellipsoid<dim> s2(
+                {
+                    {0.05, 0.0}
+            },
+                {quaternion(0.)},
+                {{0.1, 0.3}},
+                1);
+
+            auto out = closest_points<NoFrictionGjk>(s1, s2);
+
+            REQUIRE(out.pi(0) == doctest::Approx(0.05));
+            REQUIRE(out.pi(1) == doctest::Approx(0.));
+            REQUIRE(out.pj(0) == doctest::Approx(-0.05));
+            REQUIRE(out.pj(1) == doctest::Approx(0.));
+            REQUIRE(out.nij(0) == doctest::Approx(-1.));
+            REQUIRE(out.nij(1) == doctest::Approx(0.));
+            REQUIRE(out.dij == doctest::Approx(-0.1));
+        }
+
+        SUBCASE("same as newton")
+        {
+            superellipsoid<dim> s1(
+                {
+                    {-0.2, 0.}
+            },
+                {quaternion(PI / 4)},
+                {{.1, .05}},
+                0.5);
+            superellipsoid<dim> s2(
+                {
+                    {0.2, 0.}
+            },
+                {quaternion(-PI / 3)},
+                {{.1, .05}},
+                1.5);
+
+            auto expected = closest_points<NoFriction>(s1, s2);
+            auto out      = closest_points<NoFrictionGjk>(s1, s2);
+            auto warm     = closest_points<NoFrictionGjk>(s1, s2, &out.u);
+            REQUIRE(out.dij == doctest::Approx(expected.dij));
+            REQUIRE(warm.dij == doctest::Approx(expected.dij));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                REQUIRE(out.pi(d) == doctest::Approx(expected.pi(d)));
+                REQUIRE(out.pj(d) == doctest::Approx(expected.pj(d)));
+                REQUIRE(out.nij(d) == doctest::Approx(expected.nij(d)));
+            }
+        }
+    }
+
+    TEST_CASE("superellipsoid_superellipsoid_3d_gjk")
+    {
+        constexpr std::size_t dim = 3;
+        superellipsoid<dim> s1(
+            {
+                {-0.2, 0.0, 0.0}
+        },
+            {quaternion(0.)},
+            {{0.1, 0.2, 0.3}},
+            {0.5, 1.5});
+        superellipsoid<dim> s2(
+            {
+                {0.2, 0.0, 0.0}
+        },
+            {quaternion(0.)},
+            {{0.1, 0.2, 0.3}},
+            {1.5, 0.5});
+
+        auto out = closest_points<NoFrictionGjk>(s1, s2);
+
+        REQUIRE(out.pi(0) == doctest::Approx(-0.1));
+        REQUIRE(out.pi(1) == doctest::Approx(0.));
+        REQUIRE(out.pi(2) == doctest::Approx(0.));
+        REQUIRE(out.pj(0) == doctest::Approx(0.1));
+        REQUIRE(out.pj(1) == doctest::Approx(0.));
+        REQUIRE(out.pj(2) == doctest::Approx(0.));
+        REQUIRE(out.nij(0) == doctest::Approx(-1.));
+        REQUIRE(out.nij(1) == doctest::Approx(0.));
+        REQUIRE(out.nij(2) == doctest::Approx(0.));
+        REQUIRE(out.dij == doctest::Approx(0.2));
+    }
+
     // distance globule - globule
     void check_neigh_globule_globule(neighbor<2, NoFriction>& out, double pi, double pj, double dij)
     {
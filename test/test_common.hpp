@@ -21,7 +21,12 @@
 #include <scopi/solvers/apgd.hpp>
 
 #include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_bvh.hpp>
+#include <scopi/contact/contact_cell_list.hpp>
 #include <scopi/contact/contact_kdtree.hpp>
+#include <scopi/contact/contact_sweep_and_prune.hpp>
+
+#include <scopi/objects/types/sphere.hpp>
 
 #include <scopi/vap/vap_fixed.hpp>
 #include <scopi/vap/vap_fpd.hpp>
@@ -62,11 +67,66 @@ namespace scopi
 
     template <std::size_t dim, class vap = vap_fixed>
     using solver_dry_without_friction_t = tuple_cat_t<solver_t<dim, NoFriction, contact_kdtree, vap>,
-                                                      solver_t<dim, NoFriction, contact_brute_force, vap>>;
+                                                      solver_t<dim, NoFriction, contact_brute_force, vap>,
+                                                      solver_t<dim, NoFriction, contact_cell_list, vap>,
+                                                      solver_t<dim, NoFriction, contact_sweep_and_prune, vap>,
+                                                      solver_t<dim, NoFriction, contact_bvh, vap>>;
 
     template <std::size_t dim, class vap>
     using solver_dry_with_friction_t = std::tuple<ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_kdtree, vap>,
-                                                  ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_brute_force, vap>>;
+                                                  ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_brute_force, vap>,
+                                                  ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_cell_list, vap>,
+                                                  ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_sweep_and_prune, vap>,
+                                                  ScopiSolver<dim, Friction, OptimGradient<apgd>, contact_bvh, vap>>;
+
+    // contact methods compared with contact_brute_force
+    using contact_methods_t = std::tuple<contact_cell_list<NoFriction>, contact_sweep_and_prune<NoFriction>, contact_bvh<NoFriction>>;
+
+    // 10 x 10 spheres of two sizes, with many contacts
+    inline void fill_contacts_pile(scopi_container<2>& particles)
+    {
+        constexpr std::size_t dim = 2;
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            for (std::size_t j = 0; j < 10; ++j)
+            {
+                double r = (i + j) % 2 == 0 ? 0.3 : 0.5;
+                sphere<dim> s(
+                    {
+                        {1.1 * static_cast<double>(i) + 0.05 * static_cast<double>(j % 3), 1.2 * static_cast<double>(j)}
+                },
+                    r);
+                particles.push_back(s);
+            }
+        }
+    }
+
+    // the pile of fill_contacts_pile moved so that the order of the particles along x changes
+    inline void shuffle_contacts_pile(scopi_container<2>& particles)
+    {
+        for (std::size_t i = 0; i < particles.nb_particles(); ++i)
+        {
+            particles.pos()(i)(0) += (i % 2 == 0) ? 0.4 : -0.4;
+        }
+    }
+
+    template <class Contacts>
+    void check_same_contacts(const Contacts& contacts, const Contacts& reference)
+    {
+        REQUIRE(contacts.size() == reference.size());
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
+        {
+            CHECK(contacts[ic].i == reference[ic].i);
+            CHECK(contacts[ic].j == reference[ic].j);
+            CHECK(contacts[ic].dij == doctest::Approx(reference[ic].dij));
+            for (std::size_t d = 0; d < contacts[ic].nij.size(); ++d)
+            {
+                CHECK(contacts[ic].nij(d) == doctest::Approx(reference[ic].nij(d)));
+                CHECK(contacts[ic].pi(d) == doctest::Approx(reference[ic].pi(d)));
+                CHECK(contacts[ic].pj(d) == doctest::Approx(reference[ic].pj(d)));
+            }
+        }
+    }
 
 }
 
@@ -1,9 +1,11 @@
+#include "test_common.hpp"
 #include "utils.hpp"
 #include <doctest/doctest.h>
 
 #include <scopi/contact/contact_brute_force.hpp>
 #include <scopi/contact/property.hpp>
 #include <scopi/container.hpp>
+#include <scopi/objects/types/plane.hpp>
 #include <scopi/objects/types/sphere.hpp>
 #include <scopi/objects/types/superellipsoid.hpp>
 
@@ -69,4 +71,255 @@ namespace scopi
         }
     }
 
+    TEST_CASE("Contacts brute force with obstacles")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        sphere<dim> obstacle(
+            {
+                {-5., 5.}
+        },
+            1.);
+        sphere<dim> s1(
+            {
+                {0., 1.5}
+        },
+            1.);
+        sphere<dim> s2(
+            {
+                {10., 10.}
+        },
+            1.);
+        sphere<dim> s3(
+            {
+                {-5., 7.5}
+        },
+            1.);
+
+        particles.push_back(p, property<dim>().deactivate());
+        particles.push_back(obstacle, property<dim>().deactivate());
+        particles.push_back(s1);
+        particles.push_back(s2);
+        particles.push_back(s3);
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force cont(params);
+        auto contacts = cont.run(particles, 2);
+
+        REQUIRE(contacts.size() == 2);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 2);
+        CHECK(contacts[0].dij == doctest::Approx(0.5));
+        CHECK(contacts[1].i == 1);
+        CHECK(contacts[1].j == 4);
+        CHECK(contacts[1].dij == doctest::Approx(0.5));
+    }
+
+    TEST_CASE("Sort contacts")
+    {
+        constexpr std::size_t dim = 2;
+        std::vector<neighbor<dim, NoFriction>> contacts(100);
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
+        {
+            contacts[ic].i   = (37 * ic) % 10;
+            contacts[ic].j   = 10 + (13 * ic) % 100;
+            contacts[ic].dij = static_cast<double>(contacts[ic].i * 1000 + contacts[ic].j);
+        }
+
+        sort_contacts(contacts);
+
+        REQUIRE(contacts.size() == 100);
+        for (std::size_t ic = 1; ic < contacts.size(); ++ic)
+        {
+            CHECK((contacts[ic - 1].i < contacts[ic].i || (contacts[ic - 1].i == contacts[ic].i && contacts[ic - 1].j < contacts[ic].j)));
+        }
+        for (const auto& c : contacts)
+        {
+            CHECK(c.dij == doctest::Approx(static_cast<double>(c.i * 1000 + c.j)));
+        }
+    }
+
+    TEST_CASE("Contacts brute force with periodic images")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        sphere<dim> s1(
+            {
+                {0.7, 5.}
+        },
+            0.5);
+        sphere<dim> s2(
+            {
+                {9.5, 5.}
+        },
+            0.5);
+
+        particles.push_back(s1);
+        particles.push_back(s2);
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity(0);
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force cont(params);
+        auto contacts = cont.run(box, particles, 0);
+
+        // both particles have an image, but the contact is found once
+        REQUIRE(contacts.size() == 1);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(0.2));
+        CHECK(contacts[0].pj(0) == doctest::Approx(10.));
+        CHECK(particles.nb_particles() == 2);
+    }
+
+    TEST_CASE("Contacts brute force with a plane and periodic images")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        sphere<dim> s1(
+            {
+                {0.3, 0.6}
+        },
+            0.5);
+        sphere<dim> s2(
+            {
+                {9.2, 0.6}
+        },
+            0.5);
+
+        particles.push_back(p, property<dim>().deactivate());
+        particles.push_back(s1);
+        particles.push_back(s2);
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity(0);
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force cont(params);
+        auto contacts = cont.run(box, particles, 1);
+
+        // the images of s1 and s2 are also close to the plane, but each contact with the plane is found once
+        REQUIRE(contacts.size() == 3);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(0.1));
+        CHECK(contacts[1].i == 0);
+        CHECK(contacts[1].j == 2);
+        CHECK(contacts[1].dij == doctest::Approx(0.1));
+        CHECK(contacts[2].i == 1);
+        CHECK(contacts[2].j == 2);
+        CHECK(contacts[2].dij == doctest::Approx(0.1));
+    }
+
+    TEST_CASE("Contacts brute force with periodic images in a corner")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        // the contact is only seen between the image of s1 through x = 0 and the image of s2 through y = 10
+        sphere<dim> s1(
+            {
+                {0.1, 1.05}
+        },
+            0.5);
+        sphere<dim> s2(
+            {
+                {8.95, 9.9}
+        },
+            0.5);
+
+        particles.push_back(s1);
+        particles.push_back(s2);
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity();
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force cont(params);
+        auto contacts = cont.run(box, particles, 0);
+
+        REQUIRE(contacts.size() == 1);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(1.15 * std::sqrt(2.) - 1.));
+    }
+
+    TEST_CASE_TEMPLATE_DEFINE("Contacts", contact_t, contacts)
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        sphere<dim> s1(
+            {
+                {0., 0.}
+        },
+            0.1);
+        sphere<dim> s2(
+            {
+                {1., 1.}
+        },
+            0.2);
+        sphere<dim> s3(
+            {
+                {5., 10.}
+        },
+            0.1);
+
+        particles.push_back(s1);
+        particles.push_back(s2);
+        particles.push_back(s3);
+
+        ContactsParams<contact_t> params;
+        contact_t cont(params);
+        auto contacts = cont.run(particles, 0);
+
+        REQUIRE(contacts.size() == 1);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(std::sqrt(2.) - 0.1 - 0.2));
+        CHECK(contacts[0].nij(0) == doctest::Approx(-1. / std::sqrt(2.)));
+        CHECK(contacts[0].nij(1) == doctest::Approx(-1. / std::sqrt(2.)));
+        CHECK(contacts[0].pi(0) == doctest::Approx(0.1 * std::sqrt(2.) / 2.));
+        CHECK(contacts[0].pi(1) == doctest::Approx(0.1 * std::sqrt(2.) / 2.));
+        CHECK(contacts[0].pj(0) == doctest::Approx(1. - 0.2 * std::sqrt(2.) / 2.));
+        CHECK(contacts[0].pj(1) == doctest::Approx(1. - 0.2 * std::sqrt(2.) / 2.));
+    }
+
+    TEST_CASE_TEMPLATE_DEFINE("Contacts same as brute force", contact_t, contacts_same_as_brute_force)
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        fill_contacts_pile(particles);
+
+        ContactsParams<contact_t> params;
+        params.dmax = 0.5;
+        contact_t cont(params);
+
+        ContactsParams<contact_brute_force<NoFriction>> params_brute_force;
+        params_brute_force.dmax = 0.5;
+        contact_brute_force cont_brute_force(params_brute_force);
+
+        check_same_contacts(cont.run(particles, 0), cont_brute_force.run(particles, 0));
+    }
+
+    TEST_CASE_TEMPLATE_APPLY(contacts, contact_methods_t);
+    TEST_CASE_TEMPLATE_APPLY(contacts_same_as_brute_force, contact_methods_t);
 }
@@ -0,0 +1,44 @@
+#include "test_common.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <doctest/doctest.h>
+
+#include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_bvh.hpp>
+#include <scopi/contact/property.hpp>
+#include <scopi/container.hpp>
+
+namespace scopi
+{
+    // the same contacts as brute force are checked for all the methods in test_contacts_brute_force.cpp
+    TEST_CASE("Contacts BVH after the particles move")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        fill_contacts_pile(particles);
+
+        ContactsParams<contact_bvh<NoFriction>> params;
+        params.dmax = 0.5;
+        ContactsParams<contact_brute_force<NoFriction>> params_brute_force;
+        params_brute_force.dmax = 0.5;
+        contact_brute_force cont_brute_force(params_brute_force);
+
+        SUBCASE("refit")
+        {
+            // the tree built at the first call is only refitted
+            params.rebuild_ratio = 1e10;
+        }
+
+        SUBCASE("rebuild")
+        {
+            // the tree is rebuilt as soon as its volume grows
+            params.rebuild_ratio = 1.;
+        }
+
+        contact_bvh cont(params);
+        check_same_contacts(cont.run(particles, 0), cont_brute_force.run(particles, 0));
+
+        shuffle_contacts_pile(particles);
+        check_same_contacts(cont.run(particles, 0), cont_brute_force.run(particles, 0));
+    }
+}
@@ -71,4 +71,92 @@ namespace scopi
             REQUIRE(contacts[0].pj(1) == doctest::Approx(1. - 0.2 * std::sqrt(2.) / 2.));
         }
     }
+
+    TEST_CASE("Contacts Kd-tree Verlet list")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        sphere<dim> s1(
+            {
+                {0., 0.}
+        },
+            0.1);
+        sphere<dim> s2(
+            {
+                {1.6, 0.}
+        },
+            0.2);
+
+        particles.push_back(s1);
+        particles.push_back(s2);
+
+        ContactsParams<contact_kdtree<NoFriction>> params;
+        params.kd_tree_radius = 1.5 * 1.5;
+        params.verlet_skin    = 1.;
+        contact_kdtree cont(params);
+        auto contacts = cont.run(particles, 0);
+        CHECK(contacts.size() == 0);
+
+        // the displacement is smaller than half the skin, the candidates are reused
+        particles.pos()(1)(0) = 1.4;
+        contacts              = cont.run(particles, 0);
+        REQUIRE(contacts.size() == 1);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(1.4 - 0.1 - 0.2));
+
+        // the displacement is larger than half the skin, the candidates are searched again
+        particles.pos()(1)(0) = 10.;
+        contacts              = cont.run(particles, 0);
+        CHECK(contacts.size() == 0);
+    }
+
+    TEST_CASE("Contacts Kd-tree radius from the size of the particles")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        sphere<dim> s1(
+            {
+                {0., 0.}
+        },
+            5.);
+        sphere<dim> s2(
+            {
+                {6., 0.}
+        },
+            0.1);
+        sphere<dim> s3(
+            {
+                {0., 6.1}
+        },
+            0.1);
+        sphere<dim> s4(
+            {
+                {10., 10.}
+        },
+            0.1);
+
+        particles.push_back(s1);
+        particles.push_back(s2);
+        particles.push_back(s3);
+        particles.push_back(s4);
+
+        CHECK(particles.max_bounding_radius() == doctest::Approx(5.));
+        CHECK(particles.bounding_radius(1) == doctest::Approx(0.1));
+
+        ContactsParams<contact_kdtree<NoFriction>> params;
+        params.dmax = 1.;
+        contact_kdtree cont(params);
+        auto contacts = cont.run(particles, 0);
+
+        REQUIRE(contacts.size() == 2);
+        CHECK(contacts[0].i == 0);
+        CHECK(contacts[0].j == 1);
+        CHECK(contacts[0].dij == doctest::Approx(6. - 5. - 0.1));
+        CHECK(contacts[1].i == 0);
+        CHECK(contacts[1].j == 2);
+        CHECK(contacts[1].dij == doctest::Approx(6.1 - 5. - 0.1));
+    }
 }
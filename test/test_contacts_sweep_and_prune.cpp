@@ -0,0 +1,43 @@
+#include "test_common.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <doctest/doctest.h>
+
+#include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_sweep_and_prune.hpp>
+#include <scopi/contact/property.hpp>
+#include <scopi/container.hpp>
+
+namespace scopi
+{
+    // the same contacts as brute force are checked for all the methods in test_contacts_brute_force.cpp
+    TEST_CASE("Contacts sweep and prune when the order along the sweep axis changes")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        fill_contacts_pile(particles);
+
+        ContactsParams<contact_sweep_and_prune<NoFriction>> params;
+        params.dmax = 0.5;
+        ContactsParams<contact_brute_force<NoFriction>> params_brute_force;
+        params_brute_force.dmax = 0.5;
+        contact_brute_force cont_brute_force(params_brute_force);
+
+        SUBCASE("sweep along x")
+        {
+            params.sweep_axis = 0;
+        }
+
+        SUBCASE("sweep along y")
+        {
+            params.sweep_axis = 1;
+        }
+
+        contact_sweep_and_prune cont(params);
+        check_same_contacts(cont.run(particles, 0), cont_brute_force.run(particles, 0));
+
+        // the order of the previous time step is updated by the insertion sort
+        shuffle_contacts_pile(particles);
+        check_same_contacts(cont.run(particles, 0), cont_brute_force.run(particles, 0));
+    }
+}
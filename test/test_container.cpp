@@ -1,9 +1,13 @@
 #include "utils.hpp"
+#include <cstdint>
 #include <doctest/doctest.h>
 
+#include <scopi/contact/property.hpp>
 #include <scopi/container.hpp>
+#include <scopi/objects/methods/closest_points.hpp>
 #include <scopi/objects/types/sphere.hpp>
 #include <scopi/objects/types/superellipsoid.hpp>
+#include <scopi/objects/types/worm.hpp>
 
 #include <scopi/vap/vap_fpd.hpp>
 
@@ -134,6 +138,41 @@ namespace scopi
         {
             REQUIRE(cross_product_vap_fpd(particles, 0) == doctest::Approx(0.));
         }
+
+        SUBCASE("shape tags")
+        {
+            CHECK(particles.object_tag(0) == shape_tag_v<superellipsoid<dim, false>>);
+            CHECK(particles.object_tag(1) == shape_tag_v<sphere<dim, false>>);
+            CHECK(particles.particle_tag(1) == shape_tag_v<sphere<dim, false>>);
+            CHECK_FALSE(particles.is_sphere(0));
+            CHECK(particles.is_sphere(1));
+        }
+
+        SUBCASE("tag dispatch")
+        {
+            using dispatcher_t = closest_points_dispatcher<NoFriction, dim>;
+            auto out           = particles.visit_particle(0,
+                                                [&](const object<dim, false>& obj_0, shape_tag_t tag_0)
+                                                {
+                                                    return particles.visit_particle(1,
+                                                                                    [&](const object<dim, false>& obj_1, shape_tag_t tag_1)
+                                                                                    {
+                                                                                        return dispatcher_t::dispatch_tag<shape_types<dim>>(
+                                                                                            tag_0,
+                                                                                            obj_0,
+                                                                                            tag_1,
+                                                                                            obj_1);
+                                                                                    });
+                                                });
+            auto expected = dispatcher_t::dispatch(*particles[0], *particles[1]);
+            REQUIRE(out.dij == doctest::Approx(expected.dij));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                REQUIRE(out.pi(d) == doctest::Approx(expected.pi(d)));
+                REQUIRE(out.pj(d) == doctest::Approx(expected.pj(d)));
+                REQUIRE(out.nij(d) == doctest::Approx(expected.nij(d)));
+            }
+        }
     }
 
     TEST_CASE("Container 3d")
@@ -302,4 +341,260 @@ namespace scopi
             REQUIRE(cross_product_superellipsoid(2) == doctest::Approx(PI * PI / 12. * 0.1));
         }
     }
+
+    TEST_CASE("Container columns")
+    {
+        static constexpr std::size_t dim = 3;
+        scopi_container<dim> particles;
+        // more particles than the initial capacity of the columns
+        for (std::size_t i = 0; i < 20; ++i)
+        {
+            double x = static_cast<double>(i);
+            sphere<dim> s(
+                {
+                    {x, 0., 0.}
+            },
+                0.1);
+            particles.push_back(s,
+                                property<dim>()
+                                    .velocity({
+                                        {x, 2. * x, 3. * x}
+            })
+                                    .desired_velocity({{-x, -2. * x, -3. * x}})
+                                    .omega({{x, 0., 0.}})
+                                    .mass(x + 1.));
+        }
+
+        SUBCASE("alignment")
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(reinterpret_cast<std::uintptr_t>(particles.v().column(d)) % 64 == 0);
+                CHECK(reinterpret_cast<std::uintptr_t>(particles.omega().column(d)) % 64 == 0);
+            }
+            CHECK(reinterpret_cast<std::uintptr_t>(particles.m().column(0)) % 64 == 0);
+        }
+
+        SUBCASE("columns")
+        {
+            auto v = particles.v();
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                const double* v_d = v.column(d);
+                for (std::size_t i = 0; i < particles.size(); ++i)
+                {
+                    CHECK(v_d[i] == doctest::Approx(static_cast<double>((d + 1) * i)));
+                    CHECK(&v(i)(d) == v_d + i);
+                }
+            }
+            CHECK(particles.m().column(0)[19] == doctest::Approx(20.));
+        }
+
+        SUBCASE("assignment")
+        {
+            particles.v()(3) = particles.vd()(3);
+            particles.f()(3) = {1., 2., 3.};
+            particles.f()(4) = particles.f()(3) + particles.v()(3);
+            particles.f()(4) += particles.v()(3);
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(particles.v()(3)(d) == doctest::Approx(-3. * static_cast<double>(d + 1)));
+                CHECK(particles.f()(4)(d) == doctest::Approx(static_cast<double>(d + 1) - 6. * static_cast<double>(d + 1)));
+                // the other particles are not modified
+                CHECK(particles.v()(2)(d) == doctest::Approx(2. * static_cast<double>(d + 1)));
+            }
+        }
+    }
+
+    TEST_CASE("soa_array move")
+    {
+        soa_array<3> a;
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            double x = static_cast<double>(i);
+            a.push_back(soa_array<3>::value_type({x, 2. * x, 3. * x}));
+        }
+
+        soa_array<3> b(std::move(a));
+        REQUIRE(b.size() == 10);
+        CHECK(a.size() == 0);
+
+        // the moved-from array can be filled again
+        a.push_back(soa_array<3>::value_type({1., 2., 3.}));
+        REQUIRE(a.size() == 1);
+        for (std::size_t d = 0; d < 3; ++d)
+        {
+            CHECK(a.view()(0)(d) == doctest::Approx(static_cast<double>(d + 1)));
+            CHECK(b.view()(9)(d) == doctest::Approx(9. * static_cast<double>(d + 1)));
+        }
+
+        soa_array<3> c;
+        c = std::move(b);
+        REQUIRE(c.size() == 10);
+        CHECK(b.size() == 0);
+        b.push_back(soa_array<3>::value_type({4., 5., 6.}));
+        REQUIRE(b.size() == 1);
+        CHECK(b.view()(0)(2) == doctest::Approx(6.));
+        CHECK(c.view()(0)(1) == doctest::Approx(0.));
+    }
+
+    TEST_CASE("Container object index")
+    {
+        static constexpr std::size_t dim = 2;
+        sphere<dim> s1(
+            {
+                {0., 0.}
+        },
+            0.1);
+        worm<dim> w(
+            {
+                {4., 0.},
+                {2., 0.},
+                {3., 0.}
+        },
+            {{quaternion(0.)}, {quaternion(0.)}, {quaternion(0.)}},
+            0.5,
+            3);
+        sphere<dim> s2(
+            {
+                {1., 0.}
+        },
+            0.1);
+        scopi_container<dim> particles;
+        particles.push_back(s1, property<dim>().deactivate());
+        particles.push_back(w, property<dim>());
+        particles.push_back(s2, property<dim>());
+
+        const std::vector<std::size_t> objects{0, 1, 1, 1, 2};
+        REQUIRE(particles.nb_particles() == objects.size());
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            CHECK(particles.object_index(i) == objects[i]);
+        }
+
+        SUBCASE("periodic images")
+        {
+            particles.add_periodic_image(2, {{10., 0.}});
+            particles.add_periodic_image(4, {{10., 0.}});
+            CHECK(particles.object_index(5) == 1);
+            CHECK(particles.object_index(6) == 2);
+            particles.reset_periodic();
+            particles.add_periodic_image(1, {{10., 0.}});
+            CHECK(particles.object_index(5) == 1);
+            CHECK(particles.nb_particles() == 6);
+        }
+
+        SUBCASE("reorder")
+        {
+            // the sphere is before the worm along the curve
+            particles.reorder(space_filling_curve::hilbert);
+            const std::vector<std::size_t> reordered{0, 1, 2, 2, 2};
+            for (std::size_t i = 0; i < reordered.size(); ++i)
+            {
+                CHECK(particles.object_index(i) == reordered[i]);
+                CHECK(particles.offset(particles.object_index(i)) <= i);
+                CHECK(i < particles.offset(particles.object_index(i) + 1));
+            }
+        }
+    }
+
+    TEST_CASE("Container erase")
+    {
+        static constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        sphere<dim> obstacle(
+            {
+                {0., -1.}
+        },
+            0.1);
+        particles.push_back(obstacle, property<dim>().deactivate());
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            double x = static_cast<double>(i);
+            sphere<dim> s(
+                {
+                    {x, 0.}
+            },
+                0.1);
+            particles.push_back(s,
+                                property<dim>()
+                                    .velocity({
+                                        {x, -x}
+            })
+                                    .mass(x + 1.));
+        }
+        worm<dim> w(
+            {
+                {0., 2.},
+                {1., 2.},
+                {2., 2.}
+        },
+            {{quaternion(0.)}, {quaternion(0.)}, {quaternion(0.)}},
+            0.5,
+            3);
+        particles.push_back(w, property<dim>());
+        sphere<dim> s(
+            {
+                {5., 0.}
+        },
+            0.2);
+        particles.push_back(s, property<dim>().mass(6.));
+
+        SUBCASE("swap")
+        {
+            // the last sphere takes the place of the sphere 2
+            particles.erase(2);
+            REQUIRE(particles.size() == 6);
+            REQUIRE(particles.nb_particles() == 8);
+            CHECK(particles.pos()(2)(0) == doctest::Approx(5.));
+            CHECK(particles.m()(2) == doctest::Approx(6.));
+            CHECK(particles.bounding_radius(2) == doctest::Approx(0.2));
+            CHECK(particles.particle_id(2) == 8);
+            CHECK(particles.particle_index(8) == 2);
+            CHECK(particles.particle_index(2) == std::size_t(-1));
+            CHECK(particles.object_index(2) == 2);
+            CHECK(particles.object_index(7) == 5);
+            CHECK(particles.offset(6) == 8);
+
+            // new particles get new identifiers
+            particles.push_back(s, property<dim>());
+            CHECK(particles.particle_id(8) == 9);
+            CHECK(particles.particle_index(9) == 8);
+        }
+
+        SUBCASE("shift")
+        {
+            // the worm and the last sphere do not have the same size
+            particles.erase(5);
+            REQUIRE(particles.size() == 6);
+            REQUIRE(particles.nb_particles() == 6);
+            // the worm was the largest object
+            CHECK(particles.max_bounding_radius() == doctest::Approx(0.2));
+            CHECK(particles.particle_id(5) == 8);
+            CHECK(particles.object_index(5) == 5);
+            CHECK(particles.offset(6) == 6);
+
+            particles.push_back(w, property<dim>());
+            particles.erase(1);
+            REQUIRE(particles.nb_particles() == 8);
+            const std::vector<std::size_t> ids{0, 2, 3, 4, 8, 9, 10, 11};
+            const std::vector<std::size_t> objects{0, 1, 2, 3, 4, 5, 5, 5};
+            for (std::size_t k = 0; k < ids.size(); ++k)
+            {
+                CHECK(particles.particle_id(k) == ids[k]);
+                CHECK(particles.particle_index(ids[k]) == k);
+                CHECK(particles.object_index(k) == objects[k]);
+            }
+            CHECK(particles.particle_index(1) == std::size_t(-1));
+            CHECK(particles.v()(1)(0) == doctest::Approx(1.));
+            CHECK(particles.pos()(4)(0) == doctest::Approx(5.));
+            CHECK(particles.offset(5) == 5);
+            CHECK(particles.offset(6) == 8);
+        }
+
+        SUBCASE("obstacle")
+        {
+            CHECK_THROWS_AS(particles.erase(0), std::runtime_error);
+        }
+    }
 }
@@ -10,6 +10,7 @@
 #include <scopi/contact/contact_brute_force.hpp>
 #include <scopi/solvers/OptimGradient.hpp>
 #include <scopi/solvers/apgd.hpp>
+#include <scopi/solvers/pgs.hpp>
 
 #include "analytical_solution.hpp"
 #include "utils.hpp"
@@ -641,4 +642,204 @@ namespace scopi
 
         CHECK(check_reference_file(path, filename, total_it, tol));
     }
+
+    void fill_sphere_stack(scopi_container<2>& particles)
+    {
+        constexpr std::size_t dim = 2;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        particles.push_back(p, property<dim>().deactivate());
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            sphere<dim> s(
+                {
+                    {0., 0.5 + static_cast<double>(i)}
+            },
+                0.5);
+            particles.push_back(s,
+                                property<dim>().mass(1.).moment_inertia(0.125).force({
+                                    {0., -1.}
+            }));
+        }
+    }
+
+    TEST_CASE("Warm start")
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.01;
+        std::size_t total_it      = 50;
+
+        scopi_container<dim> particles;
+        scopi_container<dim> reference;
+        fill_sphere_stack(particles);
+        fill_sphere_stack(reference);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_brute_force, vap_fpd> solver_reference(reference);
+        auto params_reference                           = solver_reference.get_params();
+        params_reference.solver_params.output_frequency = std::size_t(-1);
+        params_reference.contact_method_params.dmax     = 0.1;
+        params_reference.optim_params.tolerance         = 1e-10;
+        params_reference.optim_params.warm_start        = false;
+        solver_reference.run(dt, total_it);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_brute_force, vap_fpd> solver(particles);
+        auto params                           = solver.get_params();
+        params.solver_params.output_frequency = std::size_t(-1);
+        params.contact_method_params.dmax     = 0.1;
+        params.optim_params.tolerance         = 1e-10;
+        solver.run(dt, total_it);
+
+        for (std::size_t i = 0; i < particles.nb_particles(); ++i)
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(particles.pos()(i)(d) == doctest::Approx(reference.pos()(i)(d)));
+                CHECK(particles.v()(i)(d) == doctest::Approx(reference.v()(i)(d)));
+            }
+        }
+
+        // the multipliers of the previous time step are close to the solution of the next one
+        auto contacts = solver.current_contacts();
+        REQUIRE(contacts.size() == 3);
+        vap_fpd().set_a_priori_velocity(dt, particles, contacts);
+        auto min_p = make_minimization_problem<NoFriction>(dt, contacts, particles);
+
+        apgd method;
+        method.get_params().tolerance = 1e-10;
+        auto lambda_cold              = method(min_p);
+        std::size_t nb_iterations     = method.nb_iterations();
+        auto lambda_warm              = method(min_p, min_p.initial_lambda(contacts));
+
+        CHECK(method.nb_iterations() < nb_iterations);
+        for (std::size_t i = 0; i < contacts.size(); ++i)
+        {
+            CHECK(lambda_warm(i) == doctest::Approx(lambda_cold(i)));
+            CHECK(contacts[i].lambda[1] != 0.);
+        }
+    }
+
+    template <class problem_t>
+    void check_minimization_problem()
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.01;
+
+        scopi_container<dim> particles;
+        fill_sphere_stack(particles);
+        ScopiSolver<dim, problem_t, OptimGradient<apgd>, contact_brute_force, vap_fpd> solver(particles);
+        auto params                           = solver.get_params();
+        params.solver_params.output_frequency = std::size_t(-1);
+        params.contact_method_params.dmax     = 0.1;
+        solver.run(dt, 5);
+
+        auto contacts = solver.current_contacts();
+        REQUIRE(contacts.size() == 3);
+        auto min_p = make_minimization_problem<problem_t>(dt, contacts, particles);
+
+        xt::xtensor<double, 1> lambda = xt::zeros<double>({min_p.size()});
+        for (std::size_t k = 0; k < lambda.size(); ++k)
+        {
+            lambda[k] = 0.1 * static_cast<double>(k + 1);
+        }
+        auto work                 = min_p.make_workspace();
+        xt::xtensor<double, 1> dG = xt::zeros<double>({min_p.size()});
+        min_p.gradient_into(lambda, dG, work);
+        CHECK(min_p.cached_objective(lambda, work) == doctest::Approx(min_p(lambda)));
+
+        // the objective is quadratic, so the centered differences are exact
+        auto gradient = min_p.gradient(lambda);
+        double h      = 1e-3;
+        for (std::size_t k = 0; k < lambda.size(); ++k)
+        {
+            xt::xtensor<double, 1> lambda_p = lambda;
+            xt::xtensor<double, 1> lambda_m = lambda;
+            lambda_p[k] += h;
+            lambda_m[k] -= h;
+            CHECK(dG[k] == doctest::Approx((min_p.objective(lambda_p, work) - min_p.objective(lambda_m, work)) / (2. * h)));
+            CHECK(gradient[k] == doctest::Approx(dG[k]));
+        }
+    }
+
+    TEST_CASE("Minimization problem")
+    {
+        SUBCASE("NoFriction")
+        {
+            check_minimization_problem<NoFriction>();
+        }
+
+        SUBCASE("Friction")
+        {
+            check_minimization_problem<Friction>();
+        }
+    }
+
+    template <class problem_t>
+    void check_pgs()
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.01;
+
+        scopi_container<dim> particles;
+        fill_sphere_stack(particles);
+        ScopiSolver<dim, problem_t, OptimGradient<pgs>, contact_brute_force, vap_fpd> solver(particles);
+        auto params                           = solver.get_params();
+        params.solver_params.output_frequency = std::size_t(-1);
+        params.contact_method_params.dmax     = 0.1;
+        params.optim_params.tolerance         = 1e-10;
+        solver.run(dt, 20);
+
+        auto contacts = solver.current_contacts();
+        REQUIRE(contacts.size() == 3);
+        vap_fpd().set_a_priori_velocity(dt, particles, contacts);
+        auto min_p = make_minimization_problem<problem_t>(dt, contacts, particles);
+
+        apgd apgd_method;
+        apgd_method.get_params().tolerance = 1e-12;
+        auto lambda_apgd                   = apgd_method(min_p);
+
+        pgs pgs_method;
+        pgs_method.get_params().tolerance = 1e-12;
+        auto lambda_pgs                   = pgs_method(min_p);
+        pgs_method.get_params().colored   = true;
+        auto lambda_colored               = pgs_method(min_p);
+
+        // the multipliers are not unique with viscosity, the velocities are
+        CHECK(min_p(lambda_pgs) == doctest::Approx(min_p(lambda_apgd)));
+        CHECK(min_p(lambda_colored) == doctest::Approx(min_p(lambda_apgd)));
+        auto u_apgd    = min_p.velocities(lambda_apgd);
+        auto u_pgs     = min_p.velocities(lambda_pgs);
+        auto u_colored = min_p.velocities(lambda_colored);
+        for (std::size_t k = 0; k < u_apgd.size(); ++k)
+        {
+            CHECK(u_pgs(k) == doctest::Approx(u_apgd(k)).epsilon(1e-6));
+            CHECK(u_colored(k) == doctest::Approx(u_apgd(k)).epsilon(1e-6));
+        }
+    }
+
+    TEST_CASE("Projected Gauss-Seidel")
+    {
+        SUBCASE("NoFriction")
+        {
+            check_pgs<NoFriction>();
+        }
+
+        SUBCASE("Viscous")
+        {
+            check_pgs<Viscous>();
+        }
+
+        SUBCASE("Friction")
+        {
+            check_pgs<Friction>();
+        }
+
+        SUBCASE("ViscousFriction")
+        {
+            check_pgs<ViscousFriction>();
+        }
+    }
 }
@@ -0,0 +1,151 @@
+#include "test_common.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <vector>
+#include <doctest/doctest.h>
+
+#include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_bvh.hpp>
+#include <scopi/contact/contact_kdtree.hpp>
+#include <scopi/contact/contact_sweep_and_prune.hpp>
+#include <scopi/contact/property.hpp>
+#include <scopi/container.hpp>
+#include <scopi/objects/types/plane.hpp>
+#include <scopi/objects/types/sphere.hpp>
+#include <scopi/solver.hpp>
+
+namespace scopi
+{
+    void fill_hopper(scopi_container<2>& particles)
+    {
+        constexpr std::size_t dim = 2;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        particles.push_back(p, property<dim>().deactivate());
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            for (std::size_t j = 0; j < 5; ++j)
+            {
+                double r = (i + j) % 2 == 0 ? 0.3 : 0.45;
+                sphere<dim> s(
+                    {
+                        {0.5 + 1.02 * static_cast<double>(i), 0.5 + 1.1 * static_cast<double>(j)}
+                },
+                    r);
+                particles.push_back(s, property<dim>().desired_velocity({{0., -1.}}).mass(1.).moment_inertia(0.1));
+            }
+        }
+    }
+
+    // the lowest spheres leave the domain and new spheres enter at the top
+    template <class solver_t>
+    void inflow_outflow(solver_t& solver, scopi_container<2>& particles, std::size_t nite)
+    {
+        constexpr std::size_t dim = 2;
+        if (nite % 5 != 4)
+        {
+            return;
+        }
+
+        std::vector<std::size_t> outlet;
+        for (std::size_t io = 1; io < particles.size(); ++io)
+        {
+            if (particles.pos()(particles.offset(io))(1) < 0.55)
+            {
+                outlet.push_back(io);
+            }
+        }
+        solver.erase(outlet);
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            sphere<dim> s(
+                {
+                    {1. + 2.5 * static_cast<double>(i), 7. + 0.1 * static_cast<double>(nite)}
+            },
+                0.35);
+            particles.push_back(s, property<dim>().desired_velocity({{0., -1.}}).mass(1.).moment_inertia(0.1));
+        }
+    }
+
+    template <template <class> class contact_t>
+    void check_inflow_outflow()
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.01;
+        std::size_t total_it      = 30;
+
+        scopi_container<dim> particles;
+        scopi_container<dim> reference;
+        fill_hopper(particles);
+        fill_hopper(reference);
+
+        BoxDomain<dim> box({0., 0.}, {8.16, 10.});
+        box.with_periodicity(0);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_brute_force, vap_fixed> solver_reference(box, reference);
+        auto params_reference                           = solver_reference.get_params();
+        params_reference.solver_params.output_frequency = std::size_t(-1);
+        params_reference.contact_method_params.dmax     = 0.3;
+        params_reference.optim_params.tolerance         = 1e-10;
+        solver_reference.run(dt,
+                             total_it,
+                             0,
+                             [&](std::size_t nite)
+                             {
+                                 inflow_outflow(solver_reference, reference, nite);
+                             });
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_t, vap_fixed> solver(box, particles);
+        auto params                           = solver.get_params();
+        params.solver_params.output_frequency = std::size_t(-1);
+        params.contact_method_params.dmax     = 0.3;
+        params.optim_params.tolerance         = 1e-10;
+        solver.run(dt,
+                   total_it,
+                   0,
+                   [&](std::size_t nite)
+                   {
+                       inflow_outflow(solver, particles, nite);
+                   });
+
+        // the new spheres are at the end of the container
+        REQUIRE(particles.nb_particles() == reference.nb_particles());
+        CHECK(particles.particle_id(particles.nb_particles() - 1) == 41 + 3 * (total_it / 5) - 1);
+        REQUIRE(solver.current_contacts().size() == solver_reference.current_contacts().size());
+        for (std::size_t k = 0; k < particles.nb_particles(); ++k)
+        {
+            const std::size_t id = particles.particle_id(k);
+            CHECK(particles.particle_index(id) == k);
+            const std::size_t i = reference.particle_index(id);
+            REQUIRE(i != std::size_t(-1));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(particles.pos()(k)(d) == doctest::Approx(reference.pos()(i)(d)));
+                CHECK(particles.v()(k)(d) == doctest::Approx(reference.v()(i)(d)));
+            }
+        }
+    }
+
+    TEST_CASE("Inflow and outflow")
+    {
+        SUBCASE("kdtree")
+        {
+            check_inflow_outflow<contact_kdtree>();
+        }
+
+        SUBCASE("bvh")
+        {
+            check_inflow_outflow<contact_bvh>();
+        }
+
+        SUBCASE("sweep and prune")
+        {
+            check_inflow_outflow<contact_sweep_and_prune>();
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include <xtensor/xtensor.hpp>
 
 #include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/property.hpp>
 #include <scopi/container.hpp>
 #include <scopi/matrix/velocities.hpp>
 #include <scopi/objects/types/sphere.hpp>
@@ -76,4 +77,138 @@ namespace scopi
         REQUIRE(sol[1] == doctest::Approx(1.18278683));
     }
 
+    TEST_CASE("Matrix A blocks")
+    {
+        static constexpr std::size_t dim = 3;
+        scopi_container<dim> particles;
+
+        sphere<dim> obstacle(
+            {
+                {0., 0., -1.}
+        },
+            0.5);
+        particles.push_back(obstacle, property<dim>().deactivate());
+        const xt::xtensor_fixed<double, xt::xshape<3>> axis{0., 0.6, 0.8};
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            double x = 0.3 * static_cast<double>(i);
+            sphere<dim> s(
+                {
+                    {x, 0.1 * x, 0.}
+            },
+                {quaternion(0.4 * x, axis)},
+                0.2);
+            particles.push_back(s, property<dim>().mass(1.).moment_inertia({{0.1, 0.1, 0.1}}));
+        }
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force<NoFriction> cont(params);
+        auto contacts = cont.run(particles, particles.nb_inactive());
+        REQUIRE(contacts.size() > 4);
+
+        AMatrix a(contacts, particles);
+        ATMatrix at(a);
+        xt::xtensor<double, 1> u = xt::random::rand<double>({6 * particles.nb_active()});
+        xt::xtensor<double, 1> f = xt::random::rand<double>({3 * contacts.size()});
+        auto au                  = a.mat_mult(u);
+
+        // relative velocities computed from the rotation matrices
+        const std::size_t active_offset = particles.nb_inactive();
+        const std::size_t rot_offset    = 3 * particles.nb_active();
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
+        {
+            const auto& c = contacts[ic];
+            xt::xtensor_fixed<double, xt::xshape<3>> expected = xt::zeros<double>({3});
+            if (c.i >= active_offset)
+            {
+                const std::size_t k                              = c.i - active_offset;
+                xt::xtensor_fixed<double, xt::xshape<3>> v_i     = xt::view(u, xt::range(3 * k, 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> omega_i = xt::view(u, xt::range(rot_offset + 3 * k, rot_offset + 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> rij_i   = c.pi - particles.pos()(c.i);
+                expected += v_i - xt::linalg::cross(rij_i, xt::linalg::dot(rotation_matrix<3>(particles.q()(c.i)), omega_i));
+            }
+            if (c.j >= active_offset)
+            {
+                const std::size_t k                              = c.j - active_offset;
+                xt::xtensor_fixed<double, xt::xshape<3>> v_j     = xt::view(u, xt::range(3 * k, 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> omega_j = xt::view(u, xt::range(rot_offset + 3 * k, rot_offset + 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> rij_j   = c.pj - particles.pos()(c.j);
+                expected -= v_j - xt::linalg::cross(rij_j, xt::linalg::dot(rotation_matrix<3>(particles.q()(c.j)), omega_j));
+            }
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                CHECK(au(3 * ic + d) == doctest::Approx(expected(d)));
+            }
+        }
+
+        REQUIRE(xt::linalg::dot(au, f)[0] == doctest::Approx(xt::linalg::dot(u, at.mat_mult(f))[0]));
+    }
+
+    TEST_CASE("Matrix A blocks 2d")
+    {
+        static constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+
+        sphere<dim> obstacle(
+            {
+                {0., -1.}
+        },
+            0.5);
+        particles.push_back(obstacle, property<dim>().deactivate());
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            double x = 0.3 * static_cast<double>(i);
+            sphere<dim> s(
+                {
+                    {x, 0.1 * x}
+            },
+                {quaternion(0.4 * x)},
+                0.2);
+            particles.push_back(s, property<dim>().mass(1.).moment_inertia(0.1));
+        }
+
+        ContactsParams<contact_brute_force<NoFriction>> params;
+        params.dmax = 1.;
+        contact_brute_force<NoFriction> cont(params);
+        auto contacts = cont.run(particles, particles.nb_inactive());
+        REQUIRE(contacts.size() > 4);
+
+        AMatrix a(contacts, particles);
+        ATMatrix at(a);
+        xt::xtensor<double, 1> u = xt::random::rand<double>({6 * particles.nb_active()});
+        xt::xtensor<double, 1> f = xt::random::rand<double>({3 * contacts.size()});
+        auto au                  = a.mat_mult(u);
+
+        // relative velocities computed as before the assembly of the Jacobian
+        const std::size_t active_offset = particles.nb_inactive();
+        const std::size_t rot_offset    = 3 * particles.nb_active();
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
+        {
+            const auto& c = contacts[ic];
+            xt::xtensor_fixed<double, xt::xshape<3>> expected = xt::zeros<double>({3});
+            if (c.i >= active_offset)
+            {
+                const std::size_t k                              = c.i - active_offset;
+                xt::xtensor_fixed<double, xt::xshape<3>> v_i     = xt::view(u, xt::range(3 * k, 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> omega_i = xt::view(u, xt::range(rot_offset + 3 * k, rot_offset + 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<dim>> rij_i = c.pi - particles.pos()(c.i);
+                expected += v_i - detail::cross<dim>(rij_i, detail::mat_mult(rotation_matrix<3>(particles.q()(c.i)), omega_i));
+            }
+            if (c.j >= active_offset)
+            {
+                const std::size_t k                              = c.j - active_offset;
+                xt::xtensor_fixed<double, xt::xshape<3>> v_j     = xt::view(u, xt::range(3 * k, 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<3>> omega_j = xt::view(u, xt::range(rot_offset + 3 * k, rot_offset + 3 * k + 3));
+                xt::xtensor_fixed<double, xt::xshape<dim>> rij_j = c.pj - particles.pos()(c.j);
+                expected -= v_j - detail::cross<dim>(rij_j, detail::mat_mult(rotation_matrix<3>(particles.q()(c.j)), omega_j));
+            }
+            for (std::size_t d = 0; d < 3; ++d)
+            {
+                CHECK(au(3 * ic + d) == doctest::Approx(expected(d)));
+            }
+        }
+
+        REQUIRE(xt::linalg::dot(au, f)[0] == doctest::Approx(xt::linalg::dot(u, at.mat_mult(f))[0]));
+    }
 } // namespace scopi
@@ -0,0 +1,62 @@
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cmath>
+
+#include <xtensor/xfixed.hpp>
+
+#include <scopi/newton.hpp>
+
+namespace scopi
+{
+    TEST_CASE("linear solver 2x2")
+    {
+        std::array<double, 4> a = {2., 1., 1., 3.};
+        std::array<double, 2> b = {3., 5.};
+        REQUIRE(detail::linear_solver<2>::solve(a, b));
+        REQUIRE(b[0] == doctest::Approx(0.8));
+        REQUIRE(b[1] == doctest::Approx(1.4));
+    }
+
+    TEST_CASE("linear solver 4x4 with pivoting")
+    {
+        // the first pivot is zero
+        std::array<double, 16> a = {0., 1., 0., 0., 1., 0., 0., 0., 0., 0., 2., 1., 0., 0., 1., 2.};
+        std::array<double, 4> b  = {2., 1., 4., 5.};
+        REQUIRE(detail::linear_solver<4>::solve(a, b));
+        REQUIRE(b[0] == doctest::Approx(1.));
+        REQUIRE(b[1] == doctest::Approx(2.));
+        REQUIRE(b[2] == doctest::Approx(1.));
+        REQUIRE(b[3] == doctest::Approx(2.));
+    }
+
+    TEST_CASE("linear solver singular")
+    {
+        std::array<double, 4> a = {1., 2., 2., 4.};
+        std::array<double, 2> b = {1., 1.};
+        REQUIRE_FALSE(detail::linear_solver<2>::solve(a, b));
+    }
+
+    TEST_CASE("newton method 2d")
+    {
+        // intersection of the unit circle and the line x = y
+        auto f = [](const auto& u, const auto&)
+        {
+            xt::xtensor_fixed<double, xt::xshape<2>> res = {u[0] * u[0] + u[1] * u[1] - 1., u[0] - u[1]};
+            return res;
+        };
+        auto grad_f = [](const auto& u, const auto&)
+        {
+            xt::xtensor_fixed<double, xt::xshape<2, 2>> res = {
+                {2. * u[0], 2. * u[1]},
+                {1.,        -1.      }
+            };
+            return res;
+        };
+        std::array<double, 2> u0 = {1., 0.5};
+        auto [u, iter]           = newton_method(u0, f, grad_f, 0., 100, 1e-14, 1e-14);
+        REQUIRE(iter >= 0);
+        REQUIRE(u[0] == doctest::Approx(std::sqrt(2.) / 2.));
+        REQUIRE(u[1] == doctest::Approx(std::sqrt(2.) / 2.));
+    }
+}
@@ -0,0 +1,286 @@
+#include "test_common.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <doctest/doctest.h>
+
+#include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_bvh.hpp>
+#include <scopi/contact/contact_sweep_and_prune.hpp>
+#include <scopi/contact/property.hpp>
+#include <scopi/container.hpp>
+#include <scopi/objects/types/plane.hpp>
+#include <scopi/objects/types/sphere.hpp>
+#include <scopi/solver.hpp>
+#include <scopi/space_filling_curve.hpp>
+
+namespace scopi
+{
+    template <std::size_t dim>
+    void check_hilbert_curve(std::uint32_t n)
+    {
+        std::size_t ncells = 1;
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            ncells *= n;
+        }
+
+        // the cells of [0, n)^dim are the first ones along the curve and two consecutive cells are neighbors
+        std::vector<std::array<std::uint32_t, dim>> cells(ncells);
+        std::vector<bool> found(ncells, false);
+        for (std::size_t c = 0; c < ncells; ++c)
+        {
+            std::array<std::uint32_t, dim> x;
+            std::size_t r = c;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                x[d] = static_cast<std::uint32_t>(r % n);
+                r /= n;
+            }
+            const std::uint64_t key = hilbert_key<dim>(x);
+            REQUIRE(key < ncells);
+            CHECK(!found[key]);
+            found[key] = true;
+            cells[key] = x;
+        }
+        for (std::size_t c = 1; c < ncells; ++c)
+        {
+            int distance = 0;
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                distance += std::abs(static_cast<int>(cells[c][d]) - static_cast<int>(cells[c - 1][d]));
+            }
+            CHECK(distance == 1);
+        }
+    }
+
+    TEST_CASE("space filling curves")
+    {
+        SUBCASE("hilbert 2d")
+        {
+            check_hilbert_curve<2>(16);
+        }
+
+        SUBCASE("hilbert 3d")
+        {
+            check_hilbert_curve<3>(8);
+        }
+
+        SUBCASE("morton")
+        {
+            CHECK(morton_key<2>({1, 0}) == 2);
+            CHECK(morton_key<2>({0, 1}) == 1);
+            CHECK(morton_key<2>({3, 1}) == 11);
+            CHECK(morton_key<3>({1, 1, 0}) == 6);
+        }
+    }
+
+    template <class container_t>
+    void fill_scrambled_pile(container_t& particles)
+    {
+        constexpr std::size_t dim = 2;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        particles.push_back(p, property<dim>().deactivate());
+
+        // the spheres are not added in the order of their positions
+        for (std::size_t k = 0; k < 60; ++k)
+        {
+            const std::size_t n = (37 * k) % 60;
+            const double i      = static_cast<double>(n / 6);
+            const double j      = static_cast<double>(n % 6);
+            const double r      = n % 2 == 0 ? 0.3 : 0.45;
+            sphere<dim> s(
+                {
+                    {0.35 + 1.02 * i - 0.03 * static_cast<double>(n % 2), 0.5 + 1.1 * j}
+            },
+                r);
+            particles.push_back(s,
+                                property<dim>()
+                                    .velocity({
+                                        {i, j}
+            })
+                                    .desired_velocity({{0., -1.}})
+                                    .mass(1. + i)
+                                    .moment_inertia(0.1));
+        }
+    }
+
+    double path_length(scopi_container<2>& particles)
+    {
+        double length = 0.;
+        for (std::size_t i = particles.nb_inactive() + 1; i < particles.nb_particles(); ++i)
+        {
+            length += std::hypot(particles.pos()(i)(0) - particles.pos()(i - 1)(0), particles.pos()(i)(1) - particles.pos()(i - 1)(1));
+        }
+        return length;
+    }
+
+    void check_reorder(space_filling_curve curve)
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        fill_scrambled_pile(particles);
+        scopi_container<dim> reference;
+        fill_scrambled_pile(reference);
+
+        const auto perm = particles.reorder(curve);
+        REQUIRE(perm.size() == reference.nb_particles());
+
+        // the obstacle stays at the front
+        CHECK(perm[0] == 0);
+        CHECK(particles.nb_inactive() == 1);
+        CHECK(particles.particle_id(0) == 0);
+
+        std::vector<bool> found(perm.size(), false);
+        for (std::size_t i = 0; i < perm.size(); ++i)
+        {
+            const std::size_t k = perm[i];
+            REQUIRE(k < perm.size());
+            CHECK(!found[k]);
+            found[k] = true;
+
+            CHECK(particles.particle_id(k) == i);
+            CHECK(particles.offset(k) == k);
+            CHECK(particles.bounding_radius(k) == doctest::Approx(reference.bounding_radius(i)));
+            CHECK(particles.m()(k) == doctest::Approx(reference.m()(i)));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(particles.pos()(k)(d) == doctest::Approx(reference.pos()(i)(d)));
+                CHECK(particles.v()(k)(d) == doctest::Approx(reference.v()(i)(d)));
+                CHECK(particles.vd()(k)(d) == doctest::Approx(reference.vd()(i)(d)));
+            }
+        }
+
+        // the neighbors in space are close in memory
+        CHECK(path_length(particles) < 0.5 * path_length(reference));
+    }
+
+    TEST_CASE("Container reorder")
+    {
+        SUBCASE("morton")
+        {
+            check_reorder(space_filling_curve::morton);
+        }
+
+        SUBCASE("hilbert")
+        {
+            check_reorder(space_filling_curve::hilbert);
+        }
+    }
+
+    TEST_CASE("Contacts renumber")
+    {
+        constexpr std::size_t dim = 2;
+
+        // contact with a periodic image, stored with i > j
+        neighbor<dim, NoFriction> c;
+        c.i       = 2;
+        c.j       = 1;
+        c.nij     = {1., 0.};
+        c.pi      = {0., 0.};
+        c.pj      = {1., 0.};
+        c.lambda  = {1., 0.5};
+        c.u.valid = true;
+        std::vector<neighbor<dim, NoFriction>> contacts{c};
+
+        SUBCASE("order kept")
+        {
+            renumber({0, 1, 3, 2}, contacts);
+            REQUIRE(contacts.size() == 1);
+            CHECK(contacts[0].i == 3);
+            CHECK(contacts[0].j == 1);
+            CHECK(contacts[0].nij(0) == doctest::Approx(1.));
+            CHECK(contacts[0].lambda[0] == doctest::Approx(1.));
+            CHECK(contacts[0].u.valid);
+        }
+
+        SUBCASE("order inverted")
+        {
+            renumber({0, 3, 1, 2}, contacts);
+            REQUIRE(contacts.size() == 1);
+            CHECK(contacts[0].i == 3);
+            CHECK(contacts[0].j == 1);
+            CHECK(contacts[0].nij(0) == doctest::Approx(-1.));
+            CHECK(contacts[0].pi(0) == doctest::Approx(1.));
+            CHECK(contacts[0].lambda[0] == doctest::Approx(-1.));
+            CHECK(!contacts[0].u.valid);
+        }
+
+        SUBCASE("removed particle")
+        {
+            renumber({0, std::size_t(-1), 1, 2}, contacts);
+            CHECK(contacts.empty());
+        }
+    }
+
+    template <template <class> class contact_t>
+    void check_solver_reorder(space_filling_curve curve)
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.005;
+        std::size_t total_it      = 20;
+
+        scopi_container<dim> particles;
+        scopi_container<dim> reference;
+        fill_scrambled_pile(particles);
+        fill_scrambled_pile(reference);
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity(0);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_t, vap_fixed> solver_reference(box, reference);
+        auto params_reference                           = solver_reference.get_params();
+        params_reference.solver_params.output_frequency = std::size_t(-1);
+        params_reference.contact_method_params.dmax     = 0.3;
+        params_reference.optim_params.tolerance         = 1e-10;
+        solver_reference.run(dt, total_it);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_t, vap_fixed> solver(box, particles);
+        auto params                            = solver.get_params();
+        params.solver_params.output_frequency  = std::size_t(-1);
+        params.solver_params.reorder_frequency = 5;
+        params.solver_params.reorder_curve     = curve;
+        params.contact_method_params.dmax      = 0.3;
+        params.optim_params.tolerance          = 1e-10;
+        solver.run(dt, total_it);
+
+        REQUIRE(solver.current_contacts().size() == solver_reference.current_contacts().size());
+        for (std::size_t k = 0; k < particles.nb_particles(); ++k)
+        {
+            const std::size_t i = particles.particle_id(k);
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(particles.pos()(k)(d) == doctest::Approx(reference.pos()(i)(d)));
+                CHECK(particles.v()(k)(d) == doctest::Approx(reference.v()(i)(d)));
+            }
+        }
+    }
+
+    TEST_CASE("Solver reorder")
+    {
+        SUBCASE("brute force")
+        {
+            check_solver_reorder<contact_brute_force>(space_filling_curve::hilbert);
+        }
+
+        SUBCASE("bvh")
+        {
+            check_solver_reorder<contact_bvh>(space_filling_curve::morton);
+        }
+
+        SUBCASE("sweep and prune")
+        {
+            check_solver_reorder<contact_sweep_and_prune>(space_filling_curve::hilbert);
+        }
+    }
+}
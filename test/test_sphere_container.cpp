@@ -0,0 +1,163 @@
+#include "test_common.hpp"
+#include "utils.hpp"
+#include <cstddef>
+#include <doctest/doctest.h>
+
+#include <scopi/contact/contact_brute_force.hpp>
+#include <scopi/contact/contact_cell_list.hpp>
+#include <scopi/contact/property.hpp>
+#include <scopi/container.hpp>
+#include <scopi/objects/types/plane.hpp>
+#include <scopi/objects/types/sphere.hpp>
+#include <scopi/solver.hpp>
+#include <scopi/sphere_container.hpp>
+
+namespace scopi
+{
+    template <class container_t>
+    void fill_sphere_pile(container_t& particles)
+    {
+        constexpr std::size_t dim = 2;
+
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        sphere<dim> obstacle(
+            {
+                {5., 7.}
+        },
+            0.5);
+        particles.push_back(p, property<dim>().deactivate());
+        particles.push_back(obstacle, property<dim>().deactivate());
+
+        // the spheres close to x = 0 and x = 10 are in contact through the periodic boundary
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            for (std::size_t j = 0; j < 6; ++j)
+            {
+                double r = (i + j) % 2 == 0 ? 0.3 : 0.45;
+                sphere<dim> s(
+                    {
+                        {0.35 + 1.02 * static_cast<double>(i) - 0.03 * static_cast<double>(j % 2), 0.5 + 1.1 * static_cast<double>(j)}
+                },
+                    r);
+                particles.push_back(s, property<dim>().mass(1.).moment_inertia(0.1));
+            }
+        }
+    }
+
+    template <class contact_t>
+    void check_sphere_container_contacts()
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        sphere_container<dim> spheres;
+        fill_sphere_pile(particles);
+        fill_sphere_pile(spheres);
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity(0);
+
+        ContactsParams<contact_t> params;
+        params.dmax = 0.3;
+        contact_t cont(params);
+        auto contacts = cont.run(box, particles, particles.nb_inactive());
+        contact_t cont_spheres(params);
+        auto contacts_spheres = cont_spheres.run(box, spheres, spheres.nb_inactive());
+
+        REQUIRE(contacts_spheres.size() == contacts.size());
+        for (std::size_t ic = 0; ic < contacts.size(); ++ic)
+        {
+            CHECK(contacts_spheres[ic].i == contacts[ic].i);
+            CHECK(contacts_spheres[ic].j == contacts[ic].j);
+            CHECK(contacts_spheres[ic].dij == doctest::Approx(contacts[ic].dij));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(contacts_spheres[ic].nij(d) == doctest::Approx(contacts[ic].nij(d)));
+                CHECK(contacts_spheres[ic].pi(d) == doctest::Approx(contacts[ic].pi(d)));
+                CHECK(contacts_spheres[ic].pj(d) == doctest::Approx(contacts[ic].pj(d)));
+            }
+        }
+    }
+
+    TEST_CASE("sphere_container contacts")
+    {
+        SUBCASE("brute force")
+        {
+            check_sphere_container_contacts<contact_brute_force<NoFriction>>();
+        }
+
+        SUBCASE("cell list")
+        {
+            check_sphere_container_contacts<contact_cell_list<NoFriction>>();
+        }
+    }
+
+    TEST_CASE("sphere_container active plane")
+    {
+        constexpr std::size_t dim = 2;
+        sphere_container<dim> spheres;
+        plane<dim> p(
+            {
+                {0., 0.}
+        },
+            PI / 2.);
+        CHECK_THROWS_AS(spheres.push_back(p, property<dim>()), std::runtime_error);
+    }
+
+    TEST_CASE("sphere_container output")
+    {
+        constexpr std::size_t dim = 2;
+        scopi_container<dim> particles;
+        sphere_container<dim> spheres;
+        fill_sphere_pile(particles);
+        fill_sphere_pile(spheres);
+
+        for (std::size_t i = 0; i < particles.size(); ++i)
+        {
+            nl::json reference = particles.visit_object(i,
+                                                        [&](const object<dim, false>& obj, shape_tag_t tag)
+                                                        {
+                                                            using dispatcher_t = write_objects_dispatcher<dim>;
+                                                            return dispatcher_t::template dispatch_tag<shape_types<dim>>(tag, obj, i);
+                                                        });
+            CHECK(write_objects(spheres, i) == reference);
+        }
+    }
+
+    TEST_CASE("sphere_container solver")
+    {
+        constexpr std::size_t dim = 2;
+        double dt                 = 0.005;
+        std::size_t total_it      = 20;
+
+        scopi_container<dim> particles;
+        sphere_container<dim> spheres;
+        fill_sphere_pile(particles);
+        fill_sphere_pile(spheres);
+        for (std::size_t i = particles.nb_inactive(); i < particles.nb_particles(); ++i)
+        {
+            particles.vd()(i)(1) = -1.;
+            spheres.vd()(i)(1)   = -1.;
+        }
+
+        BoxDomain<dim> box({0., 0.}, {10., 10.});
+        box.with_periodicity(0);
+
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_cell_list, vap_fixed> solver(box, particles);
+        solver.run(dt, total_it);
+        ScopiSolver<dim, NoFriction, OptimGradient<apgd>, contact_cell_list, vap_fixed, sphere_container<dim>> solver_spheres(box, spheres);
+        solver_spheres.run(dt, total_it);
+
+        for (std::size_t i = 0; i < particles.nb_particles(); ++i)
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                CHECK(spheres.pos()(i)(d) == doctest::Approx(particles.pos()(i)(d)));
+                CHECK(spheres.v()(i)(d) == doctest::Approx(particles.v()(i)(d)));
+            }
+        }
+    }
+}